@@ -16,7 +16,10 @@
         "./src/goo/drbg.c",
         "./src/goo/goo.c",
         "./src/goo/hmac.c",
-        "./src/goo/sha256.c"
+        "./src/goo/pool.c",
+        "./src/goo/scan.c",
+        "./src/goo/sha256.c",
+        "./src/goo/util.c"
       ],
       "conditions": [
         ["OS != 'mac' and OS != 'win'", {
@@ -47,6 +50,16 @@
             4334  # implicit 32->64 bit shift
           ]
         }],
+        ["OS != 'win'", {
+          "defines": [
+            "GOO_HAS_PTHREAD"
+          ],
+          "direct_dependent_settings": {
+            "libraries": [
+              "-lpthread"
+            ]
+          }
+        }],
         ["node_byteorder == 'big'", {
           "defines": [
             "WORDS_BIGENDIAN"
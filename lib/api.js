@@ -68,6 +68,10 @@ class API {
     return this._prover().challenge(s_prime, key);
   }
 
+  challengeAsync(s_prime, key) {
+    return this._prover().challengeAsync(s_prime, key);
+  }
+
   encrypt(msg, key, size) {
     return this.constructor.encrypt(msg, key, size);
   }
@@ -80,14 +84,26 @@ class API {
     return this._prover().validate(s_prime, C1, key);
   }
 
+  validateAsync(s_prime, C1, key) {
+    return this._prover().validateAsync(s_prime, C1, key);
+  }
+
   sign(msg, s_prime, key) {
     return this._prover().sign(msg, s_prime, key);
   }
 
+  signAsync(msg, s_prime, key) {
+    return this._prover().signAsync(msg, s_prime, key);
+  }
+
   verify(msg, sig, C1) {
     return this._verifier().verify(msg, sig, C1);
   }
 
+  verifyAsync(msg, sig, C1) {
+    return this._verifier().verifyAsync(msg, sig, C1);
+  }
+
   static generate() {
     return Goo.generate();
   }
@@ -456,6 +456,10 @@ class Goo {
     return C1.encode('be', this.size);
   }
 
+  async challengeAsync(s_prime, key) {
+    return this.challenge(s_prime, key);
+  }
+
   _challenge(s_prime, n) {
     const bits = n.bitLength();
 
@@ -509,6 +513,10 @@ class Goo {
     }
   }
 
+  async validateAsync(s_prime, C1, key) {
+    return this.validate(s_prime, C1, key);
+  }
+
   _validate(s_prime, C1, p, q) {
     const n = p.mul(q);
     const bits = n.bitLength();
@@ -547,6 +555,10 @@ class Goo {
     return S.encode(this.bits);
   }
 
+  async signAsync(msg, s_prime, key) {
+    return this.sign(msg, s_prime, key);
+  }
+
   _sign(msg, s_prime, p, q) {
     const n = p.mul(q);
     const bits = n.bitLength();
@@ -742,6 +754,10 @@ class Goo {
     }
   }
 
+  async verifyAsync(msg, sig, C1) {
+    return this.verify(msg, sig, C1);
+  }
+
   _verify(msg, S, C1) {
     assert(Buffer.isBuffer(msg));
     assert(S instanceof Signature);
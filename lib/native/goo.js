@@ -51,6 +51,15 @@ class Goo {
     return binding.goosig_challenge(this._handle, s_prime, n);
   }
 
+  async challengeAsync(s_prime, key) {
+    assert(this instanceof Goo);
+    assert(Buffer.isBuffer(s_prime));
+
+    const {n} = rsa.publicKeyExport(key);
+
+    return binding.goosig_challenge_async(this._handle, s_prime, n);
+  }
+
   encrypt(msg, key, size) {
     return internal.encrypt(msg, key, size);
   }
@@ -75,6 +84,22 @@ class Goo {
     return binding.goosig_validate(this._handle, s_prime, C1, k.p, k.q);
   }
 
+  async validateAsync(s_prime, C1, key) {
+    assert(this instanceof Goo);
+    assert(Buffer.isBuffer(s_prime));
+    assert(Buffer.isBuffer(C1));
+    assert(Buffer.isBuffer(key));
+
+    let k;
+    try {
+      k = rsa.privateKeyExport(key);
+    } catch (e) {
+      return false;
+    }
+
+    return binding.goosig_validate_async(this._handle, s_prime, C1, k.p, k.q);
+  }
+
   sign(msg, s_prime, key) {
     assert(this instanceof Goo);
     assert(Buffer.isBuffer(msg));
@@ -86,6 +111,17 @@ class Goo {
     return binding.goosig_sign(this._handle, msg, s_prime, p, q);
   }
 
+  async signAsync(msg, s_prime, key) {
+    assert(this instanceof Goo);
+    assert(Buffer.isBuffer(msg));
+    assert(Buffer.isBuffer(s_prime));
+    assert(Buffer.isBuffer(key));
+
+    const {p, q} = rsa.privateKeyExport(key);
+
+    return binding.goosig_sign_async(this._handle, msg, s_prime, p, q);
+  }
+
   verify(msg, sig, C1) {
     assert(this instanceof Goo);
     assert(Buffer.isBuffer(msg));
@@ -95,6 +131,15 @@ class Goo {
     return binding.goosig_verify(this._handle, msg, sig, C1);
   }
 
+  async verifyAsync(msg, sig, C1) {
+    assert(this instanceof Goo);
+    assert(Buffer.isBuffer(msg));
+    assert(Buffer.isBuffer(sig));
+    assert(Buffer.isBuffer(C1));
+
+    return binding.goosig_verify_async(this._handle, msg, sig, C1);
+  }
+
   static generate() {
     return binding.goosig_generate(binding.entropy());
   }
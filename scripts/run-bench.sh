@@ -0,0 +1,52 @@
+#!/bin/bash
+
+set -ex
+
+if test x"$1" = x'--mini'; then
+  gcc -o ./goo-bench         \
+    -std=c89                 \
+    -pedantic                \
+    -Wall                    \
+    -Wextra                  \
+    -Wcast-align             \
+    -Wshadow                 \
+    -Wno-unused-parameter    \
+    -Wno-sign-compare        \
+    -O3                      \
+    -pthread                 \
+    -DGOO_HAS_PTHREAD        \
+    -DGOO_SHA256_TESTING     \
+    -DGOO_SHA256_COUNT       \
+    ./src/goo/bench.c        \
+    ./src/goo/drbg.c         \
+    ./src/goo/hmac.c         \
+    ./src/goo/mini-gmp.c     \
+    ./src/goo/pool.c         \
+    ./src/goo/sha256.c       \
+    ./src/goo/util.c
+else
+  gcc -o ./goo-bench         \
+    -std=c89                 \
+    -pedantic                \
+    -Wall                    \
+    -Wextra                  \
+    -Wcast-align             \
+    -Wshadow                 \
+    -O3                      \
+    -pthread                 \
+    -DGOO_HAS_GMP            \
+    -DGOO_HAS_PTHREAD        \
+    -DGOO_SHA256_TESTING     \
+    -DGOO_SHA256_COUNT       \
+    ./src/goo/bench.c        \
+    ./src/goo/drbg.c         \
+    ./src/goo/hmac.c         \
+    ./src/goo/pool.c         \
+    ./src/goo/sha256.c       \
+    ./src/goo/util.c         \
+    -lgmp
+fi
+
+./goo-bench
+
+rm ./goo-bench
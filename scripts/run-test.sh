@@ -14,10 +14,16 @@ for cc in gcc clang; do
       -Wno-unused-parameter    \
       -Wno-sign-compare        \
       -O3                      \
+      -pthread                 \
+      -DGOO_HAS_PTHREAD        \
+      -DGOO_SHA256_TESTING     \
       ./src/goo/drbg.c         \
       ./src/goo/hmac.c         \
       ./src/goo/mini-gmp.c     \
+      ./src/goo/pool.c         \
+      ./src/goo/scan.c         \
       ./src/goo/sha256.c       \
+      ./src/goo/util.c         \
       ./src/goo/test.c
 
     ./goo-test
@@ -45,11 +51,17 @@ for cc in gcc clang; do
     -Wcast-align             \
     -Wshadow                 \
     -O3                      \
+    -pthread                 \
     -DGOO_HAS_GMP            \
     -DGOO_HAS_CRYPTO         \
+    -DGOO_HAS_PTHREAD        \
+    -DGOO_SHA256_TESTING     \
     ./src/goo/drbg.c         \
     ./src/goo/hmac.c         \
+    ./src/goo/pool.c         \
+    ./src/goo/scan.c         \
     ./src/goo/sha256.c       \
+    ./src/goo/util.c         \
     ./src/goo/test.c
 
   ./goo-test
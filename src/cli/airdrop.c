@@ -0,0 +1,407 @@
+/*!
+ * airdrop.c - bulk airdrop command for goosig
+ * Copyright (c) 2018-2019, Christopher Jeffrey (MIT License).
+ * https://github.com/handshake-org/goosig
+ *
+ * Usage:
+ *   goo-airdrop [-t threads] [-m modulus] [keys [records]]
+ *
+ * `keys` (default stdin) holds one RSA public key per line:
+ * the modulus in hex, optionally followed by the exponent in
+ * hex (default 010001). For each key, a fixed-size record of
+ * s_prime || C1 || ct is written to `records` (default stdout),
+ * exactly as goo_generate(), goo_challenge() and goo_encrypt()
+ * would produce it. Invalid keys (including overlong lines)
+ * get a zeroed record.
+ * `modulus` is one of rsa2048 (default), rsa617, aol1 or aol2.
+ */
+
+#if defined(__unix__) && !defined(_POSIX_C_SOURCE)
+/* For clock_gettime(2). */
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+/* RtlGenRandom() has no import library of its own. */
+#define RtlGenRandom SystemFunction036
+BOOLEAN NTAPI RtlGenRandom(PVOID buffer, ULONG length);
+#if defined(_MSC_VER)
+#pragma comment(lib, "advapi32.lib")
+#endif
+#endif
+
+#include "../goo/goo.h"
+#include "../goo/pool.h"
+#include "../goo/util.h"
+
+#define AIRDROP_MAX_N ((GOO_MAX_RSA_BITS + 7) / 8)
+#define AIRDROP_MAX_E 8
+#define AIRDROP_LINE (2 * (AIRDROP_MAX_N + AIRDROP_MAX_E) + 64)
+#define AIRDROP_CHUNK 256 /* records per thread per write */
+
+static double
+airdrop_wall(void) {
+#if defined(CLOCK_MONOTONIC)
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#else
+  return (double)time(NULL);
+#endif
+}
+
+static int
+airdrop_nibble(int ch) {
+  if (ch >= '0' && ch <= '9')
+    return ch - '0';
+
+  if (ch >= 'a' && ch <= 'f')
+    return ch - 'a' + 10;
+
+  if (ch >= 'A' && ch <= 'F')
+    return ch - 'A' + 10;
+
+  return -1;
+}
+
+static int
+airdrop_unhex(unsigned char *out,
+              size_t *out_len,
+              size_t max,
+              const char *str,
+              size_t len) {
+  /* Odd lengths are left-padded with a zero. */
+  size_t size = (len + 1) / 2;
+  size_t i, j;
+  int hi, lo;
+
+  if (len == 0 || size > max)
+    return 0;
+
+  for (i = 0, j = 0; i < size; i++) {
+    hi = 0;
+
+    if (i > 0 || (len & 1) == 0)
+      hi = airdrop_nibble(str[j++]);
+
+    lo = airdrop_nibble(str[j++]);
+
+    if (hi < 0 || lo < 0)
+      return 0;
+
+    out[i] = (hi << 4) | lo;
+  }
+
+  *out_len = size;
+
+  return 1;
+}
+
+static size_t
+airdrop_word(const char **str, size_t *len) {
+  /* Find the next whitespace-delimited word. */
+  const char *p = *str;
+  size_t n = 0;
+
+  while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+    p++;
+
+  while (p[n] != '\0' && p[n] != ' ' && p[n] != '\t'
+         && p[n] != '\r' && p[n] != '\n') {
+    n++;
+  }
+
+  *str = p;
+  *len = n;
+
+  return n;
+}
+
+static void
+airdrop_parse(goo_airdrop_job_t *job,
+              unsigned char *n,
+              unsigned char *e,
+              const char *line) {
+  /* Blank keys are kept (and fail) so records */
+  /* stay aligned with the input. */
+  static const unsigned char exp[3] = {0x01, 0x00, 0x01};
+  const char *p = line;
+  size_t len;
+
+  job->n = NULL;
+  job->n_len = 0;
+  job->e = exp;
+  job->e_len = sizeof(exp);
+
+  if (airdrop_word(&p, &len) == 0)
+    return;
+
+  if (!airdrop_unhex(n, &job->n_len, AIRDROP_MAX_N, p, len))
+    return;
+
+  job->n = n;
+
+  p += len;
+
+  if (airdrop_word(&p, &len) == 0)
+    return;
+
+  job->e = e;
+
+  if (!airdrop_unhex(e, &job->e_len, AIRDROP_MAX_E, p, len))
+    job->e = NULL;
+
+  p += len;
+
+  if (airdrop_word(&p, &len) != 0)
+    job->e = NULL;
+}
+
+static int
+airdrop_entropy(unsigned char *out, size_t len) {
+#if defined(_WIN32)
+  return RtlGenRandom(out, (ULONG)len) != 0;
+#else
+  FILE *stream = fopen("/dev/urandom", "rb");
+  size_t nread;
+
+  if (stream == NULL)
+    return 0;
+
+  nread = fread(out, 1, len, stream);
+
+  fclose(stream);
+
+  return nread == len;
+#endif
+}
+
+static int
+airdrop_skip(FILE *stream) {
+  /* Discard the rest of an overlong line. */
+  int ch;
+
+  do {
+    ch = getc(stream);
+  } while (ch != '\n' && ch != EOF);
+
+  return !ferror(stream);
+}
+
+static const unsigned char *
+airdrop_modulus(const char *name, size_t *len) {
+  if (strcmp(name, "rsa2048") == 0) {
+    *len = sizeof(GOO_RSA2048);
+    return GOO_RSA2048;
+  }
+
+  if (strcmp(name, "rsa617") == 0) {
+    *len = sizeof(GOO_RSA617);
+    return GOO_RSA617;
+  }
+
+  if (strcmp(name, "aol1") == 0) {
+    *len = sizeof(GOO_AOL1);
+    return GOO_AOL1;
+  }
+
+  if (strcmp(name, "aol2") == 0) {
+    *len = sizeof(GOO_AOL2);
+    return GOO_AOL2;
+  }
+
+  return NULL;
+}
+
+static void
+airdrop_usage(void) {
+  fprintf(stderr, "Usage: goo-airdrop [-t threads] [-m modulus]"
+                  " [keys [records]]\n");
+}
+
+int
+main(int argc, char **argv) {
+  const char *modname = "rsa2048";
+  const char *args[2] = { NULL, NULL };
+  const unsigned char *mod;
+  size_t mod_len;
+  goo_ctx_t *goo = NULL;
+  FILE *in = stdin;
+  FILE *out = stdout;
+  goo_airdrop_job_t *jobs = NULL;
+  unsigned char *keys = NULL;
+  unsigned char *exps = NULL;
+  unsigned char *entropy = NULL;
+  unsigned char *records = NULL;
+  char line[AIRDROP_LINE];
+  size_t threads = 0;
+  size_t nargs = 0;
+  size_t chunk = 0;
+  size_t size = 0;
+  size_t count, i;
+  size_t total = 0;
+  size_t failed = 0;
+  double start, elapsed;
+  int done = 0;
+  int ret = 1;
+  int j;
+
+  for (j = 1; j < argc; j++) {
+    if (strcmp(argv[j], "-t") == 0 && j + 1 < argc) {
+      threads = (size_t)strtoul(argv[++j], NULL, 10);
+    } else if (strcmp(argv[j], "-m") == 0 && j + 1 < argc) {
+      modname = argv[++j];
+    } else if (argv[j][0] == '-' || nargs == 2) {
+      airdrop_usage();
+      return 1;
+    } else {
+      args[nargs++] = argv[j];
+    }
+  }
+
+  mod = airdrop_modulus(modname, &mod_len);
+
+  if (mod == NULL) {
+    airdrop_usage();
+    return 1;
+  }
+
+  /* Combs large enough for any accepted modulus. */
+  goo = goo_create(mod, mod_len, 2, 3, 4096);
+
+  if (goo == NULL) {
+    fprintf(stderr, "goo-airdrop: could not create context.\n");
+    goto fail;
+  }
+
+  if (args[0] != NULL && (in = fopen(args[0], "r")) == NULL) {
+    fprintf(stderr, "goo-airdrop: could not open %s.\n", args[0]);
+    goto fail;
+  }
+
+  if (args[1] != NULL && (out = fopen(args[1], "wb")) == NULL) {
+    fprintf(stderr, "goo-airdrop: could not open %s.\n", args[1]);
+    goto fail;
+  }
+
+  /* Every buffer is sized once for a whole chunk. */
+  threads = goo_pool_threads(threads, (size_t)-1);
+  chunk = AIRDROP_CHUNK * threads;
+  size = goo_airdrop_size(goo);
+
+  jobs = (goo_airdrop_job_t *)malloc(chunk * sizeof(goo_airdrop_job_t));
+  keys = (unsigned char *)malloc(chunk * AIRDROP_MAX_N);
+  exps = (unsigned char *)malloc(chunk * AIRDROP_MAX_E);
+  entropy = (unsigned char *)malloc(chunk * 64);
+  records = (unsigned char *)malloc(chunk * size);
+
+  if (jobs == NULL || keys == NULL || exps == NULL
+      || entropy == NULL || records == NULL) {
+    fprintf(stderr, "goo-airdrop: out of memory.\n");
+    goto fail;
+  }
+
+  start = airdrop_wall();
+
+  while (!done) {
+    for (count = 0; count < chunk; count++) {
+      goo_airdrop_job_t *job = &jobs[count];
+      size_t len;
+
+      if (fgets(line, sizeof(line), in) == NULL) {
+        done = 1;
+        break;
+      }
+
+      len = strlen(line);
+
+      if (len == sizeof(line) - 1 && line[len - 1] != '\n') {
+        /* Too long to be a key: fails like any other. */
+        if (!airdrop_skip(in))
+          break;
+
+        line[0] = '\0';
+      }
+
+      airdrop_parse(job, &keys[count * AIRDROP_MAX_N],
+                    &exps[count * AIRDROP_MAX_E], line);
+
+      job->entropy = &entropy[count * 64];
+      job->out = &records[count * size];
+    }
+
+    if (ferror(in)) {
+      fprintf(stderr, "goo-airdrop: read error.\n");
+      goto fail;
+    }
+
+    if (count == 0)
+      break;
+
+    if (!airdrop_entropy(entropy, count * 64)) {
+      fprintf(stderr, "goo-airdrop: could not read entropy.\n");
+      goto fail;
+    }
+
+    goo_airdrop_many(goo, jobs, count, NULL, 0, threads);
+
+    for (i = 0; i < count; i++) {
+      if (!jobs[i].result) {
+        fprintf(stderr, "goo-airdrop: key %lu is invalid.\n",
+                (unsigned long)(total + i));
+        failed += 1;
+      }
+    }
+
+    if (fwrite(records, size, count, out) != count) {
+      fprintf(stderr, "goo-airdrop: write error.\n");
+      goto fail;
+    }
+
+    total += count;
+  }
+
+  if (fflush(out) != 0) {
+    fprintf(stderr, "goo-airdrop: write error.\n");
+    goto fail;
+  }
+
+  elapsed = airdrop_wall() - start;
+
+  fprintf(stderr, "wrote %lu records in %.3f s (%.1f keys/s), %lu invalid\n",
+          (unsigned long)total, elapsed,
+          elapsed > 0 ? (double)total / elapsed : 0.0,
+          (unsigned long)failed);
+
+  ret = 0;
+fail:
+  if (entropy != NULL)
+    goo_cleanse(entropy, chunk * 64);
+
+  if (records != NULL)
+    goo_cleanse(records, chunk * size);
+
+  free(jobs);
+  free(keys);
+  free(exps);
+  free(entropy);
+  free(records);
+
+  if (in != stdin && in != NULL)
+    fclose(in);
+
+  if (out != stdout && out != NULL)
+    fclose(out);
+
+  goo_destroy(goo);
+
+  return ret;
+}
@@ -0,0 +1,288 @@
+/*!
+ * scan.c - trial decryption command for goosig
+ * Copyright (c) 2018-2019, Christopher Jeffrey (MIT License).
+ * https://github.com/handshake-org/goosig
+ *
+ * Usage:
+ *   goo-scan [-t threads] [-e exponent] file [key]
+ *
+ * `file` holds fixed-size ciphertexts (GOO_SCAN_SIZE bytes
+ * each). `key` (default stdin) holds the primes `p` and `q`
+ * in hex, separated by whitespace; they are kept off the
+ * command line so they do not show up in the process list.
+ * `exponent` is hex (default 010001). The indices of the
+ * ciphertexts which decrypt under the key are written to
+ * stdout, one per line; throughput is written to stderr.
+ */
+
+#if defined(__unix__) && !defined(_POSIX_C_SOURCE)
+/* For clock_gettime(2). */
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+/* RtlGenRandom() has no import library of its own. */
+#define RtlGenRandom SystemFunction036
+BOOLEAN NTAPI RtlGenRandom(PVOID buffer, ULONG length);
+#if defined(_MSC_VER)
+#pragma comment(lib, "advapi32.lib")
+#endif
+#endif
+
+#include "../goo/scan.h"
+#include "../goo/util.h"
+
+/* Hex primes of up to 4096 bits combined, plus whitespace. */
+#define SCAN_MAX_KEY 2176
+
+static double
+scan_wall(void) {
+#if defined(CLOCK_MONOTONIC)
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#else
+  return (double)time(NULL);
+#endif
+}
+
+static int
+scan_nibble(int ch) {
+  if (ch >= '0' && ch <= '9')
+    return ch - '0';
+
+  if (ch >= 'a' && ch <= 'f')
+    return ch - 'a' + 10;
+
+  if (ch >= 'A' && ch <= 'F')
+    return ch - 'A' + 10;
+
+  return -1;
+}
+
+static unsigned char *
+scan_unhex(const char *str, size_t slen, size_t *len) {
+  /* Odd lengths are left-padded with a zero. */
+  size_t size = (slen + 1) / 2;
+  unsigned char *out;
+  size_t i, j;
+  int hi, lo;
+
+  if (slen == 0)
+    return NULL;
+
+  out = (unsigned char *)malloc(size);
+
+  if (out == NULL)
+    return NULL;
+
+  for (i = 0, j = 0; i < size; i++) {
+    hi = 0;
+
+    if (i > 0 || (slen & 1) == 0)
+      hi = scan_nibble(str[j++]);
+
+    lo = scan_nibble(str[j++]);
+
+    if (hi < 0 || lo < 0) {
+      goo_cleanse(out, size);
+      free(out);
+      return NULL;
+    }
+
+    out[i] = (hi << 4) | lo;
+  }
+
+  *len = size;
+
+  return out;
+}
+
+static size_t
+scan_word(const char **str, const char *end) {
+  /* Find the next whitespace-delimited word. */
+  const char *p = *str;
+  size_t n = 0;
+
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+    p++;
+
+  while (p + n < end && p[n] != ' ' && p[n] != '\t'
+         && p[n] != '\r' && p[n] != '\n') {
+    n++;
+  }
+
+  *str = p;
+
+  return n;
+}
+
+static int
+scan_key(unsigned char **p,
+         size_t *p_len,
+         unsigned char **q,
+         size_t *q_len,
+         const char *file) {
+  /* Read `p q` in hex from `file` (or stdin). */
+  char buf[SCAN_MAX_KEY + 1];
+  FILE *stream = stdin;
+  const char *str = buf;
+  const char *end;
+  size_t len, n;
+  int r = 0;
+
+  if (file != NULL && (stream = fopen(file, "r")) == NULL)
+    return 0;
+
+  len = fread(buf, 1, sizeof(buf), stream);
+
+  if (ferror(stream) || len == sizeof(buf))
+    goto fail;
+
+  end = buf + len;
+
+  n = scan_word(&str, end);
+  *p = scan_unhex(str, n, p_len);
+  str += n;
+
+  n = scan_word(&str, end);
+  *q = scan_unhex(str, n, q_len);
+  str += n;
+
+  if (*p == NULL || *q == NULL || scan_word(&str, end) != 0)
+    goto fail;
+
+  r = 1;
+fail:
+  goo_cleanse(buf, sizeof(buf));
+
+  if (stream != stdin)
+    fclose(stream);
+
+  return r;
+}
+
+static int
+scan_entropy(unsigned char *out, size_t len) {
+#if defined(_WIN32)
+  return RtlGenRandom(out, (ULONG)len) != 0;
+#else
+  FILE *stream = fopen("/dev/urandom", "rb");
+  size_t nread;
+
+  if (stream == NULL)
+    return 0;
+
+  nread = fread(out, 1, len, stream);
+
+  fclose(stream);
+
+  return nread == len;
+#endif
+}
+
+static void
+scan_usage(void) {
+  fprintf(stderr, "Usage: goo-scan [-t threads] [-e exponent] file [key]\n");
+}
+
+int
+main(int argc, char **argv) {
+  unsigned char *p = NULL;
+  unsigned char *q = NULL;
+  unsigned char *e = NULL;
+  const char *exp = "010001";
+  const char *args[2] = { NULL, NULL };
+  unsigned char entropy[32];
+  size_t p_len = 0;
+  size_t q_len = 0;
+  size_t e_len = 0;
+  size_t *indices = NULL;
+  size_t count = 0;
+  size_t total = 0;
+  size_t threads = 0;
+  size_t nargs = 0;
+  size_t j;
+  double start, elapsed;
+  int ret = 1;
+  int i;
+
+  for (i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      threads = (size_t)strtoul(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+      exp = argv[++i];
+    } else if (argv[i][0] == '-' || nargs == 2) {
+      scan_usage();
+      return 1;
+    } else {
+      args[nargs++] = argv[i];
+    }
+  }
+
+  if (nargs == 0) {
+    scan_usage();
+    return 1;
+  }
+
+  e = scan_unhex(exp, strlen(exp), &e_len);
+
+  if (e == NULL) {
+    fprintf(stderr, "goo-scan: invalid exponent.\n");
+    goto fail;
+  }
+
+  if (!scan_key(&p, &p_len, &q, &q_len, args[1])) {
+    fprintf(stderr, "goo-scan: could not read key.\n");
+    goto fail;
+  }
+
+  if (!scan_entropy(entropy, sizeof(entropy))) {
+    fprintf(stderr, "goo-scan: could not read entropy.\n");
+    goto fail;
+  }
+
+  start = scan_wall();
+
+  if (!goo_scan_file(&indices, &count, &total, args[0],
+                     p, p_len, q, q_len, e, e_len,
+                     NULL, 0, entropy, threads)) {
+    fprintf(stderr, "goo-scan: could not scan %s.\n", args[0]);
+    goto fail;
+  }
+
+  elapsed = scan_wall() - start;
+
+  for (j = 0; j < count; j++)
+    printf("%lu\n", (unsigned long)indices[j]);
+
+  fprintf(stderr, "scanned %lu in %.3f s (%.1f ct/s), %lu matched\n",
+          (unsigned long)total, elapsed,
+          elapsed > 0 ? (double)total / elapsed : 0.0,
+          (unsigned long)count);
+
+  ret = 0;
+fail:
+  goo_cleanse(entropy, sizeof(entropy));
+
+  if (p != NULL)
+    goo_cleanse(p, p_len);
+
+  if (q != NULL)
+    goo_cleanse(q, q_len);
+
+  free(p);
+  free(q);
+  free(e);
+  free(indices);
+
+  return ret;
+}
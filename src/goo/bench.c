@@ -0,0 +1,1060 @@
+/*!
+ * bench.c - benchmarks for libgoo
+ * Copyright (c) 2018-2019, Christopher Jeffrey (MIT License).
+ * https://github.com/handshake-org/goosig
+ */
+
+#if defined(__unix__) && !defined(_POSIX_C_SOURCE)
+/* For clock_gettime(2). */
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdio.h>
+#include <time.h>
+
+#include "goo.c"
+
+#define GOO_ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
+
+static double
+bench_time(void) {
+  return (double)clock() / (double)CLOCKS_PER_SEC;
+}
+
+static double
+bench_wall(void) {
+  /* clock(3) counts every thread; this does not. */
+#if defined(CLOCK_MONOTONIC)
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#else
+  return (double)time(NULL);
+#endif
+}
+
+static void
+bench_report(const char *name, const char *unit, size_t ops, double elapsed) {
+  printf("  %-28s %10.3f us/%s (%lu %ss)\n",
+         name, elapsed * 1e6 / (double)ops, unit,
+         (unsigned long)ops, unit);
+}
+
+static void
+bench_seed(goo_prng_t *rng) {
+  /* Fixed entropy so runs are comparable. */
+  unsigned char seed[32];
+
+  memset(seed, 0xaa, sizeof(seed));
+
+  goo_prng_init(rng);
+  goo_prng_seed(rng, seed, &GOO_PRNG_LOCAL);
+}
+
+/*
+ * SHA256
+ */
+
+static const char *bench_sha256_names[] = {
+  "auto",
+  "generic",
+  "avx2",
+  "sha-ni"
+};
+
+static const int bench_sha256_backends[] = {
+  GOO_SHA256_GENERIC,
+  GOO_SHA256_AVX2,
+  GOO_SHA256_SHANI
+};
+
+static void
+bench_sha256_group(goo_prng_t *rng,
+                   const unsigned char *mod,
+                   size_t mod_len,
+                   const char *name) {
+  /* Times goo_group_derive(), which is the hashing */
+  /* (and DRBG) work done once per verification. */
+  goo_group_t *group = goo_malloc(sizeof(goo_group_t));
+  goo_scratch_t *scratch;
+  unsigned char msg[32];
+  unsigned char key[32];
+  char label[64];
+  mpz_t n, C1, C2, C3, t, A, B, C, D, E, chal, ell;
+  size_t i, j, ops = 2000;
+  double start;
+
+  mpz_init(n);
+  mpz_init(C1);
+  mpz_init(C2);
+  mpz_init(C3);
+  mpz_init(t);
+  mpz_init(A);
+  mpz_init(B);
+  mpz_init(C);
+  mpz_init(D);
+  mpz_init(E);
+  mpz_init(chal);
+  mpz_init(ell);
+
+  goo_mpz_import(n, mod, mod_len);
+
+  ASSERT(goo_group_init(group, n, 2, 3, 0));
+
+  scratch = goo_malloc(sizeof(goo_scratch_t));
+
+  goo_scratch_init(scratch, group);
+
+  goo_prng_random_int(rng, C1, group->nh);
+  goo_prng_random_int(rng, C2, group->nh);
+  goo_prng_random_int(rng, C3, group->nh);
+  goo_prng_random_int(rng, A, group->nh);
+  goo_prng_random_int(rng, B, group->nh);
+  goo_prng_random_int(rng, C, group->nh);
+  goo_prng_random_int(rng, D, group->nh);
+  goo_prng_random_bits(rng, E, GOO_EXP_BYTES * 8 - 1);
+  mpz_set_ui(t, 0x10001);
+
+  goo_prng_generate(rng, msg, sizeof(msg));
+
+  for (j = 0; j < GOO_ARRAY_SIZE(bench_sha256_backends); j++) {
+    int backend = bench_sha256_backends[j];
+
+    if (goo_sha256_force(backend) != backend)
+      continue;
+
+    start = bench_time();
+
+    for (i = 0; i < ops; i++) {
+      ASSERT(goo_group_derive(group, scratch, chal, ell, key,
+                              C1, C2, C3, t, A, B, C, D, E,
+                              msg, sizeof(msg)));
+    }
+
+    sprintf(label, "derive %s (%s)", name, bench_sha256_names[backend]);
+
+    bench_report(label, "op", ops, bench_time() - start);
+  }
+
+  goo_sha256_force(GOO_SHA256_AUTO);
+
+  /* Batched derivation (multi-buffer SHA256) for 64 entries. */
+  {
+    mpz_srcptr items[64 * 9];
+    const unsigned char *msgs[64];
+    size_t msg_lens[64];
+    unsigned char keys[64 * 32];
+    mpz_t chals[64], ells[64];
+    int ok[64];
+    size_t k, rounds = ops / 64;
+
+    for (k = 0; k < 64; k++) {
+      items[k * 9 + 0] = C1;
+      items[k * 9 + 1] = C2;
+      items[k * 9 + 2] = C3;
+      items[k * 9 + 3] = t;
+      items[k * 9 + 4] = A;
+      items[k * 9 + 5] = B;
+      items[k * 9 + 6] = C;
+      items[k * 9 + 7] = D;
+      items[k * 9 + 8] = E;
+      msgs[k] = msg;
+      msg_lens[k] = sizeof(msg);
+      mpz_init(chals[k]);
+      mpz_init(ells[k]);
+    }
+
+    start = bench_time();
+
+    for (i = 0; i < rounds; i++) {
+      for (k = 0; k < 64; k++)
+        ok[k] = 1;
+
+      goo_group_derive_batch(group, scratch, ok, chals, ells, keys,
+                             items, msgs, msg_lens, 64);
+    }
+
+    sprintf(label, "derive %s (batch x64)", name);
+
+    bench_report(label, "op", rounds * 64, bench_time() - start);
+
+    for (k = 0; k < 64; k++) {
+      mpz_clear(chals[k]);
+      mpz_clear(ells[k]);
+    }
+  }
+
+  goo_scratch_uninit(scratch);
+  goo_free(scratch);
+  goo_group_uninit(group);
+  goo_free(group);
+
+  mpz_clear(n);
+  mpz_clear(C1);
+  mpz_clear(C2);
+  mpz_clear(C3);
+  mpz_clear(t);
+  mpz_clear(A);
+  mpz_clear(B);
+  mpz_clear(C);
+  mpz_clear(D);
+  mpz_clear(E);
+  mpz_clear(chal);
+  mpz_clear(ell);
+}
+
+static void
+bench_sha256(goo_prng_t *rng) {
+  static unsigned char data[65536];
+  unsigned char out[32];
+  char label[64];
+  size_t i, j;
+  double start;
+
+  printf("SHA256:\n");
+
+  goo_prng_generate(rng, data, sizeof(data));
+
+  for (j = 0; j < GOO_ARRAY_SIZE(bench_sha256_backends); j++) {
+    int backend = bench_sha256_backends[j];
+    size_t ops = 200;
+
+    if (goo_sha256_force(backend) != backend)
+      continue;
+
+    start = bench_time();
+
+    for (i = 0; i < ops; i++)
+      goo_sha256(out, data, sizeof(data));
+
+    sprintf(label, "sha256 64k (%s)", bench_sha256_names[backend]);
+
+    bench_report(label, "block", ops * (sizeof(data) / 64),
+                 bench_time() - start);
+  }
+
+  goo_sha256_force(GOO_SHA256_AUTO);
+
+  bench_sha256_group(rng, GOO_RSA2048, sizeof(GOO_RSA2048), "rsa2048");
+  bench_sha256_group(rng, GOO_AOL2, sizeof(GOO_AOL2), "aol2");
+}
+
+/*
+ * DRBG
+ */
+
+typedef struct bench_drbg_s {
+  unsigned char K[32];
+  unsigned char V[32];
+} bench_drbg_t;
+
+static void
+bench_drbg_mac(bench_drbg_t *drbg,
+               unsigned char *out,
+               const unsigned char *sep,
+               const unsigned char *seed,
+               size_t seed_len) {
+  /* HMAC keyed from scratch every time. */
+  goo_hmac_t hmac;
+
+  goo_hmac_init(&hmac, drbg->K, 32);
+  goo_hmac_update(&hmac, drbg->V, 32);
+
+  if (sep != NULL)
+    goo_hmac_update(&hmac, sep, 1);
+
+  if (seed_len != 0)
+    goo_hmac_update(&hmac, seed, seed_len);
+
+  goo_hmac_final(&hmac, out);
+}
+
+static void
+bench_drbg_update(bench_drbg_t *drbg,
+                  const unsigned char *seed,
+                  size_t seed_len) {
+  static const unsigned char zero[1] = {0x00};
+  static const unsigned char one[1] = {0x01};
+
+  bench_drbg_mac(drbg, drbg->K, zero, seed, seed_len);
+  bench_drbg_mac(drbg, drbg->V, NULL, NULL, 0);
+
+  if (seed_len != 0) {
+    bench_drbg_mac(drbg, drbg->K, one, seed, seed_len);
+    bench_drbg_mac(drbg, drbg->V, NULL, NULL, 0);
+  }
+}
+
+static void
+bench_drbg_init(bench_drbg_t *drbg,
+                const unsigned char *seed,
+                size_t seed_len) {
+  /* Reference HMAC-DRBG, as goo_drbg_init() used to be. */
+  memset(drbg->K, 0x00, 32);
+  memset(drbg->V, 0x01, 32);
+
+  bench_drbg_update(drbg, seed, seed_len);
+}
+
+static void
+bench_drbg_generate(bench_drbg_t *drbg, unsigned char *out, size_t len) {
+  size_t pos;
+
+  for (pos = 0; pos < len; pos += 32) {
+    bench_drbg_mac(drbg, drbg->V, NULL, NULL, 0);
+    memcpy(out + pos, drbg->V, len - pos < 32 ? len - pos : 32);
+  }
+
+  bench_drbg_update(drbg, NULL, 0);
+}
+
+static void
+bench_report_sha(const char *name,
+                 size_t ops,
+                 double elapsed,
+                 unsigned long blocks) {
+  printf("  %-28s %10.3f us/op %8.1f sha/op\n",
+         name, elapsed * 1e6 / (double)ops,
+         (double)blocks / (double)ops);
+}
+
+#define BENCH_START() \
+  (start = bench_time(), blocks = goo_sha256_blocks)
+
+#define BENCH_STOP(name, ops) \
+  bench_report_sha((name), (ops), bench_time() - start, \
+                   goo_sha256_blocks - blocks)
+
+static void
+bench_drbg(goo_prng_t *rng) {
+  /* Compressions per DRBG operation, for the */
+  /* reference DRBG (rekeyed on every HMAC) and */
+  /* for ours, along with the callers that use */
+  /* the DRBG the most. */
+  goo_group_t *group = goo_malloc(sizeof(goo_group_t));
+  goo_scratch_t *scratch = goo_malloc(sizeof(goo_scratch_t));
+  unsigned char entropy[64];
+  unsigned char out1[32];
+  unsigned char out2[32];
+  unsigned long blocks;
+  bench_drbg_t ref;
+  goo_drbg_t drbg;
+  goo_prng_t prng;
+  mpz_t n, C1, C2, C3, t, A, B, C, D, E, chal, ell;
+  size_t i, j, ops = 10000;
+  double start;
+
+  printf("DRBG:\n");
+
+  mpz_init(n);
+  mpz_init(C1);
+  mpz_init(C2);
+  mpz_init(C3);
+  mpz_init(t);
+  mpz_init(A);
+  mpz_init(B);
+  mpz_init(C);
+  mpz_init(D);
+  mpz_init(E);
+  mpz_init(chal);
+  mpz_init(ell);
+
+  goo_prng_init(&prng);
+
+  memcpy(&entropy[0], GOO_PRNG_DERIVE.data, 32);
+  goo_prng_generate(rng, &entropy[32], 32);
+
+  /* Both produce the same stream. */
+  bench_drbg_init(&ref, entropy, 64);
+  goo_drbg_init_iv(&drbg, GOO_PRNG_DERIVE.mid, GOO_PRNG_DERIVE.data,
+                   &entropy[32], 32);
+
+  for (i = 0; i < 100; i++) {
+    bench_drbg_generate(&ref, out1, i % 33);
+    goo_drbg_generate(&drbg, out2, i % 33);
+    ASSERT(memcmp(out1, out2, i % 33) == 0);
+  }
+
+  BENCH_START();
+
+  for (i = 0; i < ops; i++)
+    bench_drbg_init(&ref, entropy, 64);
+
+  BENCH_STOP("seed (reference)", ops);
+
+  BENCH_START();
+
+  for (i = 0; i < ops; i++)
+    goo_prng_seed(&prng, &entropy[32], &GOO_PRNG_DERIVE);
+
+  BENCH_STOP("seed", ops);
+
+  BENCH_START();
+
+  for (i = 0; i < ops; i++)
+    bench_drbg_generate(&ref, out1, 4);
+
+  BENCH_STOP("generate 4 (reference)", ops);
+
+  BENCH_START();
+
+  for (i = 0; i < ops; i++)
+    goo_drbg_generate(&drbg, out2, 4);
+
+  BENCH_STOP("generate 4", ops);
+
+  /* The `t` search draws up to 168 numbers. */
+  BENCH_START();
+
+  for (i = 0; i < ops / 100; i++) {
+    bench_drbg_init(&ref, entropy, 64);
+
+    for (j = 0; j < 168; j++)
+      bench_drbg_generate(&ref, out1, 4);
+  }
+
+  BENCH_STOP("random_num x168 (reference)", ops / 100);
+
+  BENCH_START();
+
+  for (i = 0; i < ops / 100; i++) {
+    goo_prng_seed(&prng, &entropy[32], &GOO_PRNG_DERIVE);
+
+    for (j = 0; j < 168; j++)
+      goo_prng_random_num(&prng, GOO_PRIMES_LEN - j);
+  }
+
+  BENCH_STOP("random_num x168", ops / 100);
+
+  /* Miller-Rabin on an `ell`-sized prime. */
+  mpz_set_ui(n, 1);
+  mpz_mul_2exp(n, n, GOO_ELL_BITS - 1);
+  ASSERT(goo_next_prime(n, n, &entropy[32], 512));
+
+  BENCH_START();
+
+  for (i = 0; i < ops / 10; i++)
+    ASSERT(goo_is_prime_mr(n, &entropy[32], 16 + 1, 1));
+
+  BENCH_STOP("is_prime_mr (136 bit)", ops / 10);
+
+  /* Fiat-Shamir derivation at 2048 bits. */
+  goo_mpz_import(n, GOO_RSA2048, sizeof(GOO_RSA2048));
+
+  ASSERT(goo_group_init(group, n, 2, 3, 0));
+
+  goo_scratch_init(scratch, group);
+
+  goo_prng_random_int(rng, C1, group->nh);
+  goo_prng_random_int(rng, C2, group->nh);
+  goo_prng_random_int(rng, C3, group->nh);
+  goo_prng_random_int(rng, A, group->nh);
+  goo_prng_random_int(rng, B, group->nh);
+  goo_prng_random_int(rng, C, group->nh);
+  goo_prng_random_int(rng, D, group->nh);
+  goo_prng_random_bits(rng, E, GOO_EXP_BYTES * 8 - 1);
+  mpz_set_ui(t, 0x10001);
+
+  BENCH_START();
+
+  for (i = 0; i < ops / 10; i++) {
+    ASSERT(goo_group_derive(group, scratch, chal, ell, out1,
+                            C1, C2, C3, t, A, B, C, D, E,
+                            entropy, 32));
+  }
+
+  BENCH_STOP("derive rsa2048", ops / 10);
+
+  goo_scratch_uninit(scratch);
+  goo_group_uninit(group);
+  goo_prng_uninit(&prng);
+
+  goo_free(scratch);
+  goo_free(group);
+
+  mpz_clear(n);
+  mpz_clear(C1);
+  mpz_clear(C2);
+  mpz_clear(C3);
+  mpz_clear(t);
+  mpz_clear(A);
+  mpz_clear(B);
+  mpz_clear(C);
+  mpz_clear(D);
+  mpz_clear(E);
+  mpz_clear(chal);
+  mpz_clear(ell);
+}
+
+/*
+ * Primes
+ */
+
+static int
+bench_is_prime_generic(const mpz_t p, const unsigned char *key) {
+  /* goo_is_prime() without the small path. */
+  int ret = goo_is_prime_div(p);
+
+  if (ret != -1)
+    return ret;
+
+  return goo_is_prime_mr(p, key, 16 + 1, 1)
+      && goo_is_prime_lucas(p, 50);
+}
+
+static int
+bench_is_prime_loop(const mpz_t n) {
+  /* goo_is_prime_div() as a division per prime. */
+  size_t i;
+
+  for (i = 1; i < GOO_TEST_PRIMES_LEN; i++) {
+    if (mpz_fdiv_ui(n, goo_test_primes[i]) == 0)
+      return 0;
+  }
+
+  return -1;
+}
+
+static void
+bench_trial_division(goo_prng_t *rng, unsigned long bits) {
+  size_t i, ops = 2000;
+  char name[64];
+  double start;
+  mpz_t n;
+
+  mpz_init(n);
+
+  /* Survivors are the expensive case. */
+  do {
+    goo_prng_random_bits(rng, n, bits);
+    mpz_setbit(n, bits - 1);
+  } while (goo_is_prime_div(n) != -1);
+
+  start = bench_time();
+
+  for (i = 0; i < ops; i++)
+    ASSERT(bench_is_prime_loop(n) == -1);
+
+  sprintf(name, "trial div %lu bit (loop)", bits);
+  bench_report(name, "op", ops, bench_time() - start);
+
+  start = bench_time();
+
+  for (i = 0; i < ops; i++)
+    ASSERT(goo_is_prime_div(n) == -1);
+
+  sprintf(name, "trial div %lu bit (gcd)", bits);
+  bench_report(name, "op", ops, bench_time() - start);
+
+  mpz_clear(n);
+}
+
+static int
+bench_next_prime_walk(mpz_t ret,
+                      const mpz_t p,
+                      const unsigned char *key,
+                      unsigned long max) {
+  /* goo_next_prime() without the sieve. */
+  unsigned long inc = 0;
+
+  mpz_set(ret, p);
+
+  if (mpz_even_p(ret)) {
+    mpz_add_ui(ret, ret, 1);
+    inc += 1;
+  }
+
+  while (!goo_is_prime(ret, key)) {
+    if (max != 0 && inc > max)
+      break;
+
+    mpz_add_ui(ret, ret, 2);
+    inc += 2;
+  }
+
+  return max == 0 || inc <= max;
+}
+
+static void
+bench_ell_search(goo_prng_t *rng, const unsigned char *key, int walk) {
+  /* The `ell` loop in goo_group_sign(), minus the hashing. */
+  size_t i, ops = 200;
+  double start;
+  mpz_t ell;
+  int ok;
+
+  mpz_init(ell);
+
+  start = bench_time();
+
+  for (i = 0; i < ops; i++) {
+    mpz_set_ui(ell, 0);
+
+    while (goo_mpz_bitlen(ell) != GOO_ELL_BITS) {
+      goo_prng_random_bits(rng, ell, GOO_ELL_BITS);
+
+      if (walk)
+        ok = bench_next_prime_walk(ell, ell, key, GOO_ELLDIFF_MAX);
+      else
+        ok = goo_next_prime(ell, ell, key, GOO_ELLDIFF_MAX);
+
+      if (!ok)
+        mpz_set_ui(ell, 0);
+    }
+  }
+
+  bench_report(walk ? "ell search (walk)" : "ell search (sieve)",
+               "op", ops, bench_time() - start);
+
+  mpz_clear(ell);
+}
+
+static void
+bench_primes(goo_prng_t *rng) {
+  unsigned char key[32];
+  mpz_t n, r;
+  size_t i, ops = 2000;
+  double start;
+
+  printf("Primes:\n");
+
+  mpz_init(n);
+  mpz_init(r);
+
+  goo_prng_generate(rng, key, sizeof(key));
+
+  bench_trial_division(rng, GOO_ELL_BITS);
+  bench_trial_division(rng, 2048);
+
+  /* An `ell`-sized prime, as in verification. */
+  goo_prng_random_bits(rng, n, GOO_ELL_BITS);
+  mpz_setbit(n, GOO_ELL_BITS - 1);
+
+  ASSERT(goo_next_prime(n, n, key, 0));
+
+  start = bench_time();
+
+  for (i = 0; i < ops; i++)
+    ASSERT(bench_is_prime_generic(n, key));
+
+  bench_report("is_prime 136 bit (generic)", "op", ops, bench_time() - start);
+
+  start = bench_time();
+
+  for (i = 0; i < ops; i++)
+    ASSERT(goo_is_prime(n, key));
+
+  bench_report("is_prime 136 bit", "op", ops, bench_time() - start);
+
+  /* next_prime as used by the signer. */
+  start = bench_time();
+
+  for (i = 0; i < ops / 10; i++) {
+    goo_prng_random_bits(rng, n, GOO_ELL_BITS);
+    ASSERT(goo_next_prime(r, n, key, 0));
+  }
+
+  bench_report("next_prime 136 bit", "op", ops / 10, bench_time() - start);
+
+  bench_ell_search(rng, key, 1);
+  bench_ell_search(rng, key, 0);
+
+  mpz_clear(n);
+  mpz_clear(r);
+}
+
+/*
+ * Sign
+ */
+
+static void
+bench_key(goo_prng_t *rng, unsigned char *p, unsigned char *q) {
+  /* Two 1024 bit primes. */
+  unsigned char key[32];
+  mpz_t x;
+
+  mpz_init(x);
+
+  goo_prng_generate(rng, key, sizeof(key));
+
+  goo_prng_random_bits(rng, x, 1024);
+  mpz_setbit(x, 1023);
+  ASSERT(goo_next_prime(x, x, key, 0));
+  goo_mpz_export(p, NULL, x);
+
+  goo_prng_random_bits(rng, x, 1024);
+  mpz_setbit(x, 1023);
+  ASSERT(goo_next_prime(x, x, key, 0));
+  goo_mpz_export(q, NULL, x);
+
+  mpz_clear(x);
+}
+
+static void
+bench_sign(goo_prng_t *rng) {
+  static const size_t threads[3] = { 1, 4, 0 };
+  unsigned char s_prime[32], msg[32];
+  unsigned char p[128], q[128];
+  unsigned char *sig = NULL;
+  size_t i, j, sig_len, ops = 10;
+  goo_signer_t *signer;
+  goo_presig_t **presigs;
+  goo_ctx_t *ctx;
+  char name[64];
+  double start;
+
+  printf("Sign (%lu cpus):\n", (unsigned long)goo_pool_cpus());
+
+  goo_prng_generate(rng, s_prime, sizeof(s_prime));
+  goo_prng_generate(rng, msg, sizeof(msg));
+
+  bench_key(rng, p, q);
+
+  ctx = goo_create(GOO_RSA2048, sizeof(GOO_RSA2048), 2, 3, 2048);
+
+  ASSERT(ctx != NULL);
+
+  for (j = 0; j < 3; j++) {
+    start = bench_wall();
+
+    for (i = 0; i < ops; i++) {
+      ASSERT(goo_sign_parallel(ctx, NULL, &sig, &sig_len,
+                               msg, sizeof(msg), s_prime,
+                               p, sizeof(p), q, sizeof(q),
+                               threads[j]));
+      goo_free(sig);
+    }
+
+    sprintf(name, "sign 2048 bit (%lu threads)",
+            (unsigned long)goo_pool_threads(threads[j], 5));
+
+    bench_report(name, "op", ops, bench_wall() - start);
+  }
+
+  start = bench_wall();
+  signer = goo_signer_create(ctx, NULL, s_prime, p, sizeof(p), q, sizeof(q));
+
+  ASSERT(signer != NULL);
+
+  bench_report("signer create 2048 bit", "op", 1, bench_wall() - start);
+
+  for (j = 0; j < 3; j++) {
+    start = bench_wall();
+
+    for (i = 0; i < ops; i++) {
+      ASSERT(goo_signer_sign(signer, NULL, &sig, &sig_len,
+                             msg, sizeof(msg), threads[j]));
+      goo_free(sig);
+    }
+
+    sprintf(name, "signer 2048 bit (%lu threads)",
+            (unsigned long)goo_pool_threads(threads[j], 5));
+
+    bench_report(name, "op", ops, bench_wall() - start);
+  }
+
+  /* Offline/online: only the second half is timed */
+  /* against the message. */
+  presigs = goo_malloc(ops * sizeof(goo_presig_t *));
+
+  start = bench_wall();
+
+  ASSERT(goo_signer_presign_many(signer, presigs, ops, s_prime, 0));
+
+  bench_report("presign 2048 bit", "op", ops, bench_wall() - start);
+
+  start = bench_wall();
+
+  for (i = 0; i < ops; i++) {
+    ASSERT(goo_signer_sign_presig(signer, NULL, presigs[i], &sig, &sig_len,
+                                  msg, sizeof(msg), 1));
+    goo_free(sig);
+  }
+
+  bench_report("online sign 2048 bit", "op", ops, bench_wall() - start);
+
+  goo_free(presigs);
+  goo_signer_destroy(signer);
+  goo_destroy(ctx);
+}
+
+/*
+ * Verify
+ */
+
+static void
+bench_verify(goo_prng_t *rng) {
+  /* Independent signatures: one goo_verify() call */
+  /* each versus a single goo_verify_batch() call. */
+  const unsigned char *msgs[16], *sigs[16], *C1s[16];
+  size_t msg_lens[16], sig_lens[16], C1_lens[16];
+  unsigned char p[128], q[128], n[256];
+  unsigned char msg[16][32];
+  unsigned char s_prime[32];
+  unsigned char *sig[16], *C1;
+  size_t i, j, C1_len, len = 16, reps = 4;
+  goo_scratch_t *scratch;
+  goo_ctx_t *ctx, *ver;
+  int results[16];
+  double start, single, batch;
+  mpz_t x, y;
+
+  printf("Verify:\n");
+
+  mpz_init(x);
+  mpz_init(y);
+
+  bench_key(rng, p, q);
+
+  goo_mpz_import(x, p, sizeof(p));
+  goo_mpz_import(y, q, sizeof(q));
+  mpz_mul(x, x, y);
+  goo_mpz_export(n, NULL, x);
+
+  goo_prng_generate(rng, s_prime, sizeof(s_prime));
+
+  ctx = goo_create(GOO_RSA2048, sizeof(GOO_RSA2048), 2, 3, 2048);
+  ver = goo_create(GOO_RSA2048, sizeof(GOO_RSA2048), 2, 3, 0);
+
+  ASSERT(ctx != NULL && ver != NULL);
+
+  scratch = goo_scratch_create(ver);
+
+  ASSERT(goo_challenge(ctx, NULL, &C1, &C1_len, s_prime, n, sizeof(n)));
+
+  for (i = 0; i < len; i++) {
+    goo_prng_generate(rng, msg[i], sizeof(msg[i]));
+
+    ASSERT(goo_sign(ctx, NULL, &sig[i], &sig_lens[i],
+                    msg[i], sizeof(msg[i]), s_prime,
+                    p, sizeof(p), q, sizeof(q)));
+
+    msgs[i] = msg[i];
+    msg_lens[i] = sizeof(msg[i]);
+    sigs[i] = sig[i];
+    C1s[i] = C1;
+    C1_lens[i] = C1_len;
+  }
+
+  start = bench_wall();
+
+  for (j = 0; j < reps; j++) {
+    for (i = 0; i < len; i++) {
+      ASSERT(goo_verify(ver, scratch, msgs[i], msg_lens[i],
+                        sigs[i], sig_lens[i], C1s[i], C1_lens[i]));
+    }
+  }
+
+  single = bench_wall() - start;
+
+  bench_report("verify 2048 bit", "sig", reps * len, single);
+
+  start = bench_wall();
+
+  for (j = 0; j < reps; j++) {
+    ASSERT(goo_verify_batch(ver, scratch, len, msgs, msg_lens,
+                            sigs, sig_lens, C1s, C1_lens, results));
+  }
+
+  batch = bench_wall() - start;
+
+  bench_report("verify batch (16) 2048 bit", "sig", reps * len, batch);
+
+  printf("  %-28s %10.2fx\n", "batch / single", single / batch);
+
+  for (i = 0; i < len; i++)
+    goo_free(sig[i]);
+
+  goo_free(C1);
+  goo_scratch_destroy(scratch);
+  goo_destroy(ctx);
+  goo_destroy(ver);
+  mpz_clear(x);
+  mpz_clear(y);
+}
+
+/*
+ * Challenge
+ */
+
+static void
+bench_challenge(goo_prng_t *rng) {
+  /* Commitments for many keys against one big */
+  /* comb: one at a time versus table-major. */
+  size_t i, j, ops = 64;
+  mpz_t n[64], s[64], C1[64];
+  mpz_ptr C1p[64];
+  mpz_srcptr np[64], sp[64];
+  unsigned char s_prime[32];
+  goo_scratch_t *scratch;
+  goo_ctx_t *ctx;
+  double start;
+
+  printf("Challenge:\n");
+
+  ctx = goo_create(GOO_AOL2, sizeof(GOO_AOL2), 2, 3, 4096);
+
+  ASSERT(ctx != NULL);
+
+  scratch = goo_scratch_create(ctx);
+
+  for (i = 0; i < ops; i++) {
+    mpz_init(n[i]);
+    mpz_init(s[i]);
+    mpz_init(C1[i]);
+
+    goo_prng_random_bits(rng, n[i], 2048);
+    mpz_setbit(n[i], 2047);
+    mpz_setbit(n[i], 0);
+
+    goo_prng_generate(rng, s_prime, sizeof(s_prime));
+    goo_group_expand_sprime(ctx, scratch, s[i], s_prime);
+
+    C1p[i] = C1[i];
+    np[i] = n[i];
+    sp[i] = s[i];
+  }
+
+  for (j = 0; j < 2; j++) {
+    start = bench_wall();
+
+    for (i = 0; i < ops; i++)
+      ASSERT(goo_group_powgh(ctx, scratch, C1[i], n[i], s[i]));
+
+    bench_report("powgh aol2 (single)", "op", ops, bench_wall() - start);
+
+    start = bench_wall();
+
+    ASSERT(goo_group_powgh_batch(ctx, C1p, np, sp, ops));
+
+    bench_report("powgh aol2 (batch)", "op", ops, bench_wall() - start);
+  }
+
+  for (i = 0; i < ops; i++) {
+    mpz_clear(n[i]);
+    mpz_clear(s[i]);
+    mpz_clear(C1[i]);
+  }
+
+  goo_scratch_destroy(scratch);
+  goo_destroy(ctx);
+}
+
+/*
+ * Decrypt
+ */
+
+static void
+bench_decrypt(goo_prng_t *rng) {
+  unsigned char p[128], q[128], n[256], e[3] = { 0x01, 0x00, 0x01 };
+  unsigned char entropy[32], msg[32];
+  unsigned char *ct, *pt;
+  size_t i, ct_len, pt_len, ops = 200;
+  goo_decryptor_t *key;
+  double start;
+  mpz_t x, y, d, t;
+
+  printf("Decrypt:\n");
+
+  mpz_init(x);
+  mpz_init(y);
+  mpz_init(d);
+  mpz_init(t);
+
+  goo_prng_generate(rng, entropy, sizeof(entropy));
+  goo_prng_generate(rng, msg, sizeof(msg));
+
+  do {
+    goo_prng_random_bits(rng, x, 1024);
+    mpz_setbit(x, 1023);
+    ASSERT(goo_next_prime(x, x, msg, 0));
+
+    goo_prng_random_bits(rng, y, 1024);
+    mpz_setbit(y, 1023);
+    ASSERT(goo_next_prime(y, y, msg, 0));
+
+    goo_mpz_import(d, e, sizeof(e));
+    mpz_sub_ui(x, x, 1);
+    mpz_sub_ui(y, y, 1);
+    mpz_mul(t, x, y);
+    mpz_add_ui(x, x, 1);
+    mpz_add_ui(y, y, 1);
+  } while (!mpz_invert(d, d, t));
+
+  goo_mpz_export(p, NULL, x);
+  goo_mpz_export(q, NULL, y);
+
+  mpz_mul(t, x, y);
+  goo_mpz_export(n, NULL, t);
+
+  ASSERT(goo_encrypt(NULL, &ct, &ct_len, msg, sizeof(msg), n, sizeof(n),
+                     e, sizeof(e), NULL, 0, entropy));
+
+  /* The private operation as it was: a full-size */
+  /* powm modulo n. */
+  goo_unveil(x, ct, ct_len, t, GOO_MAX_RSA_BITS + 8);
+
+  start = bench_time();
+
+  for (i = 0; i < ops; i++)
+    mpz_powm(y, x, d, t);
+
+  bench_report("rsa 2048 bit (no crt)", "op", ops, bench_time() - start);
+
+  start = bench_time();
+
+  for (i = 0; i < ops; i++) {
+    ASSERT(goo_decrypt(NULL, &pt, &pt_len, ct, ct_len, p, sizeof(p),
+                       q, sizeof(q), e, sizeof(e), NULL, 0, entropy));
+    goo_free(pt);
+  }
+
+  bench_report("decrypt 2048 bit", "op", ops, bench_time() - start);
+
+  key = goo_decryptor_create(p, sizeof(p), q, sizeof(q),
+                             e, sizeof(e), entropy);
+
+  ASSERT(key != NULL);
+
+  start = bench_time();
+
+  for (i = 0; i < ops; i++) {
+    ASSERT(goo_decryptor_decrypt(key, &pt, &pt_len, ct, ct_len, NULL, 0));
+    goo_free(pt);
+  }
+
+  bench_report("decrypt 2048 bit (cached)", "op", ops, bench_time() - start);
+
+  goo_decryptor_destroy(key);
+  goo_free(ct);
+
+  mpz_clear(x);
+  mpz_clear(y);
+  mpz_clear(d);
+  mpz_clear(t);
+}
+
+/*
+ * Main
+ */
+
+int
+main(void) {
+  goo_prng_t rng;
+
+  bench_seed(&rng);
+
+  bench_sha256(&rng);
+  bench_drbg(&rng);
+  bench_primes(&rng);
+  bench_sign(&rng);
+  bench_verify(&rng);
+  bench_challenge(&rng);
+  bench_decrypt(&rng);
+
+  goo_prng_uninit(&rng);
+
+  return 0;
+}
@@ -16,8 +16,80 @@
 static const unsigned char ZERO[1] = {0x00};
 static const unsigned char ONE[1] = {0x01};
 
+/* SHA256 state after 64 bytes of 0x36 (HMAC ipad, K = 0). */
+static const uint32_t IPAD0[8] = {
+  0xf454dead, 0x9725214f, 0x90daf2a0, 0xdf1228ea,
+  0x64e5750f, 0xa3924181, 0x824a932b, 0xf8e04e32
+};
+
+/* SHA256 state after 64 bytes of 0x5c (HMAC opad, K = 0). */
+static const uint32_t OPAD0[8] = {
+  0xd385480f, 0x7abb6477, 0x37c9c538, 0x5dd82467,
+  0x8e043a72, 0x753434b0, 0xdeb82818, 0x361d45a6
+};
+
+/*
+ * HMAC-DRBG
+ *
+ * Every HMAC below is keyed with K, and K only
+ * changes during an update. We key `kmac` once
+ * per K (two compressions) and resume from a
+ * copy of it for each HMAC, instead of hashing
+ * the ipad and opad blocks again every time.
+ */
+
+static void
+goo_drbg_resume(goo_sha256_t *ctx, const uint32_t *state, size_t size) {
+  memcpy(ctx->state, state, sizeof(ctx->state));
+  memset(ctx->block, 0x00, sizeof(ctx->block));
+  ctx->size = size;
+}
+
+static void
+goo_drbg_rekey(goo_drbg_t *drbg) {
+  goo_hmac_init(&drbg->kmac, drbg->K, GOO_SHA256_HASH_SIZE);
+}
+
 static void
-goo_drbg_update(goo_drbg_t *drbg, const unsigned char *seed, size_t seed_len);
+goo_drbg_step(goo_drbg_t *drbg,
+              const unsigned char *sep,
+              const unsigned char *iv,
+              const unsigned char *seed,
+              size_t seed_len) {
+  /* K = HMAC(K, V || sep || iv || seed) */
+  /* V = HMAC(K, V) */
+  goo_hmac_t hmac;
+
+  memcpy(&hmac, &drbg->kmac, sizeof(goo_hmac_t));
+
+  goo_hmac_update(&hmac, drbg->V, GOO_SHA256_HASH_SIZE);
+  goo_hmac_update(&hmac, sep, 1);
+
+  if (iv != NULL)
+    goo_hmac_update(&hmac, iv, GOO_DRBG_IV_SIZE);
+
+  if (seed_len != 0)
+    goo_hmac_update(&hmac, seed, seed_len);
+
+  goo_hmac_final(&hmac, drbg->K);
+
+  goo_drbg_rekey(drbg);
+
+  memcpy(&hmac, &drbg->kmac, sizeof(goo_hmac_t));
+
+  goo_hmac_update(&hmac, drbg->V, GOO_SHA256_HASH_SIZE);
+  goo_hmac_final(&hmac, drbg->V);
+
+  goo_cleanse(&hmac, sizeof(hmac));
+}
+
+static void
+goo_drbg_update(goo_drbg_t *drbg, const unsigned char *seed, size_t seed_len) {
+  goo_drbg_step(drbg, ZERO, NULL, seed, seed_len);
+
+  if (seed_len != 0)
+    goo_drbg_step(drbg, ONE, NULL, seed, seed_len);
+}
 
 void
 goo_drbg_init(goo_drbg_t *drbg, const unsigned char *seed, size_t seed_len) {
@@ -27,35 +99,70 @@ goo_drbg_init(goo_drbg_t *drbg, const unsigned char *seed, size_t seed_len) {
   memset(drbg->K, 0x00, GOO_SHA256_HASH_SIZE);
   memset(drbg->V, 0x01, GOO_SHA256_HASH_SIZE);
 
+  goo_drbg_resume(&drbg->kmac.inner, IPAD0, GOO_SHA256_BLOCK_SIZE);
+  goo_drbg_resume(&drbg->kmac.outer, OPAD0, GOO_SHA256_BLOCK_SIZE);
+
   goo_drbg_update(drbg, seed, seed_len);
 }
 
-static void
-goo_drbg_update(goo_drbg_t *drbg, const unsigned char *seed, size_t seed_len) {
-  goo_hmac_init(&drbg->kmac, drbg->K, GOO_SHA256_HASH_SIZE);
-  goo_hmac_update(&drbg->kmac, drbg->V, GOO_SHA256_HASH_SIZE);
-  goo_hmac_update(&drbg->kmac, ZERO, 1);
+void
+goo_drbg_iv(uint32_t *mid, const unsigned char *iv) {
+  /* The first HMAC of a seeding is keyed with K = 0 */
+  /* and starts with V || 0x00 || iv, none of which */
+  /* depends on the rest of the seed. Its first 31 */
+  /* bytes of `iv` complete a block we can save. */
+  unsigned char V[GOO_SHA256_HASH_SIZE];
+  goo_sha256_t ctx;
+
+  memset(V, 0x01, GOO_SHA256_HASH_SIZE);
+
+  goo_drbg_resume(&ctx, IPAD0, GOO_SHA256_BLOCK_SIZE);
+
+  goo_sha256_update(&ctx, V, GOO_SHA256_HASH_SIZE);
+  goo_sha256_update(&ctx, ZERO, 1);
+  goo_sha256_update(&ctx, iv, GOO_DRBG_IV_SIZE - 1);
+
+  ASSERT((ctx.size & 63) == 0);
+
+  memcpy(mid, ctx.state, sizeof(ctx.state));
+}
+
+void
+goo_drbg_init_iv(goo_drbg_t *drbg,
+                 const uint32_t *mid,
+                 const unsigned char *iv,
+                 const unsigned char *seed,
+                 size_t seed_len) {
+  goo_hmac_t hmac;
+
+  ASSERT(seed != NULL);
+  ASSERT(mid != NULL && iv != NULL);
+
+  memset(drbg->V, 0x01, GOO_SHA256_HASH_SIZE);
+
+  /* K = HMAC(0, V || 0x00 || iv || seed) */
+  goo_drbg_resume(&hmac.inner, mid, GOO_SHA256_BLOCK_SIZE * 2);
+  goo_drbg_resume(&hmac.outer, OPAD0, GOO_SHA256_BLOCK_SIZE);
+
+  goo_hmac_update(&hmac, iv + GOO_DRBG_IV_SIZE - 1, 1);
 
   if (seed_len != 0)
-    goo_hmac_update(&drbg->kmac, seed, seed_len);
+    goo_hmac_update(&hmac, seed, seed_len);
 
-  goo_hmac_final(&drbg->kmac, drbg->K);
+  goo_hmac_final(&hmac, drbg->K);
 
-  goo_hmac_init(&drbg->kmac, drbg->K, GOO_SHA256_HASH_SIZE);
-  goo_hmac_update(&drbg->kmac, drbg->V, GOO_SHA256_HASH_SIZE);
-  goo_hmac_final(&drbg->kmac, drbg->V);
-
-  if (seed_len != 0) {
-    goo_hmac_init(&drbg->kmac, drbg->K, GOO_SHA256_HASH_SIZE);
-    goo_hmac_update(&drbg->kmac, drbg->V, GOO_SHA256_HASH_SIZE);
-    goo_hmac_update(&drbg->kmac, ONE, 1);
-    goo_hmac_update(&drbg->kmac, seed, seed_len);
-    goo_hmac_final(&drbg->kmac, drbg->K);
-
-    goo_hmac_init(&drbg->kmac, drbg->K, GOO_SHA256_HASH_SIZE);
-    goo_hmac_update(&drbg->kmac, drbg->V, GOO_SHA256_HASH_SIZE);
-    goo_hmac_final(&drbg->kmac, drbg->V);
-  }
+  /* V = HMAC(K, V) */
+  goo_drbg_rekey(drbg);
+
+  memcpy(&hmac, &drbg->kmac, sizeof(goo_hmac_t));
+
+  goo_hmac_update(&hmac, drbg->V, GOO_SHA256_HASH_SIZE);
+  goo_hmac_final(&hmac, drbg->V);
+
+  goo_cleanse(&hmac, sizeof(hmac));
+
+  /* Second half of the update, as usual. */
+  goo_drbg_step(drbg, ONE, iv, seed, seed_len);
 }
 
 void
@@ -64,11 +171,13 @@ goo_drbg_generate(goo_drbg_t *drbg, void *out, size_t len) {
   size_t pos = 0;
   size_t left = len;
   size_t outlen = GOO_SHA256_HASH_SIZE;
+  goo_hmac_t hmac;
 
   while (pos < len) {
-    goo_hmac_init(&drbg->kmac, drbg->K, GOO_SHA256_HASH_SIZE);
-    goo_hmac_update(&drbg->kmac, drbg->V, GOO_SHA256_HASH_SIZE);
-    goo_hmac_final(&drbg->kmac, drbg->V);
+    memcpy(&hmac, &drbg->kmac, sizeof(goo_hmac_t));
+
+    goo_hmac_update(&hmac, drbg->V, GOO_SHA256_HASH_SIZE);
+    goo_hmac_final(&hmac, drbg->V);
 
     if (outlen > left)
       outlen = left;
@@ -82,5 +191,7 @@ goo_drbg_generate(goo_drbg_t *drbg, void *out, size_t len) {
   ASSERT(pos == len);
   ASSERT(left == 0);
 
+  goo_cleanse(&hmac, sizeof(hmac));
+
   goo_drbg_update(drbg, NULL, 0);
 }
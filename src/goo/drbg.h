@@ -19,8 +19,10 @@
 extern "C" {
 #endif
 
+#define GOO_DRBG_IV_SIZE 32
+
 typedef struct goo_drbg_s {
-  goo_hmac_t kmac;
+  goo_hmac_t kmac; /* keyed with K */
   unsigned char K[GOO_SHA256_HASH_SIZE];
   unsigned char V[GOO_SHA256_HASH_SIZE];
 } goo_drbg_t;
@@ -28,6 +30,20 @@ typedef struct goo_drbg_s {
 void
 goo_drbg_init(goo_drbg_t *drbg, const unsigned char *seed, size_t seed_len);
 
+/* Computes the state needed by goo_drbg_init_iv() */
+/* for a fixed 32 byte seed prefix. */
+void
+goo_drbg_iv(uint32_t *mid, const unsigned char *iv);
+
+/* Same as goo_drbg_init(drbg, iv || seed), but */
+/* resumes from `mid` (see goo_drbg_iv()). */
+void
+goo_drbg_init_iv(goo_drbg_t *drbg,
+                 const uint32_t *mid,
+                 const unsigned char *iv,
+                 const unsigned char *seed,
+                 size_t seed_len);
+
 void
 goo_drbg_generate(goo_drbg_t *drbg, void *out, size_t len);
 
@@ -34,13 +34,14 @@
 #include <stdint.h>
 #include <limits.h>
 
-#ifdef _WIN32
-/* For SecureZeroMemory (actually defined in winbase.h). */
-#include <windows.h>
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
 #endif
 
 #include "internal.h"
 #include "goo.h"
+#include "moduli.h"
+#include "pool.h"
 #include "primes.h"
 #include "util.h"
 
@@ -88,23 +89,6 @@ goo_free(void *ptr) {
  * Helpers
  */
 
-static void
-goo_cleanse(void *ptr, size_t len) {
-#if defined(_WIN32)
-  /* https://github.com/jedisct1/libsodium/blob/3b26a5c/src/libsodium/sodium/utils.c#L112 */
-  SecureZeroMemory(ptr, len);
-#elif defined(__GNUC__)
-  /* https://github.com/torvalds/linux/blob/37d4e84/include/linux/string.h#L233 */
-  /* https://github.com/torvalds/linux/blob/37d4e84/include/linux/compiler-gcc.h#L21 */
-  memset(ptr, 0, len);
-  __asm__ __volatile__("": :"r"(ptr) :"memory");
-#else
-  /* http://www.daemonology.net/blog/2014-09-04-how-to-zero-a-buffer.html */
-  static void *(*const volatile memset_ptr)(void *, int, size_t) = memset;
-  (memset_ptr)(ptr, 0, len);
-#endif
-}
-
 static void
 goo_swap(unsigned long *x, unsigned long *y) {
   unsigned long z = *x;
@@ -137,6 +121,39 @@ safe_equal_bytes(const unsigned char *x, const unsigned char *y, size_t len) {
  * GMP helpers
  */
 
+#if defined(GMP_LIMB_BITS)
+#define GOO_LIMB_WIDTH GMP_LIMB_BITS
+#elif ULONG_MAX == 0xffffffffUL
+#define GOO_LIMB_WIDTH 32
+#elif (ULONG_MAX >> 31 >> 31) == 3
+#define GOO_LIMB_WIDTH 64
+#endif
+
+#if defined(GOO_LIMB_WIDTH) && GOO_LIMB_WIDTH == 64 \
+  && defined(__SIZEOF_INT128__)
+__extension__ typedef unsigned __int128 goo_dlimb_t;
+#define GOO_HAS_DLIMB
+#elif defined(GOO_LIMB_WIDTH) && GOO_LIMB_WIDTH == 32
+typedef uint64_t goo_dlimb_t;
+#define GOO_HAS_DLIMB
+#endif
+
+#ifdef GOO_HAS_DLIMB
+
+#if defined(__GNUC__)
+#define GOO_INLINE __inline__ __attribute__((always_inline))
+#else
+#define GOO_INLINE
+#endif
+
+/* (hi, lo) = a * b + c + d */
+#define goo_mac(hi, lo, a, b, c, d) do {                            \
+  goo_dlimb_t _w = (goo_dlimb_t)(a) * (b) + (c) + (d);              \
+  (lo) = (mp_limb_t)_w;                                             \
+  (hi) = (mp_limb_t)(_w >> GOO_LIMB_WIDTH);                         \
+} while (0)
+#endif
+
 #define goo_mpz_import(ret, data, len) \
   mpz_import((ret), (len), 1, sizeof((data)[0]), 0, 0, (data))
 
@@ -344,25 +361,33 @@ goo_mpz_clear(mpz_t n) {
  */
 
 static int
-goo_hash_int(goo_sha256_t *ctx,
-             const mpz_t n,
-             size_t size,
-             unsigned char *slab) {
+goo_pad_int(unsigned char *out, const mpz_t n, size_t size) {
   size_t len = goo_mpz_bytelen(n);
   size_t pos;
 
   if (len > size)
     return 0;
 
-  if (len > GOO_MAX_RSA_BYTES)
-    return 0;
-
   pos = size - len;
 
-  memset(slab, 0x00, pos);
+  memset(out, 0x00, pos);
 
   if (len != 0)
-    goo_mpz_export(slab + pos, NULL, n);
+    goo_mpz_export(out + pos, NULL, n);
+
+  return 1;
+}
+
+static int
+goo_hash_int(goo_sha256_t *ctx,
+             const mpz_t n,
+             size_t size,
+             unsigned char *slab) {
+  if (size > GOO_MAX_RSA_BYTES)
+    return 0;
+
+  if (!goo_pad_int(slab, n, size))
+    return 0;
 
   goo_sha256_update(ctx, slab, size);
 
@@ -388,26 +413,23 @@ goo_prng_uninit(goo_prng_t *prng) {
 static void
 goo_prng_seed(goo_prng_t *prng,
               const unsigned char *key,
-              const unsigned char *iv) {
-  unsigned char entropy[64];
-
-  memcpy(&entropy[0], iv, 32);
-  memcpy(&entropy[32], key, 32);
-
-  goo_drbg_init(&prng->ctx, entropy, sizeof(entropy));
+              const goo_prng_iv_t *iv) {
+  /* Equivalent to seeding the DRBG with iv || key. */
+  goo_drbg_init_iv(&prng->ctx, iv->mid, iv->data, key, 32);
 
   mpz_set_ui(prng->save, 0);
   prng->total = 0;
 }
 
 static int
-goo_prng_seed_sign(goo_prng_t *prng,
-                   const mpz_t p,
-                   const mpz_t q,
-                   const unsigned char *s_prime,
-                   const unsigned char *msg,
-                   size_t msg_len,
-                   unsigned char *slab) {
+goo_prng_seed_key(goo_prng_t *prng,
+                  const mpz_t p,
+                  const mpz_t q,
+                  const unsigned char *s_prime,
+                  const unsigned char *msg,
+                  size_t msg_len,
+                  const goo_prng_iv_t *iv,
+                  unsigned char *slab) {
   int r = 0;
   goo_sha256_t ctx;
   unsigned char key[GOO_SHA256_HASH_SIZE];
@@ -424,7 +446,7 @@ goo_prng_seed_sign(goo_prng_t *prng,
   goo_sha256_update(&ctx, msg, msg_len);
   goo_sha256_final(&ctx, key);
 
-  goo_prng_seed(prng, key, GOO_PRNG_SIGN);
+  goo_prng_seed(prng, key, iv);
 
   r = 1;
 fail:
@@ -434,6 +456,18 @@ fail:
   return r;
 }
 
+static int
+goo_prng_seed_sign(goo_prng_t *prng,
+                   const mpz_t p,
+                   const mpz_t q,
+                   const unsigned char *s_prime,
+                   const unsigned char *msg,
+                   size_t msg_len,
+                   unsigned char *slab) {
+  return goo_prng_seed_key(prng, p, q, s_prime, msg, msg_len,
+                           &GOO_PRNG_SIGN, slab);
+}
+
 static void
 goo_prng_generate(goo_prng_t *prng, void *out, size_t len) {
   goo_drbg_generate(&prng->ctx, out, len);
@@ -441,24 +475,40 @@ goo_prng_generate(goo_prng_t *prng, void *out, size_t len) {
 
 static void
 goo_prng_random_bits(goo_prng_t *prng, mpz_t ret, unsigned long bits) {
+  /* Conceptually, for every 256 bit chunk drawn: */
+  /*   ret = (ret << 256) | chunk */
+  /* The chunks are gathered into one buffer and */
+  /* imported at once (the DRBG is still invoked */
+  /* once per chunk, preserving the stream). */
   unsigned long total = prng->total;
-  unsigned char out[GOO_SHA256_HASH_SIZE];
+  unsigned char out[GOO_PRNG_CHUNKS * GOO_SHA256_HASH_SIZE];
+  size_t used = 0;
   unsigned long left;
 
   /* ret = save */
   mpz_set(ret, prng->save);
 
   while (total < bits) {
-    /* ret = ret << 256 */
-    mpz_mul_2exp(ret, ret, sizeof(out) * 8);
+    unsigned long want = (bits - total + 255) / 256;
+    size_t i;
+
+    if (want > GOO_PRNG_CHUNKS)
+      want = GOO_PRNG_CHUNKS;
+
+    for (i = 0; i < want; i++)
+      goo_prng_generate(prng, &out[i * 32], 32);
 
-    /* tmp = random 256 bit integer */
-    goo_prng_generate(prng, out, sizeof(out));
-    goo_mpz_import(prng->tmp, out, sizeof(out));
+    if (want * 32 > used)
+      used = want * 32;
 
-    /* ret = ret | tmp */
+    /* tmp = random (want * 256) bit integer */
+    goo_mpz_import(prng->tmp, out, want * 32);
+
+    /* ret = (ret << (want * 256)) | tmp */
+    mpz_mul_2exp(ret, ret, want * 256);
     mpz_ior(ret, ret, prng->tmp);
-    total += sizeof(out) * 8;
+
+    total += want * 256;
   }
 
   left = total - bits;
@@ -469,6 +519,9 @@ goo_prng_random_bits(goo_prng_t *prng, mpz_t ret, unsigned long bits) {
 
   /* ret >>= left */
   mpz_tdiv_q_2exp(ret, ret, left);
+
+  /* The raw output becomes secret scalars. */
+  goo_cleanse(out, used);
 }
 
 static void
@@ -798,13 +851,113 @@ fail:
   return r;
 }
 
+static int
+goo_jacobi_ui(unsigned long a, unsigned long b) {
+  /* jacobi(a, b) for odd b. */
+  unsigned long t;
+  int j = 1;
+
+  a %= b;
+
+  while (a != 0) {
+    while ((a & 1) == 0) {
+      a >>= 1;
+
+      if ((b & 7) == 3 || (b & 7) == 5)
+        j = -j;
+    }
+
+    t = a;
+    a = b;
+    b = t;
+
+    if ((a & 3) == 3 && (b & 3) == 3)
+      j = -j;
+
+    a %= b;
+  }
+
+  return b == 1 ? j : 0;
+}
+
+static void
+goo_mpz_mod_primes(unsigned long *out, const mpz_t n) {
+  /* out[i] = n mod goo_primes[i], with one bignum */
+  /* reduction per word-sized product of primes. */
+  size_t i = 0;
+
+  while (i < GOO_PRIMES_LEN) {
+    unsigned long m = goo_primes[i];
+    unsigned long r;
+    size_t j = i + 1;
+
+    while (j < GOO_PRIMES_LEN && m <= ULONG_MAX / goo_primes[j])
+      m *= goo_primes[j++];
+
+    r = mpz_fdiv_ui(n, m);
+
+    for (; i < j; i++)
+      out[i] = r % goo_primes[i];
+  }
+}
+
+static int
+goo_legendre_ui(unsigned long t, unsigned long r, unsigned long p8) {
+  /* (t | p) for a small prime `t` and an odd prime */
+  /* p > t, given r = p mod t and p8 = p mod 8. */
+  int j;
+
+  if (t == 2)
+    return (p8 == 1 || p8 == 7) ? 1 : -1;
+
+  /* (t | p) = (p | t) * (-1)^((t - 1) / 2 * (p - 1) / 2) */
+  j = goo_jacobi_ui(r, t);
+
+  if ((t & 3) == 3 && (p8 & 3) == 3)
+    j = -j;
+
+  return j;
+}
+
+static void
+goo_primes_qr(unsigned char *out, const mpz_t p, const mpz_t q) {
+  /* out[i] = 1 if goo_primes[i] is a square in */
+  /* F(p * q), i.e. if goo_mpz_sqrtpq() would find */
+  /* its root. `p` and `q` are odd primes above */
+  /* the largest of goo_primes. */
+  unsigned long rp[GOO_PRIMES_LEN];
+  unsigned long rq[GOO_PRIMES_LEN];
+  unsigned long p8 = mpz_getlimbn(p, 0) & 7;
+  unsigned long q8 = mpz_getlimbn(q, 0) & 7;
+  size_t i;
+
+  goo_mpz_mod_primes(rp, p);
+  goo_mpz_mod_primes(rq, q);
+
+  for (i = 0; i < GOO_PRIMES_LEN; i++) {
+    out[i] = goo_legendre_ui(goo_primes[i], rp[i], p8) == 1
+          && goo_legendre_ui(goo_primes[i], rq[i], q8) == 1;
+  }
+
+  goo_cleanse(rp, sizeof(rp));
+  goo_cleanse(rq, sizeof(rq));
+}
+
 /*
  * Primes
  */
 
 static int
 goo_is_prime_div(const mpz_t n) {
-  size_t i;
+  /* Trial division by goo_test_primes. Rather than a */
+  /* division per prime, n is checked for a common */
+  /* factor with their product: a single gcd. */
+  mp_limb_t limbs[GOO_TEST_PRIMORIAL_LEN];
+  mp_size_t size = 0;
+  size_t lo, hi, mid;
+  unsigned long x;
+  mpz_t prod, g;
+  int r;
 
   /* if n <= 1 */
   if (mpz_cmp_ui(n, 1) <= 0)
@@ -818,17 +971,64 @@ goo_is_prime_div(const mpz_t n) {
     return 0;
   }
 
-  for (i = 0; i < GOO_TEST_PRIMES_LEN; i++) {
-    /* if n == test_primes[i] */
-    if (mpz_cmp_ui(n, goo_test_primes[i]) == 0)
-      return 1;
+  /* if n <= test_primes[-1], n is prime iff it is in the table */
+  if (mpz_cmp_ui(n, goo_test_primes[GOO_TEST_PRIMES_LEN - 1]) <= 0) {
+    x = mpz_get_ui(n);
+    lo = 0;
+    hi = GOO_TEST_PRIMES_LEN;
 
-    /* if n mod test_primes[i] == 0 */
-    if (mpz_fdiv_ui(n, goo_test_primes[i]) == 0)
-      return 0;
+    while (lo < hi) {
+      mid = (lo + hi) >> 1;
+
+      if (goo_test_primes[mid] < x)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    return goo_test_primes[lo] == x;
+  }
+
+#if defined(GOO_LIMB_WIDTH) && GOO_LIMB_WIDTH == 64
+  for (lo = 0; lo < GOO_TEST_PRIMORIAL_LEN; lo += 2) {
+    limbs[size] = goo_test_primorial[lo];
+
+    if (lo + 1 < GOO_TEST_PRIMORIAL_LEN)
+      limbs[size] |= (mp_limb_t)goo_test_primorial[lo + 1] << 32;
+
+    size += 1;
   }
 
-  return -1;
+  mpz_roinit_n(prod, limbs, size);
+#elif defined(GOO_LIMB_WIDTH) && GOO_LIMB_WIDTH == 32
+  for (lo = 0; lo < GOO_TEST_PRIMORIAL_LEN; lo++)
+    limbs[size++] = goo_test_primorial[lo];
+
+  mpz_roinit_n(prod, limbs, size);
+#else
+  (void)limbs;
+  (void)size;
+
+  mpz_init(prod);
+  mpz_import(prod, GOO_TEST_PRIMORIAL_LEN, -1,
+             sizeof(goo_test_primorial[0]), 0, 0,
+             goo_test_primorial);
+#endif
+
+  mpz_init(g);
+
+  /* if gcd(n, test_primes[1] * ... * test_primes[-1]) != 1 */
+  mpz_gcd(g, prod, n);
+
+  r = mpz_cmp_ui(g, 1) == 0 ? -1 : 0;
+
+  mpz_clear(g);
+
+#if !defined(GOO_LIMB_WIDTH) || (GOO_LIMB_WIDTH != 64 && GOO_LIMB_WIDTH != 32)
+  mpz_clear(prod);
+#endif
+
+  return r;
 }
 
 /* https://github.com/golang/go/blob/aadaec5/src/math/big/prime.go#L81 */
@@ -875,7 +1075,7 @@ goo_is_prime_mr(const mpz_t n,
 
   /* Setup PRNG. */
   goo_prng_init(&prng);
-  goo_prng_seed(&prng, key, GOO_PRNG_PRIMALITY);
+  goo_prng_seed(&prng, key, &GOO_PRNG_PRIMALITY);
 
   for (i = 0; i < reps; i++) {
     if (i == reps - 1 && force2) {
@@ -1087,364 +1287,1986 @@ fail:
   return ret;
 }
 
-static int
-goo_is_prime(const mpz_t p, const unsigned char *key) {
-  int ret = goo_is_prime_div(p);
+/*
+ * Small Primes
+ *
+ * `ell` is at most 136 bits, yet checking it is a
+ * tour of the generic mpz code: 1000 divisions,
+ * 17 mpz_powm calls and a Lucas sequence built
+ * from mpz_mul and mpz_mod. For anything up to
+ * 192 bits we run the same three tests (with the
+ * same random bases) on fixed-size limb arrays
+ * in the Montgomery domain instead.
+ */
 
-  if (ret != -1)
-    return ret;
+#ifdef GOO_HAS_DLIMB
 
-  if (!goo_is_prime_mr(p, key, 16 + 1, 1))
-    return 0;
+#define GOO_SMALL_BITS 192
+#define GOO_SMALL_LIMBS (GOO_SMALL_BITS / GOO_LIMB_WIDTH)
 
-  if (!goo_is_prime_lucas(p, 50))
-    return 0;
+typedef struct goo_small_s {
+  mp_limb_t k; /* -n^-1 mod 2^GOO_LIMB_WIDTH */
+  mp_limb_t n[GOO_SMALL_LIMBS];
+  mp_limb_t one[GOO_SMALL_LIMBS]; /* R mod n */
+  mp_limb_t r2[GOO_SMALL_LIMBS]; /* R^2 mod n */
+  uint64_t parts[GOO_SMALL_BITS / 48]; /* n in 48 bit digits */
+} goo_small_t;
+
+static GOO_INLINE int
+goo_small_eq(const mp_limb_t *a, const mp_limb_t *b) {
+  mp_size_t i;
+
+  for (i = 0; i < GOO_SMALL_LIMBS; i++) {
+    if (a[i] != b[i])
+      return 0;
+  }
 
   return 1;
 }
 
-static int
-goo_next_prime(mpz_t ret,
-               const mpz_t p,
-               const unsigned char *key,
-               unsigned long max) {
-  unsigned long inc = 0;
+static GOO_INLINE int
+goo_small_zero(const mp_limb_t *a) {
+  mp_limb_t z = 0;
+  mp_size_t i;
 
-  mpz_set(ret, p);
+  for (i = 0; i < GOO_SMALL_LIMBS; i++)
+    z |= a[i];
 
-  if (mpz_even_p(ret)) {
-    mpz_add_ui(ret, ret, 1);
-    inc += 1;
+  return z == 0;
+}
+
+static GOO_INLINE void
+goo_small_add(const goo_small_t *sm,
+              mp_limb_t *rp,
+              const mp_limb_t *ap,
+              const mp_limb_t *bp) {
+  /* rp = ap + bp mod n */
+  mp_limb_t tp[GOO_SMALL_LIMBS];
+  mp_limb_t c = 0;
+  mp_limb_t b = 0;
+  goo_dlimb_t w;
+  mp_size_t i;
+
+  for (i = 0; i < GOO_SMALL_LIMBS; i++) {
+    w = (goo_dlimb_t)ap[i] + bp[i] + c;
+    rp[i] = (mp_limb_t)w;
+    c = (mp_limb_t)(w >> GOO_LIMB_WIDTH);
   }
 
-  while (!goo_is_prime(ret, key)) {
-    if (max != 0 && inc > max)
-      break;
+  for (i = 0; i < GOO_SMALL_LIMBS; i++) {
+    w = (goo_dlimb_t)rp[i] - sm->n[i] - b;
+    tp[i] = (mp_limb_t)w;
+    b = (mp_limb_t)(w >> GOO_LIMB_WIDTH) & 1;
+  }
 
-    mpz_add_ui(ret, ret, 2);
-    inc += 2;
+  if (c != 0 || b == 0) {
+    for (i = 0; i < GOO_SMALL_LIMBS; i++)
+      rp[i] = tp[i];
   }
+}
 
-  if (max != 0 && inc > max)
-    return 0;
+static GOO_INLINE void
+goo_small_sub(const goo_small_t *sm,
+              mp_limb_t *rp,
+              const mp_limb_t *ap,
+              const mp_limb_t *bp) {
+  /* rp = ap - bp mod n */
+  mp_limb_t b = 0;
+  mp_limb_t c = 0;
+  goo_dlimb_t w;
+  mp_size_t i;
+
+  for (i = 0; i < GOO_SMALL_LIMBS; i++) {
+    w = (goo_dlimb_t)ap[i] - bp[i] - b;
+    rp[i] = (mp_limb_t)w;
+    b = (mp_limb_t)(w >> GOO_LIMB_WIDTH) & 1;
+  }
 
-  return 1;
+  if (b != 0) {
+    for (i = 0; i < GOO_SMALL_LIMBS; i++) {
+      w = (goo_dlimb_t)rp[i] + sm->n[i] + c;
+      rp[i] = (mp_limb_t)w;
+      c = (mp_limb_t)(w >> GOO_LIMB_WIDTH);
+    }
+  }
 }
 
-/*
- * Signature
- */
+static GOO_INLINE void
+goo_small_reduce(const goo_small_t *sm, mp_limb_t *rp, mp_limb_t *tp) {
+  /* rp = tp * R^-1 mod n (see goo_mont_reduce_fixed()) */
+  mp_limb_t sp[GOO_SMALL_LIMBS];
+  mp_limb_t m, c, b;
+  goo_dlimb_t w;
+  int i, j;
 
-static void
-goo_sig_init(goo_sig_t *sig) {
-  mpz_init(sig->C2);
-  mpz_init(sig->C3);
-  mpz_init(sig->t);
-  mpz_init(sig->chal);
-  mpz_init(sig->ell);
-  mpz_init(sig->Aq);
-  mpz_init(sig->Bq);
-  mpz_init(sig->Cq);
-  mpz_init(sig->Dq);
-  mpz_init(sig->Eq);
-  mpz_init(sig->z_w);
-  mpz_init(sig->z_w2);
-  mpz_init(sig->z_s1);
-  mpz_init(sig->z_a);
-  mpz_init(sig->z_an);
-  mpz_init(sig->z_s1w);
-  mpz_init(sig->z_sa);
-  mpz_init(sig->z_s2);
-}
+  for (i = 0; i < GOO_SMALL_LIMBS; i++) {
+    m = tp[i] * sm->k;
+    c = 0;
 
-static void
-goo_sig_uninit(goo_sig_t *sig) {
-  mpz_clear(sig->C2);
-  mpz_clear(sig->C3);
-  mpz_clear(sig->t);
-  mpz_clear(sig->chal);
-  mpz_clear(sig->ell);
-  mpz_clear(sig->Aq);
-  mpz_clear(sig->Bq);
-  mpz_clear(sig->Cq);
-  mpz_clear(sig->Dq);
-  mpz_clear(sig->Eq);
-  mpz_clear(sig->z_w);
-  mpz_clear(sig->z_w2);
-  mpz_clear(sig->z_s1);
-  mpz_clear(sig->z_a);
-  mpz_clear(sig->z_an);
-  mpz_clear(sig->z_s1w);
-  mpz_clear(sig->z_sa);
-  mpz_clear(sig->z_s2);
-}
+    for (j = 0; j < GOO_SMALL_LIMBS; j++)
+      goo_mac(c, tp[i + j], m, sm->n[j], tp[i + j], c);
 
-static size_t
-goo_sig_size(const goo_sig_t *sig, size_t bits) {
-  size_t GOO_MOD_BYTES = (bits + 7) / 8;
-  size_t len = 0;
+    tp[i] = c;
+  }
 
-  (void)sig;
+  c = 0;
 
-  len += GOO_MOD_BYTES; /* C2 */
-  len += GOO_MOD_BYTES; /* C3 */
-  len += 2; /* t */
-  len += GOO_CHAL_BYTES; /* chal */
-  len += GOO_ELL_BYTES; /* ell */
-  len += GOO_MOD_BYTES; /* Aq */
-  len += GOO_MOD_BYTES; /* Bq */
-  len += GOO_MOD_BYTES; /* Cq */
-  len += GOO_MOD_BYTES; /* Dq */
-  len += GOO_EXP_BYTES; /* Eq */
-  len += GOO_ELL_BYTES * 8; /* z' */
-  len += 1; /* Eq sign */
+  for (i = 0; i < GOO_SMALL_LIMBS; i++) {
+    w = (goo_dlimb_t)tp[GOO_SMALL_LIMBS + i] + tp[i] + c;
+    rp[i] = (mp_limb_t)w;
+    c = (mp_limb_t)(w >> GOO_LIMB_WIDTH);
+  }
 
-  return len;
+  /* sp = rp - n */
+  b = 0;
+
+  for (i = 0; i < GOO_SMALL_LIMBS; i++) {
+    w = (goo_dlimb_t)rp[i] - sm->n[i] - b;
+    sp[i] = (mp_limb_t)w;
+    b = (mp_limb_t)(w >> GOO_LIMB_WIDTH) & 1;
+  }
+
+  if (c != 0 || b == 0) {
+    for (i = 0; i < GOO_SMALL_LIMBS; i++)
+      rp[i] = sp[i];
+  }
 }
 
-#define goo_write_int(n, size) do {     \
-  size_t bytes = goo_mpz_bytelen((n));  \
-  size_t pad;                           \
-                                        \
-  if (bytes > (size))                   \
-    return 0;                           \
-                                        \
-  pad = (size) - bytes;                 \
-  memset(out + pos, 0x00, pad);         \
-  pos += pad;                           \
-                                        \
-  goo_mpz_export(out + pos, NULL, (n)); \
-  pos += bytes;                         \
-} while (0)
+static GOO_INLINE void
+goo_small_mul(const goo_small_t *sm,
+              mp_limb_t *rp,
+              const mp_limb_t *ap,
+              const mp_limb_t *bp) {
+  /* rp = ap * bp * R^-1 mod n */
+  mp_limb_t tp[GOO_SMALL_LIMBS * 2];
+  mp_limb_t c;
+  int i, j;
 
-static int
-goo_sig_export(unsigned char *out, const goo_sig_t *sig, size_t bits) {
-  size_t GOO_MOD_BYTES = (bits + 7) / 8;
-  size_t pos = 0;
+  for (i = 0; i < GOO_SMALL_LIMBS; i++)
+    tp[i] = 0;
 
-  goo_write_int(sig->C2, GOO_MOD_BYTES);
-  goo_write_int(sig->C3, GOO_MOD_BYTES);
-  goo_write_int(sig->t, 2);
+  for (i = 0; i < GOO_SMALL_LIMBS; i++) {
+    c = 0;
 
-  goo_write_int(sig->chal, GOO_CHAL_BYTES);
-  goo_write_int(sig->ell, GOO_ELL_BYTES);
+    for (j = 0; j < GOO_SMALL_LIMBS; j++)
+      goo_mac(c, tp[i + j], ap[i], bp[j], tp[i + j], c);
+
+    tp[i + GOO_SMALL_LIMBS] = c;
+  }
+
+  goo_small_reduce(sm, rp, tp);
+}
+
+static GOO_INLINE void
+goo_small_sqr(const goo_small_t *sm, mp_limb_t *rp, const mp_limb_t *ap) {
+  /* rp = ap^2 * R^-1 mod n (see goo_mont_sqr_fixed()) */
+  mp_limb_t tp[GOO_SMALL_LIMBS * 2];
+  mp_limb_t c, hi;
+  goo_dlimb_t w;
+  int i, j;
+
+  for (i = 0; i < GOO_SMALL_LIMBS * 2; i++)
+    tp[i] = 0;
+
+  /* Off-diagonal products. */
+  for (i = 0; i < GOO_SMALL_LIMBS - 1; i++) {
+    c = 0;
+
+    for (j = i + 1; j < GOO_SMALL_LIMBS; j++)
+      goo_mac(c, tp[i + j], ap[i], ap[j], tp[i + j], c);
+
+    tp[i + GOO_SMALL_LIMBS] = c;
+  }
+
+  /* Double them. */
+  c = 0;
+
+  for (i = 0; i < GOO_SMALL_LIMBS * 2; i++) {
+    hi = tp[i] >> (GOO_LIMB_WIDTH - 1);
+    tp[i] = (tp[i] << 1) | c;
+    c = hi;
+  }
+
+  /* Add the squares. */
+  c = 0;
+
+  for (i = 0; i < GOO_SMALL_LIMBS; i++) {
+    w = (goo_dlimb_t)ap[i] * ap[i] + tp[2 * i] + c;
+    tp[2 * i] = (mp_limb_t)w;
+    w = (goo_dlimb_t)tp[2 * i + 1] + (mp_limb_t)(w >> GOO_LIMB_WIDTH);
+    tp[2 * i + 1] = (mp_limb_t)w;
+    c = (mp_limb_t)(w >> GOO_LIMB_WIDTH);
+  }
+
+  goo_small_reduce(sm, rp, tp);
+}
+
+static void
+goo_small_init(goo_small_t *sm, const mpz_t n) {
+  /* Expects an odd n with 2 <= bitlen(n) <= 192. */
+  /* R is always 2^192 (n is zero-padded). */
+  mp_limb_t n0, inv;
+  size_t i, bits;
+
+  ASSERT(mpz_size(n) <= GOO_SMALL_LIMBS);
+
+  for (i = 0; i < GOO_SMALL_LIMBS; i++) {
+    sm->n[i] = mpz_getlimbn(n, i);
+    sm->one[i] = 0;
+  }
+
+  /* See goo_mont_init(). */
+  n0 = sm->n[0];
+  inv = n0;
+
+  for (bits = 3; bits < GOO_LIMB_WIDTH; bits *= 2)
+    inv *= 2 - n0 * inv;
+
+  sm->k = -inv;
+
+  /* Digits for goo_small_mod_ui(). */
+  for (i = 0; i < GOO_SMALL_BITS / 48; i++)
+    sm->parts[i] = 0;
+
+  for (i = 0; i < GOO_SMALL_BITS; i++) {
+    uint64_t bit = (sm->n[i / GOO_LIMB_WIDTH] >> (i % GOO_LIMB_WIDTH)) & 1;
+
+    sm->parts[i / 48] |= bit << (i % 48);
+  }
+
+  /* one = R mod n, r2 = R^2 mod n, by doubling. */
+  sm->one[0] = 1;
+
+  for (i = 0; i < GOO_SMALL_BITS; i++)
+    goo_small_add(sm, sm->one, sm->one, sm->one);
+
+  for (i = 0; i < GOO_SMALL_LIMBS; i++)
+    sm->r2[i] = sm->one[i];
+
+  for (i = 0; i < GOO_SMALL_BITS; i++)
+    goo_small_add(sm, sm->r2, sm->r2, sm->r2);
+}
+
+static void
+goo_small_set(const goo_small_t *sm, mp_limb_t *rp, const mpz_t x) {
+  /* rp = x * R mod n (x < n) */
+  mp_limb_t xp[GOO_SMALL_LIMBS];
+  mp_size_t i;
+
+  for (i = 0; i < GOO_SMALL_LIMBS; i++)
+    xp[i] = mpz_getlimbn(x, i);
+
+  goo_small_mul(sm, rp, xp, sm->r2);
+}
+
+static void
+goo_small_set_ui(const goo_small_t *sm, mp_limb_t *rp, unsigned long x) {
+  /* rp = x * R mod n (x < n) */
+  mp_limb_t xp[GOO_SMALL_LIMBS];
+  mp_size_t i;
+
+  xp[0] = x;
+
+  for (i = 1; i < GOO_SMALL_LIMBS; i++)
+    xp[i] = 0;
+
+  goo_small_mul(sm, rp, xp, sm->r2);
+}
+
+static void
+goo_small_pow(const goo_small_t *sm,
+              mp_limb_t *rp,
+              const mp_limb_t *xp,
+              const mp_limb_t *ep,
+              size_t bits) {
+  /* rp = xp^ep (sliding window, odd powers) */
+  mp_limb_t wnd[8][GOO_SMALL_LIMBS];
+  mp_limb_t tp[GOO_SMALL_LIMBS];
+  long i = (long)bits - 1;
+  int j;
+
+#define goo_small_bit(k) \
+  ((ep[(k) / GOO_LIMB_WIDTH] >> ((k) % GOO_LIMB_WIDTH)) & 1)
+
+  /* wnd[j] = xp^(2 * j + 1) */
+  goo_small_sqr(sm, tp, xp);
+
+  for (j = 0; j < GOO_SMALL_LIMBS; j++)
+    wnd[0][j] = xp[j];
+
+  for (j = 1; j < 8; j++)
+    goo_small_mul(sm, wnd[j], wnd[j - 1], tp);
+
+  for (j = 0; j < GOO_SMALL_LIMBS; j++)
+    tp[j] = sm->one[j];
+
+  while (i >= 0 && !goo_small_bit(i))
+    i -= 1;
+
+  while (i >= 0) {
+    long k, m;
+    size_t w = 0;
+
+    if (!goo_small_bit(i)) {
+      goo_small_sqr(sm, tp, tp);
+      i -= 1;
+      continue;
+    }
+
+    /* Longest window of at most 4 bits ending in a 1. */
+    k = i - 3;
+
+    if (k < 0)
+      k = 0;
+
+    while (!goo_small_bit(k))
+      k += 1;
+
+    for (m = i; m >= k; m--) {
+      goo_small_sqr(sm, tp, tp);
+      w = (w << 1) | goo_small_bit(m);
+    }
+
+    goo_small_mul(sm, tp, tp, wnd[w >> 1]);
+
+    i = k - 1;
+  }
+
+#undef goo_small_bit
+
+  for (j = 0; j < GOO_SMALL_LIMBS; j++)
+    rp[j] = tp[j];
+}
+
+static unsigned long
+goo_small_mod_ui(const goo_small_t *sm, unsigned long d) {
+  /* n mod d for d < 2^16: with 48 bit digits, */
+  /* every division is a native 64 bit one. */
+  uint64_t r = 0;
+  int i;
+
+  ASSERT(d != 0 && d < 0x10000);
+
+  for (i = GOO_SMALL_BITS / 48 - 1; i >= 0; i--)
+    r = ((r << 48) | sm->parts[i]) % d;
+
+  return (unsigned long)r;
+}
+
+static int
+goo_small_jacobi(const goo_small_t *sm, unsigned long d) {
+  /* jacobi(d, n) for d > 0. */
+  unsigned long a;
+  unsigned long n8 = sm->n[0] & 7;
+  int j = 1;
+
+  /* Pull out the factors of two (d = 2^s * a). */
+  a = d;
+
+  while ((a & 1) == 0) {
+    a >>= 1;
+
+    if (n8 == 3 || n8 == 5)
+      j = -j;
+  }
+
+  /* Reciprocity, then all single-word. */
+  if ((a & 3) == 3 && (n8 & 3) == 3)
+    j = -j;
+
+  return j * goo_jacobi_ui(goo_small_mod_ui(sm, a), a);
+}
+
+static int
+goo_small_is_prime_mr(const goo_small_t *sm,
+                      const mpz_t n,
+                      const unsigned char *key,
+                      unsigned long reps,
+                      int force2) {
+  /* Same as goo_is_prime_mr(), bases included. */
+  mp_limb_t q[GOO_SMALL_LIMBS];
+  mp_limb_t mone[GOO_SMALL_LIMBS];
+  mp_limb_t x[GOO_SMALL_LIMBS];
+  mp_limb_t y[GOO_SMALL_LIMBS];
+  unsigned long k, i, j;
+  size_t bits, b;
+  goo_prng_t prng;
+  mpz_t nm3, z;
+  int r = 0;
+  mp_size_t l;
+
+  mpz_init(nm3);
+  mpz_init(z);
+
+  /* nm3 = n - 3 */
+  mpz_sub_ui(nm3, n, 3);
+
+  /* k = (n - 1) factors of 2 (n is odd) */
+  k = 1;
+
+  while (((sm->n[k / GOO_LIMB_WIDTH] >> (k % GOO_LIMB_WIDTH)) & 1) == 0)
+    k += 1;
+
+  /* q = (n - 1) >> k */
+  bits = (size_t)GOO_SMALL_LIMBS * GOO_LIMB_WIDTH;
+
+  for (l = 0; l < GOO_SMALL_LIMBS; l++)
+    q[l] = 0;
+
+  for (b = k; b < bits; b++) {
+    mp_limb_t bit = (sm->n[b / GOO_LIMB_WIDTH] >> (b % GOO_LIMB_WIDTH)) & 1;
+
+    q[(b - k) / GOO_LIMB_WIDTH] |= bit << ((b - k) % GOO_LIMB_WIDTH);
+  }
+
+  /* mone = n - 1 */
+  goo_small_sub(sm, mone, sm->n, sm->one);
+
+  /* Setup PRNG. */
+  goo_prng_init(&prng);
+  goo_prng_seed(&prng, key, &GOO_PRNG_PRIMALITY);
+
+  for (i = 0; i < reps; i++) {
+    if (i == reps - 1 && force2) {
+      /* x = 2 */
+      goo_small_add(sm, x, sm->one, sm->one);
+    } else {
+      /* x = random integer in [2,n-1] */
+      goo_prng_random_int(&prng, z, nm3);
+      mpz_add_ui(z, z, 2);
+      goo_small_set(sm, x, z);
+    }
+
+    /* y = x^q mod n */
+    goo_small_pow(sm, y, x, q, bits - k);
+
+    /* if y == 1 or y == -1 mod n */
+    if (goo_small_eq(y, sm->one) || goo_small_eq(y, mone))
+      continue;
+
+    for (j = 1; j < k; j++) {
+      /* y = y^2 mod n */
+      goo_small_mul(sm, y, y, y);
+
+      /* if y == -1 mod n */
+      if (goo_small_eq(y, mone))
+        goto next;
+
+      /* if y == 1 mod n */
+      if (goo_small_eq(y, sm->one))
+        goto fail;
+    }
+
+    goto fail;
+next:
+    ;
+  }
+
+  r = 1;
+fail:
+  mpz_clear(nm3);
+  mpz_clear(z);
+  goo_prng_uninit(&prng);
+  return r;
+}
+
+static int
+goo_small_is_prime_lucas(const goo_small_t *sm,
+                         const mpz_t n,
+                         unsigned long limit) {
+  /* Same as goo_is_prime_lucas() for odd n > 1. */
+  mp_limb_t s[GOO_SMALL_LIMBS + 1];
+  mp_limb_t mp[GOO_SMALL_LIMBS];
+  mp_limb_t two[GOO_SMALL_LIMBS];
+  mp_limb_t nm2[GOO_SMALL_LIMBS];
+  mp_limb_t vk[GOO_SMALL_LIMBS];
+  mp_limb_t vk1[GOO_SMALL_LIMBS];
+  mp_limb_t t1[GOO_SMALL_LIMBS];
+  mp_limb_t t2[GOO_SMALL_LIMBS];
+  unsigned long p, r;
+  goo_dlimb_t w;
+  mp_limb_t c;
+  long i, t;
+  int j;
+
+  /* p = 3 */
+  p = 3;
+
+  for (;;) {
+    if (p > 10000) {
+      /* Thought to be impossible. */
+      return 0;
+    }
+
+    if (limit != 0 && p > limit) {
+      /* Enforce a limit to prevent DoS'ing. */
+      return 0;
+    }
+
+    /* d = p * p - 4 */
+    j = goo_small_jacobi(sm, p * p - 4);
+
+    /* if d is not square mod n */
+    if (j == -1)
+      break;
+
+    /* if d == 0 mod n */
+    if (j == 0) {
+      /* if n == p + 2 */
+      return mpz_cmp_ui(n, p + 2) == 0;
+    }
+
+    if (p == 40) {
+      /* if floor(n^(1 / 2))^2 == n */
+      if (mpz_perfect_square_p(n))
+        return 0;
+    }
+
+    p += 1;
+  }
+
+  /* s = n + 1 */
+  c = 1;
+
+  for (i = 0; i < GOO_SMALL_LIMBS; i++) {
+    w = (goo_dlimb_t)sm->n[i] + c;
+    s[i] = (mp_limb_t)w;
+    c = (mp_limb_t)(w >> GOO_LIMB_WIDTH);
+  }
+
+  s[GOO_SMALL_LIMBS] = c;
+
+  /* r = s factors of 2 */
+  r = 1;
+
+  while (((s[r / GOO_LIMB_WIDTH] >> (r % GOO_LIMB_WIDTH)) & 1) == 0)
+    r += 1;
+
+  /* two = 2, mp = p, nm2 = n - 2 (Montgomery form) */
+  goo_small_add(sm, two, sm->one, sm->one);
+  goo_small_set_ui(sm, mp, p);
+  goo_small_sub(sm, nm2, sm->n, two);
+
+  /* vk = 2 */
+  /* vk1 = p */
+  for (i = 0; i < GOO_SMALL_LIMBS; i++) {
+    vk[i] = two[i];
+    vk1[i] = mp[i];
+  }
+
+  /* s >>= r, i = bitlen(s) */
+  i = (long)(GOO_SMALL_LIMBS + 1) * GOO_LIMB_WIDTH - 1;
+
+  while (i >= (long)r
+         && ((s[i / GOO_LIMB_WIDTH] >> (i % GOO_LIMB_WIDTH)) & 1) == 0) {
+    i -= 1;
+  }
+
+  i = i + 1 - (long)r;
+
+  for (; i >= 0; i--) {
+    unsigned long bit = (unsigned long)i + r;
+
+    /* if floor(s / 2^i) mod 2 == 1 */
+    if ((s[bit / GOO_LIMB_WIDTH] >> (bit % GOO_LIMB_WIDTH)) & 1) {
+      /* vk = (vk * vk1 + n - p) mod n */
+      /* vk1 = (vk1^2 + nm2) mod n */
+      goo_small_mul(sm, t1, vk, vk1);
+      goo_small_sub(sm, vk, t1, mp);
+      goo_small_mul(sm, t1, vk1, vk1);
+      goo_small_sub(sm, vk1, t1, two);
+    } else {
+      /* vk1 = (vk * vk1 + n - p) mod n */
+      /* vk = (vk^2 + nm2) mod n */
+      goo_small_mul(sm, t1, vk, vk1);
+      goo_small_sub(sm, vk1, t1, mp);
+      goo_small_mul(sm, t1, vk, vk);
+      goo_small_sub(sm, vk, t1, two);
+    }
+  }
+
+  /* if vk == 2 or vk == nm2 */
+  if (goo_small_eq(vk, two) || goo_small_eq(vk, nm2)) {
+    /* t3 = abs(vk * p - vk1 * 2) mod n */
+    goo_small_mul(sm, t1, vk, mp);
+    goo_small_add(sm, t2, vk1, vk1);
+
+    /* if t3 == 0 */
+    if (goo_small_eq(t1, t2))
+      return 1;
+  }
+
+  for (t = 0; t < (long)r - 1; t++) {
+    /* if vk == 0 */
+    if (goo_small_zero(vk))
+      return 1;
+
+    /* if vk == 2 */
+    if (goo_small_eq(vk, two))
+      return 0;
+
+    /* vk = (vk^2 - 2) mod n */
+    goo_small_mul(sm, t1, vk, vk);
+    goo_small_sub(sm, vk, t1, two);
+  }
+
+  return 0;
+}
+
+static int
+goo_small_is_prime(const mpz_t p, const unsigned char *key) {
+  /* goo_is_prime() for p <= 2^192 - 1. */
+  goo_small_t sm;
+  int ret = goo_is_prime_div(p);
+
+  if (ret != -1)
+    return ret;
+
+  goo_small_init(&sm, p);
+
+  if (!goo_small_is_prime_mr(&sm, p, key, 16 + 1, 1))
+    return 0;
+
+  if (!goo_small_is_prime_lucas(&sm, p, 50))
+    return 0;
+
+  return 1;
+}
+
+#endif /* GOO_HAS_DLIMB */
+
+static int
+goo_is_prime(const mpz_t p, const unsigned char *key) {
+  int ret;
+
+#ifdef GOO_HAS_DLIMB
+  if (goo_mpz_bitlen(p) <= GOO_SMALL_BITS)
+    return goo_small_is_prime(p, key);
+#endif
+
+  ret = goo_is_prime_div(p);
+
+  if (ret != -1)
+    return ret;
+
+  if (!goo_is_prime_mr(p, key, 16 + 1, 1))
+    return 0;
+
+  if (!goo_is_prime_lucas(p, 50))
+    return 0;
+
+  return 1;
+}
+
+static int
+goo_is_prime_bpsw(const mpz_t p, const unsigned char *key) {
+  /* goo_is_prime() for p free of goo_test_primes factors. */
+#ifdef GOO_HAS_DLIMB
+  if (goo_mpz_bitlen(p) <= GOO_SMALL_BITS) {
+    goo_small_t sm;
+
+    goo_small_init(&sm, p);
+
+    if (!goo_small_is_prime_mr(&sm, p, key, 16 + 1, 1))
+      return 0;
+
+    return goo_small_is_prime_lucas(&sm, p, 50);
+  }
+#endif
+
+  if (!goo_is_prime_mr(p, key, 16 + 1, 1))
+    return 0;
+
+  return goo_is_prime_lucas(p, 50);
+}
+
+static int
+goo_next_prime(mpz_t ret,
+               const mpz_t p,
+               const unsigned char *key,
+               unsigned long max) {
+  /* Find the first prime in [p, p + max] (no bound if max == 0).
+   *
+   * Past the trial division primes, the odd candidates are
+   * sieved a segment at a time: each prime's residue is taken
+   * once and its multiples are struck from the whole segment.
+   * Only the survivors are handed to Miller-Rabin and Lucas,
+   * which yields the same first prime as goo_is_prime() on
+   * every candidate in turn.
+   */
+  unsigned char sieve[GOO_SIEVE_SIZE];
+  unsigned long inc = 0;
+  unsigned long q, r, pos;
+  size_t i, j, len;
+
+  mpz_set(ret, p);
+
+  if (mpz_even_p(ret)) {
+    mpz_add_ui(ret, ret, 1);
+    inc += 1;
+  }
+
+  /* Candidates which may be in the prime table itself. */
+  while (mpz_cmp_ui(ret, goo_test_primes[GOO_TEST_PRIMES_LEN - 1]) <= 0) {
+    if (max != 0 && inc > max)
+      return 0;
+
+    if (goo_is_prime(ret, key))
+      return 1;
+
+    mpz_add_ui(ret, ret, 2);
+    inc += 2;
+  }
+
+  for (;;) {
+    if (max != 0 && inc > max)
+      return 0;
+
+    len = GOO_SIEVE_SIZE;
+
+    if (max != 0 && (max - inc) / 2 + 1 < len)
+      len = (max - inc) / 2 + 1;
+
+    memset(sieve, 0, len);
+
+    /* Skip two; every candidate is odd. */
+    for (i = 1; i < GOO_TEST_PRIMES_LEN; i++) {
+      q = goo_test_primes[i];
+      r = mpz_fdiv_ui(ret, q);
+
+      /* ret + 2 * j == 0 mod q, i.e. j == -r / 2 mod q */
+      j = ((q - r) % q) * ((q + 1) >> 1) % q;
+
+      for (; j < len; j += q)
+        sieve[j] = 1;
+    }
+
+    pos = 0;
+
+    for (i = 0; i < len; i++) {
+      if (sieve[i])
+        continue;
+
+      mpz_add_ui(ret, ret, (i - pos) * 2);
+      inc += (i - pos) * 2;
+      pos = i;
+
+      if (goo_is_prime_bpsw(ret, key))
+        return 1;
+    }
+
+    mpz_add_ui(ret, ret, (len - pos) * 2);
+    inc += (len - pos) * 2;
+  }
+}
+
+/*
+ * Signature
+ */
+
+static void
+goo_sig_init(goo_sig_t *sig) {
+  mpz_init(sig->C2);
+  mpz_init(sig->C3);
+  mpz_init(sig->t);
+  mpz_init(sig->chal);
+  mpz_init(sig->ell);
+  mpz_init(sig->Aq);
+  mpz_init(sig->Bq);
+  mpz_init(sig->Cq);
+  mpz_init(sig->Dq);
+  mpz_init(sig->Eq);
+  mpz_init(sig->z_w);
+  mpz_init(sig->z_w2);
+  mpz_init(sig->z_s1);
+  mpz_init(sig->z_a);
+  mpz_init(sig->z_an);
+  mpz_init(sig->z_s1w);
+  mpz_init(sig->z_sa);
+  mpz_init(sig->z_s2);
+}
+
+static void
+goo_sig_uninit(goo_sig_t *sig) {
+  mpz_clear(sig->C2);
+  mpz_clear(sig->C3);
+  mpz_clear(sig->t);
+  mpz_clear(sig->chal);
+  mpz_clear(sig->ell);
+  mpz_clear(sig->Aq);
+  mpz_clear(sig->Bq);
+  mpz_clear(sig->Cq);
+  mpz_clear(sig->Dq);
+  mpz_clear(sig->Eq);
+  mpz_clear(sig->z_w);
+  mpz_clear(sig->z_w2);
+  mpz_clear(sig->z_s1);
+  mpz_clear(sig->z_a);
+  mpz_clear(sig->z_an);
+  mpz_clear(sig->z_s1w);
+  mpz_clear(sig->z_sa);
+  mpz_clear(sig->z_s2);
+}
+
+static size_t
+goo_sig_size(const goo_sig_t *sig, size_t bits) {
+  size_t GOO_MOD_BYTES = (bits + 7) / 8;
+  size_t len = 0;
+
+  (void)sig;
+
+  len += GOO_MOD_BYTES; /* C2 */
+  len += GOO_MOD_BYTES; /* C3 */
+  len += 2; /* t */
+  len += GOO_CHAL_BYTES; /* chal */
+  len += GOO_ELL_BYTES; /* ell */
+  len += GOO_MOD_BYTES; /* Aq */
+  len += GOO_MOD_BYTES; /* Bq */
+  len += GOO_MOD_BYTES; /* Cq */
+  len += GOO_MOD_BYTES; /* Dq */
+  len += GOO_EXP_BYTES; /* Eq */
+  len += GOO_ELL_BYTES * 8; /* z' */
+  len += 1; /* Eq sign */
+
+  return len;
+}
+
+#define goo_write_int(n, size) do {     \
+  size_t bytes = goo_mpz_bytelen((n));  \
+  size_t pad;                           \
+                                        \
+  if (bytes > (size))                   \
+    return 0;                           \
+                                        \
+  pad = (size) - bytes;                 \
+  memset(out + pos, 0x00, pad);         \
+  pos += pad;                           \
+                                        \
+  goo_mpz_export(out + pos, NULL, (n)); \
+  pos += bytes;                         \
+} while (0)
+
+static int
+goo_sig_export(unsigned char *out, const goo_sig_t *sig, size_t bits) {
+  size_t GOO_MOD_BYTES = (bits + 7) / 8;
+  size_t pos = 0;
+
+  goo_write_int(sig->C2, GOO_MOD_BYTES);
+  goo_write_int(sig->C3, GOO_MOD_BYTES);
+  goo_write_int(sig->t, 2);
+
+  goo_write_int(sig->chal, GOO_CHAL_BYTES);
+  goo_write_int(sig->ell, GOO_ELL_BYTES);
   goo_write_int(sig->Aq, GOO_MOD_BYTES);
   goo_write_int(sig->Bq, GOO_MOD_BYTES);
   goo_write_int(sig->Cq, GOO_MOD_BYTES);
   goo_write_int(sig->Dq, GOO_MOD_BYTES);
   goo_write_int(sig->Eq, GOO_EXP_BYTES);
 
-  goo_write_int(sig->z_w, GOO_ELL_BYTES);
-  goo_write_int(sig->z_w2, GOO_ELL_BYTES);
-  goo_write_int(sig->z_s1, GOO_ELL_BYTES);
-  goo_write_int(sig->z_a, GOO_ELL_BYTES);
-  goo_write_int(sig->z_an, GOO_ELL_BYTES);
-  goo_write_int(sig->z_s1w, GOO_ELL_BYTES);
-  goo_write_int(sig->z_sa, GOO_ELL_BYTES);
-  goo_write_int(sig->z_s2, GOO_ELL_BYTES);
+  goo_write_int(sig->z_w, GOO_ELL_BYTES);
+  goo_write_int(sig->z_w2, GOO_ELL_BYTES);
+  goo_write_int(sig->z_s1, GOO_ELL_BYTES);
+  goo_write_int(sig->z_a, GOO_ELL_BYTES);
+  goo_write_int(sig->z_an, GOO_ELL_BYTES);
+  goo_write_int(sig->z_s1w, GOO_ELL_BYTES);
+  goo_write_int(sig->z_sa, GOO_ELL_BYTES);
+  goo_write_int(sig->z_s2, GOO_ELL_BYTES);
+
+  out[pos++] = mpz_sgn(sig->Eq) < 0 ? 1 : 0;
+
+  ASSERT(goo_sig_size(sig, bits) == pos);
+
+  return 1;
+}
+
+#undef goo_write_int
+
+#define goo_read_int(n, size) do {         \
+  goo_mpz_import((n), data + pos, (size)); \
+  pos += (size);                           \
+} while (0)                                \
+
+static int
+goo_sig_import(goo_sig_t *sig,
+               const unsigned char *data,
+               size_t data_len,
+               size_t bits) {
+  size_t GOO_MOD_BYTES = (bits + 7) / 8;
+  size_t pos = 0;
+  unsigned char sign;
+
+  if (data_len != goo_sig_size(sig, bits)) {
+    /* Invalid signature size. */
+    return 0;
+  }
+
+  goo_read_int(sig->C2, GOO_MOD_BYTES);
+  goo_read_int(sig->C3, GOO_MOD_BYTES);
+  goo_read_int(sig->t, 2);
+
+  goo_read_int(sig->chal, GOO_CHAL_BYTES);
+  goo_read_int(sig->ell, GOO_ELL_BYTES);
+  goo_read_int(sig->Aq, GOO_MOD_BYTES);
+  goo_read_int(sig->Bq, GOO_MOD_BYTES);
+  goo_read_int(sig->Cq, GOO_MOD_BYTES);
+  goo_read_int(sig->Dq, GOO_MOD_BYTES);
+  goo_read_int(sig->Eq, GOO_EXP_BYTES);
+
+  goo_read_int(sig->z_w, GOO_ELL_BYTES);
+  goo_read_int(sig->z_w2, GOO_ELL_BYTES);
+  goo_read_int(sig->z_s1, GOO_ELL_BYTES);
+  goo_read_int(sig->z_a, GOO_ELL_BYTES);
+  goo_read_int(sig->z_an, GOO_ELL_BYTES);
+  goo_read_int(sig->z_s1w, GOO_ELL_BYTES);
+  goo_read_int(sig->z_sa, GOO_ELL_BYTES);
+  goo_read_int(sig->z_s2, GOO_ELL_BYTES);
+
+  sign = data[pos++];
+
+  ASSERT(pos == data_len);
+
+  if (sign > 1) {
+    /* Non-minimal serialization. */
+    return 0;
+  }
+
+  if (sign)
+    mpz_neg(sig->Eq, sig->Eq);
+
+  return 1;
+}
+
+#undef goo_read_int
+
+/*
+ * CombSpec
+ */
+
+static size_t
+combspec_size(unsigned long bits) {
+  unsigned long max = 0;
+  unsigned long ppa;
+
+  for (ppa = 2; ppa < 18; ppa++) {
+    unsigned long bpw = (bits + ppa - 1) / ppa;
+    unsigned long sqrt = goo_isqrt(bpw);
+    unsigned long aps;
+
+    for (aps = 1; aps < sqrt + 2; aps++) {
+      unsigned long shifts, ops1, ops2, ops;
+
+      if (bpw % aps != 0)
+        continue;
+
+      shifts = bpw / aps;
+
+      ASSERT(shifts != 0);
+      ASSERT(aps != 0);
+
+      ops1 = shifts * (aps + 1) - 1;
+      ops2 = aps * (shifts + 1) - 1;
+      ops = ops1 > ops2 ? ops1 : ops2;
+
+      if (ops > max)
+        max = ops;
+    }
+  }
+
+  return max + 1;
+}
+
+static void
+combspec_generate(goo_combspec_t **specs,
+                  size_t specs_len,
+                  unsigned long shifts,
+                  unsigned long aps,
+                  unsigned long ppa,
+                  unsigned long bps) {
+  unsigned long ops = shifts * (aps + 1) - 1;
+  unsigned long size = ((1 << ppa) - 1) * aps;
+  goo_combspec_t *best;
+
+  ASSERT((size_t)ops < specs_len);
+
+  if (specs[ops] == NULL) {
+    specs[ops] = goo_malloc(sizeof(goo_combspec_t));
+    specs[ops]->size = ULONG_MAX;
+  }
+
+  best = specs[ops];
+
+  if (best->size > size) {
+    best->points_per_add = ppa;
+    best->adds_per_shift = aps;
+    best->shifts = shifts;
+    best->bits_per_window = bps;
+    best->size = size;
+  }
+}
+
+static int
+goo_combspec_init(goo_combspec_t *out,
+                  unsigned long bits,
+                  unsigned long max_size) {
+  int r = 0;
+  size_t specs_len, i;
+  goo_combspec_t **specs, *ret;
+  unsigned long ppa, sm;
+
+  if (bits == 0 || max_size == 0)
+    return 0;
+
+  /* We don't have a hash table, so this allocates up to ~70kb. */
+  specs_len = combspec_size(bits);
+  specs = goo_calloc(specs_len, sizeof(goo_combspec_t *));
+
+  for (ppa = 2; ppa < 18; ppa++) {
+    unsigned long bpw = (bits + ppa - 1) / ppa;
+    unsigned long sqrt = goo_isqrt(bpw);
+    unsigned long aps;
+
+    for (aps = 1; aps < sqrt + 2; aps++) {
+      unsigned long shifts;
+
+      if (bpw % aps != 0)
+        continue;
+
+      shifts = bpw / aps;
+
+      ASSERT(shifts != 0);
+      ASSERT(aps != 0);
+
+      combspec_generate(specs, specs_len, shifts, aps, ppa, bpw);
+      combspec_generate(specs, specs_len, aps, shifts, ppa, bpw);
+    }
+  }
+
+  sm = ULONG_MAX;
+  ret = NULL;
+
+  for (i = 0; i < specs_len; i++) {
+    goo_combspec_t *spec = specs[i];
+
+    if (spec == NULL)
+      continue;
+
+    if (sm <= spec->size)
+      continue;
+
+    sm = spec->size;
+
+    if (sm <= max_size) {
+      ret = spec;
+      break;
+    }
+  }
+
+  if (ret == NULL)
+    goto fail;
 
-  out[pos++] = mpz_sgn(sig->Eq) < 0 ? 1 : 0;
+  memcpy(out, ret, sizeof(goo_combspec_t));
 
-  ASSERT(goo_sig_size(sig, bits) == pos);
+  r = 1;
+fail:
+  for (i = 0; i < specs_len; i++)
+    goo_free(specs[i]);
 
-  return 1;
+  goo_free(specs);
+
+  return r;
 }
 
-#undef goo_write_int
+/*
+ * Montgomery
+ */
 
-#define goo_read_int(n, size) do {         \
-  goo_mpz_import((n), data + pos, (size)); \
-  pos += (size);                           \
-} while (0)                                \
+static void
+goo_mpn_import(mp_limb_t *out, mp_size_t limbs, const mpz_t x) {
+  /* Zero-padded copy of |x|. */
+  mp_size_t size = (mp_size_t)mpz_size(x);
 
-static int
-goo_sig_import(goo_sig_t *sig,
-               const unsigned char *data,
-               size_t data_len,
-               size_t bits) {
-  size_t GOO_MOD_BYTES = (bits + 7) / 8;
-  size_t pos = 0;
-  unsigned char sign;
+  ASSERT(size <= limbs);
 
-  if (data_len != goo_sig_size(sig, bits)) {
-    /* Invalid signature size. */
-    return 0;
+  if (size > 0)
+    mpn_copyi(out, mpz_limbs_read(x), size);
+
+  if (limbs > size)
+    mpn_zero(out + size, limbs - size);
+}
+
+static void
+goo_mpn_export(mpz_t out, const mp_limb_t *xp, mp_size_t limbs) {
+  mpn_copyi(mpz_limbs_write(out, limbs), xp, limbs);
+  mpz_limbs_finish(out, limbs);
+}
+
+static void
+goo_mont_reduce(const goo_mont_t *mont, mp_limb_t *rp, mp_limb_t *tp) {
+  /* rp = tp * R^-1 mod n (REDC)
+   *
+   * `tp` has 2 * limbs limbs and is clobbered.
+   * Each round zeroes the low limb of `tp`; we
+   * stash the carry there and add all of them
+   * in at the end, as GMP's redc_1 does.
+   */
+  mp_size_t limbs = mont->limbs;
+  mp_size_t i;
+  mp_limb_t c;
+
+  for (i = 0; i < limbs; i++)
+    tp[i] = mpn_addmul_1(tp + i, mont->n, limbs, tp[i] * mont->k);
+
+  c = mpn_add_n(rp, tp + limbs, tp, limbs);
+
+  if (c != 0 || mpn_cmp(rp, mont->n, limbs) >= 0)
+    mpn_sub_n(rp, rp, mont->n, limbs);
+}
+
+static void
+goo_mont_mul_generic(const goo_mont_t *mont,
+                     mp_limb_t *rp,
+                     const mp_limb_t *ap,
+                     const mp_limb_t *bp) {
+  /* rp = ap * bp * R^-1 mod n */
+  mp_limb_t tp[GOO_MAX_LIMBS * 2];
+
+  mpn_mul_n(tp, ap, bp, mont->limbs);
+
+  goo_mont_reduce(mont, rp, tp);
+}
+
+static void
+goo_mont_sqr_generic(const goo_mont_t *mont,
+                     mp_limb_t *rp,
+                     const mp_limb_t *ap) {
+  /* rp = ap^2 * R^-1 mod n */
+  mp_limb_t tp[GOO_MAX_LIMBS * 2];
+
+  mpn_sqr(tp, ap, mont->limbs);
+
+  goo_mont_reduce(mont, rp, tp);
+}
+
+/*
+ * Fixed-Width Montgomery
+ *
+ * Every built-in modulus is exactly 2048 or 4096
+ * bits. For those sizes we avoid the mpn layer
+ * entirely (mini-gmp in particular multiplies with
+ * four half-limb products) and use kernels whose
+ * limb count is a compile-time constant, which the
+ * compiler is free to unroll.
+ */
+
+#ifdef GOO_HAS_DLIMB
+
+static GOO_INLINE void
+goo_mont_reduce_fixed(const goo_mont_t *mont,
+                      mp_limb_t *rp,
+                      mp_limb_t *tp,
+                      mp_size_t limbs) {
+  /* Same carry trick as goo_mont_reduce(). */
+  const mp_limb_t *np = mont->n;
+  mp_limb_t sp[GOO_MAX_LIMBS];
+  mp_limb_t m, c, b;
+  goo_dlimb_t w;
+  mp_size_t i, j;
+
+  for (i = 0; i < limbs; i++) {
+    m = tp[i] * mont->k;
+    c = 0;
+
+    for (j = 0; j < limbs; j++)
+      goo_mac(c, tp[i + j], m, np[j], tp[i + j], c);
+
+    tp[i] = c;
   }
 
-  goo_read_int(sig->C2, GOO_MOD_BYTES);
-  goo_read_int(sig->C3, GOO_MOD_BYTES);
-  goo_read_int(sig->t, 2);
+  c = 0;
 
-  goo_read_int(sig->chal, GOO_CHAL_BYTES);
-  goo_read_int(sig->ell, GOO_ELL_BYTES);
-  goo_read_int(sig->Aq, GOO_MOD_BYTES);
-  goo_read_int(sig->Bq, GOO_MOD_BYTES);
-  goo_read_int(sig->Cq, GOO_MOD_BYTES);
-  goo_read_int(sig->Dq, GOO_MOD_BYTES);
-  goo_read_int(sig->Eq, GOO_EXP_BYTES);
+  for (i = 0; i < limbs; i++) {
+    w = (goo_dlimb_t)tp[limbs + i] + tp[i] + c;
+    rp[i] = (mp_limb_t)w;
+    c = (mp_limb_t)(w >> GOO_LIMB_WIDTH);
+  }
 
-  goo_read_int(sig->z_w, GOO_ELL_BYTES);
-  goo_read_int(sig->z_w2, GOO_ELL_BYTES);
-  goo_read_int(sig->z_s1, GOO_ELL_BYTES);
-  goo_read_int(sig->z_a, GOO_ELL_BYTES);
-  goo_read_int(sig->z_an, GOO_ELL_BYTES);
-  goo_read_int(sig->z_s1w, GOO_ELL_BYTES);
-  goo_read_int(sig->z_sa, GOO_ELL_BYTES);
-  goo_read_int(sig->z_s2, GOO_ELL_BYTES);
+  /* sp = rp - n */
+  b = 0;
 
-  sign = data[pos++];
+  for (i = 0; i < limbs; i++) {
+    w = (goo_dlimb_t)rp[i] - np[i] - b;
+    sp[i] = (mp_limb_t)w;
+    b = (mp_limb_t)(w >> GOO_LIMB_WIDTH) & 1;
+  }
 
-  ASSERT(pos == data_len);
+  if (c != 0 || b == 0) {
+    for (i = 0; i < limbs; i++)
+      rp[i] = sp[i];
+  }
+}
 
-  if (sign > 1) {
-    /* Non-minimal serialization. */
-    return 0;
+static GOO_INLINE void
+goo_mont_mul_fixed(const goo_mont_t *mont,
+                   mp_limb_t *rp,
+                   const mp_limb_t *ap,
+                   const mp_limb_t *bp,
+                   mp_size_t limbs) {
+  mp_limb_t tp[GOO_MAX_LIMBS * 2];
+  mp_limb_t c;
+  mp_size_t i, j;
+
+  for (i = 0; i < limbs; i++)
+    tp[i] = 0;
+
+  for (i = 0; i < limbs; i++) {
+    c = 0;
+
+    for (j = 0; j < limbs; j++)
+      goo_mac(c, tp[i + j], ap[i], bp[j], tp[i + j], c);
+
+    tp[i + limbs] = c;
   }
 
-  if (sign)
-    mpz_neg(sig->Eq, sig->Eq);
+  goo_mont_reduce_fixed(mont, rp, tp, limbs);
+}
 
-  return 1;
+static GOO_INLINE void
+goo_mont_sqr_fixed(const goo_mont_t *mont,
+                   mp_limb_t *rp,
+                   const mp_limb_t *ap,
+                   mp_size_t limbs) {
+  mp_limb_t tp[GOO_MAX_LIMBS * 2];
+  mp_limb_t c, hi;
+  goo_dlimb_t w;
+  mp_size_t i, j;
+
+  for (i = 0; i < limbs * 2; i++)
+    tp[i] = 0;
+
+  /* Off-diagonal products. */
+  for (i = 0; i < limbs - 1; i++) {
+    c = 0;
+
+    for (j = i + 1; j < limbs; j++)
+      goo_mac(c, tp[i + j], ap[i], ap[j], tp[i + j], c);
+
+    tp[i + limbs] = c;
+  }
+
+  /* Double them. */
+  c = 0;
+
+  for (i = 0; i < limbs * 2; i++) {
+    hi = tp[i] >> (GOO_LIMB_WIDTH - 1);
+    tp[i] = (tp[i] << 1) | c;
+    c = hi;
+  }
+
+  /* Add the squares. */
+  c = 0;
+
+  for (i = 0; i < limbs; i++) {
+    w = (goo_dlimb_t)ap[i] * ap[i] + tp[2 * i] + c;
+    tp[2 * i] = (mp_limb_t)w;
+    w = (goo_dlimb_t)tp[2 * i + 1] + (mp_limb_t)(w >> GOO_LIMB_WIDTH);
+    tp[2 * i + 1] = (mp_limb_t)w;
+    c = (mp_limb_t)(w >> GOO_LIMB_WIDTH);
+  }
+
+  goo_mont_reduce_fixed(mont, rp, tp, limbs);
 }
 
-#undef goo_read_int
+static void
+goo_mont_mul_32(const goo_mont_t *mont,
+                mp_limb_t *rp,
+                const mp_limb_t *ap,
+                const mp_limb_t *bp) {
+  goo_mont_mul_fixed(mont, rp, ap, bp, 32);
+}
+
+static void
+goo_mont_sqr_32(const goo_mont_t *mont,
+                mp_limb_t *rp,
+                const mp_limb_t *ap) {
+  goo_mont_sqr_fixed(mont, rp, ap, 32);
+}
+
+static void
+goo_mont_mul_64(const goo_mont_t *mont,
+                mp_limb_t *rp,
+                const mp_limb_t *ap,
+                const mp_limb_t *bp) {
+  goo_mont_mul_fixed(mont, rp, ap, bp, 64);
+}
+
+static void
+goo_mont_sqr_64(const goo_mont_t *mont,
+                mp_limb_t *rp,
+                const mp_limb_t *ap) {
+  goo_mont_sqr_fixed(mont, rp, ap, 64);
+}
+
+#undef goo_mac
+#undef GOO_INLINE
+
+#endif /* GOO_HAS_DLIMB */
 
 /*
- * CombSpec
+ * Vector Montgomery
+ *
+ * Radix-2^52 (AVX-512 IFMA) and radix-2^26 (AVX2)
+ * kernels for 2048 and 4096 bit moduli. Elements
+ * stay in 64 bit limbs between calls; each kernel
+ * converts its operands on entry and exit, which
+ * is linear next to the quadratic multiply.
+ *
+ * Both use R = 2^(radix * digits), which differs
+ * from the limb kernels. goo_mont_init() derives
+ * `one` and `r2` from whichever R was picked.
  */
 
-static size_t
-combspec_size(unsigned long bits) {
-  unsigned long max = 0;
-  unsigned long ppa;
+#if defined(GOO_LIMB_WIDTH) && GOO_LIMB_WIDTH == 64 \
+  && defined(__GNUC__) && defined(__x86_64__)
+#define GOO_HAS_VECTOR
+#endif
+
+#ifdef GOO_HAS_VECTOR
+
+#if defined(__GNUC__)
+#define GOO_INLINE __inline__ __attribute__((always_inline))
+#endif
+
+static void
+goo_radix_encode(uint64_t *out,
+                 size_t digits,
+                 unsigned int radix,
+                 const mp_limb_t *xp,
+                 mp_size_t limbs) {
+  uint64_t mask = ((uint64_t)1 << radix) - 1;
+  size_t i;
+
+  for (i = 0; i < digits; i++) {
+    size_t pos = i * radix;
+    size_t w = pos >> 6;
+    unsigned int s = pos & 63;
+    uint64_t d = 0;
+
+    if (w < (size_t)limbs) {
+      d = xp[w] >> s;
+
+      if (s + radix > 64 && w + 1 < (size_t)limbs)
+        d |= xp[w + 1] << (64 - s);
+    }
+
+    out[i] = d & mask;
+  }
+}
+
+static void
+goo_radix_decode(mp_limb_t *rp,
+                 mp_size_t limbs,
+                 const uint64_t *xp,
+                 size_t digits,
+                 unsigned int radix) {
+  size_t i;
+
+  mpn_zero(rp, limbs);
+
+  for (i = 0; i < digits; i++) {
+    size_t pos = i * radix;
+    size_t w = pos >> 6;
+    unsigned int s = pos & 63;
+
+    if (w < (size_t)limbs) {
+      rp[w] |= xp[i] << s;
+
+      if (s + radix > 64 && w + 1 < (size_t)limbs)
+        rp[w + 1] |= xp[i] >> (64 - s);
+    }
+  }
+}
+
+static void
+goo_radix_finish(const goo_mont_t *mont,
+                 mp_limb_t *rp,
+                 uint64_t *tp,
+                 unsigned int radix) {
+  /* Propagate the lazy carries (tp < 2n), */
+  /* then subtract n if tp >= n. */
+  const uint64_t *np = mont->nd[0];
+  uint64_t mask = ((uint64_t)1 << radix) - 1;
+  uint64_t sp[GOO_MAX_DIGITS];
+  uint64_t c = 0;
+  size_t i;
+
+  for (i = 0; i < mont->digits; i++) {
+    tp[i] += c;
+    c = tp[i] >> radix;
+    tp[i] &= mask;
+  }
+
+  c = 0;
+
+  for (i = 0; i < mont->digits; i++) {
+    uint64_t d = tp[i] - np[i] - c;
+
+    c = d >> 63;
+    sp[i] = d & mask;
+  }
+
+  goo_radix_decode(rp, mont->limbs, c ? tp : sp, mont->digits, radix);
+}
+
+__attribute__((target("avx512f,avx512ifma")))
+static GOO_INLINE void
+goo_mont_mul_ifma(const goo_mont_t *mont,
+                  mp_limb_t *rp,
+                  const mp_limb_t *ap,
+                  const mp_limb_t *bp,
+                  size_t vecs) {
+  /* Word-by-word Montgomery in radix 2^52 (AMM).
+   *
+   * The accumulator lives in registers. After
+   * the low halves are added, digit 0 is zero
+   * mod 2^52, so we shift the accumulator down
+   * a lane and add the high halves in place.
+   * Lanes are left unnormalized: each round
+   * adds < 2^54, which leaves plenty of room
+   * for 80 rounds.
+   */
+  static const uint64_t M = ((uint64_t)1 << 52) - 1;
+  const uint64_t *np = mont->nd[0];
+  size_t digits = vecs * 8;
+  uint64_t a[GOO_MAX_DIGITS / 2];
+  uint64_t b[GOO_MAX_DIGITS / 2];
+  uint64_t t[GOO_MAX_DIGITS / 2];
+  __m512i A[GOO_MAX_DIGITS / 16];
+  __m512i N[GOO_MAX_DIGITS / 16];
+  __m512i X[GOO_MAX_DIGITS / 16];
+  __m512i zero = _mm512_setzero_si512();
+  size_t i, v;
+
+  goo_radix_encode(a, digits, 52, ap, mont->limbs);
+  goo_radix_encode(b, digits, 52, bp, mont->limbs);
+
+  for (v = 0; v < vecs; v++) {
+    A[v] = _mm512_loadu_si512((const void *)&a[v * 8]);
+    N[v] = _mm512_loadu_si512((const void *)&np[v * 8]);
+    X[v] = zero;
+  }
+
+  for (i = 0; i < digits; i++) {
+    uint64_t x0 = _mm_cvtsi128_si64(_mm512_castsi512_si128(X[0]));
+    uint64_t lo = (a[0] * b[i]) & M;
+    uint64_t m = ((x0 + lo) * mont->kd) & M;
+    uint64_t c = (x0 + lo + ((np[0] * m) & M)) >> 52;
+    __m512i bi = _mm512_set1_epi64(b[i]);
+    __m512i mi = _mm512_set1_epi64(m);
+
+    for (v = 0; v < vecs; v++) {
+      X[v] = _mm512_madd52lo_epu64(X[v], A[v], bi);
+      X[v] = _mm512_madd52lo_epu64(X[v], N[v], mi);
+    }
+
+    for (v = 0; v < vecs - 1; v++)
+      X[v] = _mm512_alignr_epi64(X[v + 1], X[v], 1);
+
+    X[vecs - 1] = _mm512_alignr_epi64(zero, X[vecs - 1], 1);
+    X[0] = _mm512_add_epi64(X[0], _mm512_maskz_set1_epi64(1, c));
+
+    for (v = 0; v < vecs; v++) {
+      X[v] = _mm512_madd52hi_epu64(X[v], A[v], bi);
+      X[v] = _mm512_madd52hi_epu64(X[v], N[v], mi);
+    }
+  }
+
+  for (v = 0; v < vecs; v++)
+    _mm512_storeu_si512((void *)&t[v * 8], X[v]);
+
+  goo_radix_finish(mont, rp, t, 52);
+}
+
+__attribute__((target("avx512f,avx512ifma")))
+static GOO_INLINE void
+goo_mont_mul4_ifma(const goo_mont_t *mont,
+                   mp_limb_t **rp,
+                   const mp_limb_t **ap,
+                   const mp_limb_t **bp,
+                   size_t vecs) {
+  /* Four independent products, interleaved.
+   *
+   * Same algorithm as above, but every round
+   * issues the madds of all four lanes back to
+   * back. A single product is bound by the
+   * latency of its accumulator chain; with four
+   * chains in flight the multiply ports stay
+   * busy. The operands are read from memory to
+   * leave the registers to the accumulators.
+   *
+   * At 4096 bits the four accumulators (40
+   * vectors) no longer fit in the register file
+   * and the spills make this slower than four
+   * single products, so it is only used for
+   * 2048-bit moduli.
+   *
+   * Idle lanes (NULL `bp`) compute a^2 and
+   * throw it away.
+   */
+  static const uint64_t M = ((uint64_t)1 << 52) - 1;
+  const uint64_t *np = mont->nd[0];
+  size_t digits = vecs * 8;
+  uint64_t a[GOO_LANES][GOO_MAX_DIGITS / 2];
+  uint64_t b[GOO_LANES][GOO_MAX_DIGITS / 2];
+  uint64_t t[GOO_MAX_DIGITS / 2];
+  __m512i N[GOO_MAX_DIGITS / 16];
+  __m512i X[GOO_LANES][GOO_MAX_DIGITS / 16];
+  __m512i zero = _mm512_setzero_si512();
+  size_t i, v, l;
+
+  for (l = 0; l < GOO_LANES; l++) {
+    goo_radix_encode(a[l], digits, 52, ap[l], mont->limbs);
+    goo_radix_encode(b[l], digits, 52, bp[l] ? bp[l] : ap[l], mont->limbs);
+  }
+
+  for (v = 0; v < vecs; v++) {
+    N[v] = _mm512_loadu_si512((const void *)&np[v * 8]);
+
+    for (l = 0; l < GOO_LANES; l++)
+      X[l][v] = zero;
+  }
+
+  for (i = 0; i < digits; i++) {
+    __m512i bi[GOO_LANES];
+    __m512i mi[GOO_LANES];
+    uint64_t c[GOO_LANES];
+
+    for (l = 0; l < GOO_LANES; l++) {
+      uint64_t x0 = _mm_cvtsi128_si64(_mm512_castsi512_si128(X[l][0]));
+      uint64_t lo = (a[l][0] * b[l][i]) & M;
+      uint64_t m = ((x0 + lo) * mont->kd) & M;
+
+      c[l] = (x0 + lo + ((np[0] * m) & M)) >> 52;
+      bi[l] = _mm512_set1_epi64(b[l][i]);
+      mi[l] = _mm512_set1_epi64(m);
+    }
+
+    for (v = 0; v < vecs; v++) {
+      for (l = 0; l < GOO_LANES; l++) {
+        __m512i A = _mm512_loadu_si512((const void *)&a[l][v * 8]);
+
+        X[l][v] = _mm512_madd52lo_epu64(X[l][v], A, bi[l]);
+        X[l][v] = _mm512_madd52lo_epu64(X[l][v], N[v], mi[l]);
+      }
+    }
+
+    for (l = 0; l < GOO_LANES; l++) {
+      for (v = 0; v < vecs - 1; v++)
+        X[l][v] = _mm512_alignr_epi64(X[l][v + 1], X[l][v], 1);
+
+      X[l][vecs - 1] = _mm512_alignr_epi64(zero, X[l][vecs - 1], 1);
+      X[l][0] = _mm512_add_epi64(X[l][0], _mm512_maskz_set1_epi64(1, c[l]));
+    }
+
+    for (v = 0; v < vecs; v++) {
+      for (l = 0; l < GOO_LANES; l++) {
+        __m512i A = _mm512_loadu_si512((const void *)&a[l][v * 8]);
+
+        X[l][v] = _mm512_madd52hi_epu64(X[l][v], A, bi[l]);
+        X[l][v] = _mm512_madd52hi_epu64(X[l][v], N[v], mi[l]);
+      }
+    }
+  }
+
+  for (l = 0; l < GOO_LANES; l++) {
+    if (bp[l] == NULL)
+      continue;
+
+    for (v = 0; v < vecs; v++)
+      _mm512_storeu_si512((void *)&t[v * 8], X[l][v]);
+
+    goo_radix_finish(mont, rp[l], t, 52);
+  }
+}
+
+__attribute__((target("avx2")))
+static GOO_INLINE void
+goo_mont_mul_avx2(const goo_mont_t *mont,
+                  mp_limb_t *rp,
+                  const mp_limb_t *ap,
+                  const mp_limb_t *bp,
+                  size_t vecs) {
+  /* Word-by-word Montgomery in radix 2^26.
+   *
+   * The accumulator is in memory. To keep every
+   * load and store aligned to the same 4-digit
+   * blocks (so store forwarding works), round
+   * `i` uses copies of `a` and `n` shifted up by
+   * i mod 4 digits. Products are < 2^52, so the
+   * lanes can absorb all rounds without carries.
+   */
+  static const uint64_t M = ((uint64_t)1 << 26) - 1;
+  size_t digits = vecs * 4;
+  uint64_t as[4][GOO_MAX_DIGITS + 4];
+  uint64_t b[GOO_MAX_DIGITS];
+  uint64_t t[GOO_MAX_DIGITS * 2 + 8];
+  size_t i, j, v;
+
+  for (j = 0; j < 4; j++) {
+    for (i = 0; i < j; i++)
+      as[j][i] = 0;
+
+    goo_radix_encode(&as[j][j], digits, 26, ap, mont->limbs);
+
+    for (i = digits + j; i < digits + 4; i++)
+      as[j][i] = 0;
+  }
+
+  goo_radix_encode(b, digits, 26, bp, mont->limbs);
+
+  for (i = 0; i < digits * 2 + 8; i++)
+    t[i] = 0;
+
+  /* Two rounds at a time: with `i` even, the */
+  /* copies for i and i + 1 share a block base. */
+  for (i = 0; i < digits; i += 2) {
+    size_t s = i & 3;
+    size_t base = i - s;
+    const uint64_t *xa0 = as[s];
+    const uint64_t *xn0 = mont->nd[s];
+    const uint64_t *xa1 = as[s + 1];
+    const uint64_t *xn1 = mont->nd[s + 1];
+    uint64_t x0 = t[i] + as[0][0] * b[i];
+    uint64_t m0 = (x0 * mont->kd) & M;
+    uint64_t c0 = (x0 + mont->nd[0][0] * m0) >> 26;
+    uint64_t x1 = t[i + 1] + as[0][1] * b[i] + mont->nd[0][1] * m0 + c0
+                + as[0][0] * b[i + 1];
+    uint64_t m1 = (x1 * mont->kd) & M;
+    __m256i b0 = _mm256_set1_epi64x(b[i]);
+    __m256i b1 = _mm256_set1_epi64x(b[i + 1]);
+    __m256i n0 = _mm256_set1_epi64x(m0);
+    __m256i n1 = _mm256_set1_epi64x(m1);
+
+    for (v = 0; v <= vecs; v++) {
+      __m256i *tp = (__m256i *)&t[base + v * 4];
+      __m256i x = _mm256_loadu_si256(tp);
+      __m256i y0 = _mm256_loadu_si256((const __m256i *)&xa0[v * 4]);
+      __m256i z0 = _mm256_loadu_si256((const __m256i *)&xn0[v * 4]);
+      __m256i y1 = _mm256_loadu_si256((const __m256i *)&xa1[v * 4]);
+      __m256i z1 = _mm256_loadu_si256((const __m256i *)&xn1[v * 4]);
+
+      x = _mm256_add_epi64(x, _mm256_mul_epu32(y0, b0));
+      x = _mm256_add_epi64(x, _mm256_mul_epu32(z0, n0));
+      x = _mm256_add_epi64(x, _mm256_mul_epu32(y1, b1));
+      x = _mm256_add_epi64(x, _mm256_mul_epu32(z1, n1));
+
+      _mm256_storeu_si256(tp, x);
+    }
+
+    /* t[i] == 0 and t[i + 1] + c0 == 0 mod 2^26 */
+    t[i + 1] += t[i] >> 26;
+    t[i + 2] += t[i + 1] >> 26;
+  }
+
+  goo_radix_finish(mont, rp, &t[digits], 26);
+}
+
+__attribute__((target("avx512f,avx512ifma")))
+static void
+goo_mont_mul_ifma40(const goo_mont_t *mont,
+                    mp_limb_t *rp,
+                    const mp_limb_t *ap,
+                    const mp_limb_t *bp) {
+  goo_mont_mul_ifma(mont, rp, ap, bp, 5);
+}
+
+__attribute__((target("avx512f,avx512ifma")))
+static void
+goo_mont_sqr_ifma40(const goo_mont_t *mont,
+                    mp_limb_t *rp,
+                    const mp_limb_t *ap) {
+  goo_mont_mul_ifma(mont, rp, ap, ap, 5);
+}
+
+__attribute__((target("avx512f,avx512ifma")))
+static void
+goo_mont_mul_ifma80(const goo_mont_t *mont,
+                    mp_limb_t *rp,
+                    const mp_limb_t *ap,
+                    const mp_limb_t *bp) {
+  goo_mont_mul_ifma(mont, rp, ap, bp, 10);
+}
+
+__attribute__((target("avx512f,avx512ifma")))
+static void
+goo_mont_sqr_ifma80(const goo_mont_t *mont,
+                    mp_limb_t *rp,
+                    const mp_limb_t *ap) {
+  goo_mont_mul_ifma(mont, rp, ap, ap, 10);
+}
+
+__attribute__((target("avx512f,avx512ifma")))
+static void
+goo_mont_mul4_ifma40(const goo_mont_t *mont,
+                     mp_limb_t **rp,
+                     const mp_limb_t **ap,
+                     const mp_limb_t **bp) {
+  goo_mont_mul4_ifma(mont, rp, ap, bp, 5);
+}
+
+__attribute__((target("avx2")))
+static void
+goo_mont_mul_avx2_80(const goo_mont_t *mont,
+                     mp_limb_t *rp,
+                     const mp_limb_t *ap,
+                     const mp_limb_t *bp) {
+  goo_mont_mul_avx2(mont, rp, ap, bp, 20);
+}
+
+__attribute__((target("avx2")))
+static void
+goo_mont_sqr_avx2_80(const goo_mont_t *mont,
+                     mp_limb_t *rp,
+                     const mp_limb_t *ap) {
+  goo_mont_mul_avx2(mont, rp, ap, ap, 20);
+}
+
+__attribute__((target("avx2")))
+static void
+goo_mont_mul_avx2_160(const goo_mont_t *mont,
+                      mp_limb_t *rp,
+                      const mp_limb_t *ap,
+                      const mp_limb_t *bp) {
+  goo_mont_mul_avx2(mont, rp, ap, bp, 40);
+}
 
-  for (ppa = 2; ppa < 18; ppa++) {
-    unsigned long bpw = (bits + ppa - 1) / ppa;
-    unsigned long sqrt = goo_isqrt(bpw);
-    unsigned long aps;
+__attribute__((target("avx2")))
+static void
+goo_mont_sqr_avx2_160(const goo_mont_t *mont,
+                      mp_limb_t *rp,
+                      const mp_limb_t *ap) {
+  goo_mont_mul_avx2(mont, rp, ap, ap, 40);
+}
 
-    for (aps = 1; aps < sqrt + 2; aps++) {
-      unsigned long shifts, ops1, ops2, ops;
+#undef GOO_INLINE
 
-      if (bpw % aps != 0)
-        continue;
+static int
+goo_has_ifma(void) {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx512f")
+      && __builtin_cpu_supports("avx512ifma");
+}
 
-      shifts = bpw / aps;
+static int
+goo_has_avx2(void) {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+}
 
-      ASSERT(shifts != 0);
-      ASSERT(aps != 0);
+static int
+goo_mont_init_vector(goo_mont_t *mont, int kernel) {
+  /* Returns the radix, or zero if no */
+  /* vector kernel applies. */
+  unsigned int radix;
+  uint64_t n0, inv;
+  size_t i, j;
+
+  if (mont->limbs != 32 && mont->limbs != 64)
+    return 0;
 
-      ops1 = shifts * (aps + 1) - 1;
-      ops2 = aps * (shifts + 1) - 1;
-      ops = ops1 > ops2 ? ops1 : ops2;
+  /* The AVX2 kernel only beats the fixed-width */
+  /* limb kernels at 4096 bits (the limb kernels */
+  /* have a dedicated squaring). */
+  if (kernel == GOO_MONT_AUTO) {
+    if (goo_has_ifma())
+      kernel = GOO_MONT_IFMA;
+    else if (goo_has_avx2() && mont->limbs == 64)
+      kernel = GOO_MONT_AVX2;
+    else
+      return 0;
+  }
 
-      if (ops > max)
-        max = ops;
-    }
+  if (kernel == GOO_MONT_IFMA && goo_has_ifma()) {
+    radix = 52;
+    mont->digits = mont->limbs == 32 ? 40 : 80;
+    mont->mul = mont->limbs == 32 ? goo_mont_mul_ifma40 : goo_mont_mul_ifma80;
+    mont->sqr = mont->limbs == 32 ? goo_mont_sqr_ifma40 : goo_mont_sqr_ifma80;
+    mont->mul4 = mont->limbs == 32 ? goo_mont_mul4_ifma40 : NULL;
+  } else if (kernel == GOO_MONT_AVX2 && goo_has_avx2()) {
+    radix = 26;
+    mont->digits = mont->limbs == 32 ? 80 : 160;
+    mont->mul = mont->limbs == 32 ? goo_mont_mul_avx2_80 : goo_mont_mul_avx2_160;
+    mont->sqr = mont->limbs == 32 ? goo_mont_sqr_avx2_80 : goo_mont_sqr_avx2_160;
+  } else {
+    return 0;
   }
 
-  return max + 1;
-}
+  mont->kernel = kernel;
+  mont->bits = radix * mont->digits;
 
-static void
-combspec_generate(goo_combspec_t **specs,
-                  size_t specs_len,
-                  unsigned long shifts,
-                  unsigned long aps,
-                  unsigned long ppa,
-                  unsigned long bps) {
-  unsigned long ops = shifts * (aps + 1) - 1;
-  unsigned long size = ((1 << ppa) - 1) * aps;
-  goo_combspec_t *best;
+  for (j = 0; j < 4; j++) {
+    for (i = 0; i < j; i++)
+      mont->nd[j][i] = 0;
 
-  ASSERT((size_t)ops < specs_len);
+    goo_radix_encode(&mont->nd[j][j], mont->digits, radix,
+                     mont->n, mont->limbs);
 
-  if (specs[ops] == NULL) {
-    specs[ops] = goo_malloc(sizeof(goo_combspec_t));
-    specs[ops]->size = ULONG_MAX;
+    for (i = mont->digits + j; i < mont->digits + 4; i++)
+      mont->nd[j][i] = 0;
   }
 
-  best = specs[ops];
+  /* kd = -n^-1 mod 2^radix */
+  n0 = mont->nd[0][0];
+  inv = n0;
 
-  if (best->size > size) {
-    best->points_per_add = ppa;
-    best->adds_per_shift = aps;
-    best->shifts = shifts;
-    best->bits_per_window = bps;
-    best->size = size;
-  }
+  for (i = 3; i < radix; i *= 2)
+    inv *= 2 - n0 * inv;
+
+  mont->kd = (0 - inv) & (((uint64_t)1 << radix) - 1);
+
+  return 1;
 }
 
+#endif /* GOO_HAS_VECTOR */
+
 static int
-goo_combspec_init(goo_combspec_t *out,
-                  unsigned long bits,
-                  unsigned long max_size) {
-  int r = 0;
-  size_t specs_len, i;
-  goo_combspec_t **specs, *ret;
-  unsigned long ppa, sm;
+goo_mont_init(goo_mont_t *mont, const mpz_t n, int kernel) {
+  mp_size_t limbs = (mp_size_t)mpz_size(n);
+  mp_limb_t n0, inv;
+  size_t bits;
+  mpz_t r;
 
-  if (bits == 0 || max_size == 0)
+  if (limbs == 0 || limbs > (mp_size_t)GOO_MAX_LIMBS)
     return 0;
 
-  /* We don't have a hash table, so this allocates up to ~70kb. */
-  specs_len = combspec_size(bits);
-  specs = goo_calloc(specs_len, sizeof(goo_combspec_t *));
+  if (mpz_even_p(n))
+    return 0;
 
-  for (ppa = 2; ppa < 18; ppa++) {
-    unsigned long bpw = (bits + ppa - 1) / ppa;
-    unsigned long sqrt = goo_isqrt(bpw);
-    unsigned long aps;
+  mont->limbs = limbs;
+
+  goo_mpn_import(mont->n, limbs, n);
+
+  /* Newton's method: n0 * n0 == 1 mod 8, and */
+  /* every iteration doubles the valid bits. */
+  n0 = mont->n[0];
+  inv = n0;
+
+  for (bits = 3; bits < GOO_LIMB_BITS; bits *= 2)
+    inv *= 2 - n0 * inv;
+
+  /* k = -n^-1 mod 2^GOO_LIMB_BITS */
+  mont->k = -inv;
+
+  /* Pick a kernel. */
+  mont->kernel = GOO_MONT_GENERIC;
+  mont->bits = limbs * GOO_LIMB_BITS;
+  mont->mul = goo_mont_mul_generic;
+  mont->sqr = goo_mont_sqr_generic;
+  mont->mul4 = NULL;
+  mont->digits = 0;
+
+#ifdef GOO_HAS_DLIMB
+  if (kernel != GOO_MONT_GENERIC && GOO_LIMB_BITS == GOO_LIMB_WIDTH) {
+    if (limbs == 32) {
+      mont->kernel = GOO_MONT_FIXED;
+      mont->mul = goo_mont_mul_32;
+      mont->sqr = goo_mont_sqr_32;
+    } else if (limbs == 64) {
+      mont->kernel = GOO_MONT_FIXED;
+      mont->mul = goo_mont_mul_64;
+      mont->sqr = goo_mont_sqr_64;
+    }
+  }
+#endif
 
-    for (aps = 1; aps < sqrt + 2; aps++) {
-      unsigned long shifts;
+#ifdef GOO_HAS_VECTOR
+  if (kernel != GOO_MONT_GENERIC)
+    goo_mont_init_vector(mont, kernel);
+#endif
 
-      if (bpw % aps != 0)
-        continue;
+  mpz_init(r);
 
-      shifts = bpw / aps;
+  /* one = 2^bits mod n */
+  mpz_set_ui(r, 1);
+  mpz_mul_2exp(r, r, mont->bits);
+  mpz_mod(r, r, n);
 
-      ASSERT(shifts != 0);
-      ASSERT(aps != 0);
+  goo_mpn_import(mont->one, limbs, r);
 
-      combspec_generate(specs, specs_len, shifts, aps, ppa, bpw);
-      combspec_generate(specs, specs_len, aps, shifts, ppa, bpw);
-    }
-  }
+  /* r2 = one^2 mod n */
+  mpz_mul(r, r, r);
+  mpz_mod(r, r, n);
 
-  sm = ULONG_MAX;
-  ret = NULL;
+  goo_mpn_import(mont->r2, limbs, r);
 
-  for (i = 0; i < specs_len; i++) {
-    goo_combspec_t *spec = specs[i];
+  mpz_clear(r);
 
-    if (spec == NULL)
-      continue;
+  return 1;
+}
 
-    if (sm <= spec->size)
-      continue;
+static void
+goo_mont_mul(const goo_mont_t *mont,
+             mp_limb_t *rp,
+             const mp_limb_t *ap,
+             const mp_limb_t *bp) {
+  mont->mul(mont, rp, ap, bp);
+}
 
-    sm = spec->size;
+static void
+goo_mont_sqr(const goo_mont_t *mont, mp_limb_t *rp, const mp_limb_t *ap) {
+  mont->sqr(mont, rp, ap);
+}
 
-    if (sm <= max_size) {
-      ret = spec;
-      break;
-    }
+static void
+goo_mont_mul4(const goo_mont_t *mont,
+              mp_limb_t **rp,
+              const mp_limb_t **ap,
+              const mp_limb_t **bp) {
+  /* A four-lane product costs about as much as */
+  /* three single ones, so only batch when at */
+  /* least three lanes have work. */
+  size_t i, active = 0;
+
+  for (i = 0; i < GOO_LANES; i++)
+    active += (bp[i] != NULL);
+
+  if (mont->mul4 != NULL && active >= 3) {
+    mont->mul4(mont, rp, ap, bp);
+    return;
   }
 
-  if (ret == NULL)
-    goto fail;
+  for (i = 0; i < GOO_LANES; i++) {
+    if (bp[i] == NULL)
+      continue;
 
-  memcpy(out, ret, sizeof(goo_combspec_t));
+    if (ap[i] == bp[i])
+      mont->sqr(mont, rp[i], ap[i]);
+    else
+      mont->mul(mont, rp[i], ap[i], bp[i]);
+  }
+}
 
-  r = 1;
-fail:
-  for (i = 0; i < specs_len; i++)
-    goo_free(specs[i]);
+static void
+goo_mont_import(const goo_mont_t *mont, mp_limb_t *rp, const mpz_t x) {
+  /* rp = x * R mod n (0 <= x < 2^(limbs * GOO_LIMB_BITS)) */
+  mp_limb_t xp[GOO_MAX_LIMBS];
 
-  goo_free(specs);
+  goo_mpn_import(xp, mont->limbs, x);
 
-  return r;
+  /* x * R^2 < R * n, so REDC fully reduces x. */
+  goo_mont_mul(mont, rp, xp, mont->r2);
+}
+
+static void
+goo_mont_export(const goo_mont_t *mont, mpz_t ret, const mp_limb_t *ap) {
+  /* ret = ap * R^-1 mod n */
+  mp_limb_t up[GOO_MAX_LIMBS];
+  mp_limb_t rp[GOO_MAX_LIMBS];
+
+  mpn_zero(up, mont->limbs);
+  up[0] = 1;
+
+  goo_mont_mul(mont, rp, ap, up);
+  goo_mpn_export(ret, rp, mont->limbs);
 }
 
 /*
@@ -1465,6 +3287,7 @@ goo_comb_init(goo_comb_t *comb,
               goo_group_t *group,
               mpz_t base,
               goo_combspec_t *spec) {
+  mp_size_t limbs = group->mont.limbs;
   unsigned long i, j, skip;
   mpz_t *items, exp;
 
@@ -1479,18 +3302,14 @@ goo_comb_init(goo_comb_t *comb,
   comb->bits = spec->bits_per_window * spec->points_per_add;
   comb->points_per_subcomb = (1 << spec->points_per_add) - 1;
   comb->size = spec->size;
-  comb->items = goo_calloc(comb->size, sizeof(mpz_t));
-  comb->wins = goo_calloc(comb->shifts, sizeof(unsigned long *));
-
-  for (i = 0; i < comb->size; i++)
-    mpz_init(comb->items[i]);
+  comb->items = goo_calloc(comb->size * limbs, sizeof(mp_limb_t));
 
-  for (i = 0; i < comb->shifts; i++)
-    comb->wins[i] = goo_calloc(comb->adds_per_shift, sizeof(unsigned long));
+  items = goo_calloc(comb->size, sizeof(mpz_t));
 
-  mpz_set(comb->items[0], base);
+  for (i = 0; i < comb->size; i++)
+    mpz_init(items[i]);
 
-  items = &comb->items[0];
+  mpz_set(items[0], base);
 
   /* exp = 1 << bits_per_window */
   mpz_set_ui(exp, 1);
@@ -1520,38 +3339,29 @@ goo_comb_init(goo_comb_t *comb,
     }
   }
 
+  /* Convert to Montgomery form. */
+  for (i = 0; i < comb->size; i++) {
+    goo_mont_import(&group->mont, &comb->items[i * limbs], items[i]);
+    mpz_clear(items[i]);
+  }
+
+  goo_free(items);
+
   mpz_clear(exp);
 }
 
 static void
 goo_comb_uninit(goo_comb_t *comb) {
-  unsigned long i;
-
-  for (i = 0; i < comb->size; i++)
-    mpz_clear(comb->items[i]);
-
-  for (i = 0; i < comb->shifts; i++)
-    goo_free(comb->wins[i]);
-
   goo_free(comb->items);
-  goo_free(comb->wins);
 
   comb->shifts = 0;
   comb->size = 0;
   comb->items = NULL;
-  comb->wins = NULL;
-}
-
-static void
-goo_comb_cleanse(goo_comb_t *comb) {
-  unsigned long i;
-
-  for (i = 0; i < comb->shifts; i++)
-    goo_cleanse(comb->wins[i], comb->adds_per_shift * sizeof(unsigned long));
 }
 
 static int
-goo_comb_recode(goo_comb_t *comb, const mpz_t e) {
+goo_comb_recode(const goo_comb_t *comb, unsigned long *wins, const mpz_t e) {
+  /* Windows are written to `wins` (shifts * adds_per_shift). */
   unsigned long len = goo_mpz_bitlen(e);
   long i;
 
@@ -1575,7 +3385,7 @@ goo_comb_recode(goo_comb_t *comb, const mpz_t e) {
         ret |= mpz_tstbit(e, (comb->bits - 1) - b);
       }
 
-      comb->wins[j][(comb->adds_per_shift - 1) - i] = ret;
+      wins[j * comb->adds_per_shift + (comb->adds_per_shift - 1) - i] = ret;
     }
   }
 
@@ -1595,6 +3405,7 @@ goo_group_init(goo_group_t *group,
                unsigned long g,
                unsigned long h,
                unsigned long bits) {
+  unsigned char slab[GOO_MAX_RSA_BYTES];
   size_t i;
 
   /* Allocate. */
@@ -1603,16 +3414,8 @@ goo_group_init(goo_group_t *group,
   mpz_init(group->h);
   mpz_init(group->nh);
 
-  goo_prng_init(&group->prng);
-
-  for (i = 0; i < GOO_TABLEN; i++) {
-    mpz_init(group->table_p1[i]);
-    mpz_init(group->table_n1[i]);
-    mpz_init(group->table_p2[i]);
-    mpz_init(group->table_n2[i]);
-  }
-
   group->combs_len = 0;
+  group->wins_len = 0;
 
   /* Initialize. */
   mpz_set(group->n, n);
@@ -1624,20 +3427,24 @@ goo_group_init(goo_group_t *group,
   group->size = (group->bits + 7) / 8;
   group->rand_bits = group->bits - 1;
 
+  /* Pre-calculate Montgomery constants. */
+  if (!goo_mont_init(&group->mont, group->n, GOO_MONT_AUTO))
+    goto fail;
+
   /* Pre-calculate signature hash prefix. */
   goo_sha256_init(&group->sha);
 
-  if (!goo_hash_int(&group->sha, group->g, 4, group->slab)
-      || !goo_hash_int(&group->sha, group->h, 4, group->slab)
-      || !goo_hash_int(&group->sha, group->n, group->size, group->slab)) {
+  if (!goo_hash_int(&group->sha, group->g, 4, slab)
+      || !goo_hash_int(&group->sha, group->h, 4, slab)
+      || !goo_hash_int(&group->sha, group->n, group->size, slab)) {
     goto fail;
   }
 
-  goo_sha256_final(&group->sha, group->slab);
+  goo_sha256_final(&group->sha, slab);
 
   goo_sha256_init(&group->sha);
   goo_sha256_update(&group->sha, GOO_HASH_PREFIX, sizeof(GOO_HASH_PREFIX));
-  goo_sha256_update(&group->sha, group->slab, GOO_SHA256_HASH_SIZE);
+  goo_sha256_update(&group->sha, slab, GOO_SHA256_HASH_SIZE);
 
   /* Calculate combs for g^e1 * h^e2 mod n. */
   if (bits != 0) {
@@ -1676,6 +3483,15 @@ goo_group_init(goo_group_t *group,
     group->combs_len = 1;
   }
 
+  /* Size of the comb windows for scratch space. */
+  for (i = 0; i < group->combs_len; i++) {
+    goo_comb_t *comb = &group->combs[i].g;
+    size_t len = comb->shifts * comb->adds_per_shift;
+
+    if (len > group->wins_len)
+      group->wins_len = len;
+  }
+
   return 1;
 fail:
   goo_group_uninit(group);
@@ -1691,44 +3507,96 @@ goo_group_uninit(goo_group_t *group) {
   mpz_clear(group->g);
   mpz_clear(group->h);
 
-  goo_prng_uninit(&group->prng);
-
-  for (i = 0; i < GOO_TABLEN; i++) {
-    mpz_clear(group->table_p1[i]);
-    mpz_clear(group->table_n1[i]);
-    mpz_clear(group->table_p2[i]);
-    mpz_clear(group->table_n2[i]);
-  }
-
   for (i = 0; i < group->combs_len; i++) {
     goo_comb_uninit(&group->combs[i].g);
     goo_comb_uninit(&group->combs[i].h);
   }
 
   group->combs_len = 0;
+  group->wins_len = 0;
+}
+
+/*
+ * Scratch
+ */
+
+static void
+goo_scratch_init(goo_scratch_t *scratch, const goo_group_t *group) {
+  mp_size_t limbs = group->mont.limbs;
+
+  goo_prng_init(&scratch->prng);
+
+  scratch->limbs = limbs;
+  scratch->table_p1 = goo_calloc(GOO_TABLEN * limbs, sizeof(mp_limb_t));
+  scratch->table_n1 = goo_calloc(GOO_TABLEN * limbs, sizeof(mp_limb_t));
+  scratch->table_p2 = goo_calloc(GOO_TABLEN * limbs, sizeof(mp_limb_t));
+  scratch->table_n2 = goo_calloc(GOO_TABLEN * limbs, sizeof(mp_limb_t));
+
+  scratch->wins_len = group->wins_len;
+  scratch->gwins = goo_calloc(group->wins_len, sizeof(unsigned long));
+  scratch->hwins = goo_calloc(group->wins_len, sizeof(unsigned long));
+  scratch->bwins = goo_calloc(group->wins_len, sizeof(unsigned long));
+
+  scratch->lanes = goo_calloc(GOO_LANES * 4 * GOO_TABLEN * limbs,
+                              sizeof(mp_limb_t));
+  scratch->wins4 = goo_calloc(GOO_LANES * 2 * group->wins_len,
+                              sizeof(unsigned long));
 }
 
 static void
-goo_group_cleanse(goo_group_t *group) {
-  size_t i;
+goo_scratch_uninit(goo_scratch_t *scratch) {
+  goo_prng_uninit(&scratch->prng);
+
+  goo_free(scratch->table_p1);
+  goo_free(scratch->table_n1);
+  goo_free(scratch->table_p2);
+  goo_free(scratch->table_n2);
+
+  goo_free(scratch->gwins);
+  goo_free(scratch->hwins);
+  goo_free(scratch->bwins);
+
+  goo_free(scratch->lanes);
+  goo_free(scratch->wins4);
+
+  scratch->limbs = 0;
+  scratch->table_p1 = NULL;
+  scratch->table_n1 = NULL;
+  scratch->table_p2 = NULL;
+  scratch->table_n2 = NULL;
+
+  scratch->wins_len = 0;
+  scratch->gwins = NULL;
+  scratch->hwins = NULL;
+  scratch->bwins = NULL;
+
+  scratch->lanes = NULL;
+  scratch->wins4 = NULL;
+}
 
-  for (i = 0; i < GOO_TABLEN; i++) {
-    goo_mpz_cleanse(group->table_p1[i]);
-    goo_mpz_cleanse(group->table_n1[i]);
-    goo_mpz_cleanse(group->table_p2[i]);
-    goo_mpz_cleanse(group->table_n2[i]);
-  }
+static void
+goo_scratch_cleanse(goo_scratch_t *scratch) {
+  size_t size = GOO_TABLEN * scratch->limbs * sizeof(mp_limb_t);
 
-  goo_cleanse(group->wnaf0, sizeof(group->wnaf0));
-  goo_cleanse(group->wnaf1, sizeof(group->wnaf1));
-  goo_cleanse(group->wnaf2, sizeof(group->wnaf2));
+  goo_cleanse(scratch->table_p1, size);
+  goo_cleanse(scratch->table_n1, size);
+  goo_cleanse(scratch->table_p2, size);
+  goo_cleanse(scratch->table_n2, size);
 
-  for (i = 0; i < group->combs_len; i++) {
-    goo_comb_cleanse(&group->combs[i].g);
-    goo_comb_cleanse(&group->combs[i].h);
-  }
+  goo_cleanse(scratch->wnaf0, sizeof(scratch->wnaf0));
+  goo_cleanse(scratch->wnaf1, sizeof(scratch->wnaf1));
+  goo_cleanse(scratch->wnaf2, sizeof(scratch->wnaf2));
+
+  goo_cleanse(scratch->gwins, scratch->wins_len * sizeof(unsigned long));
+  goo_cleanse(scratch->hwins, scratch->wins_len * sizeof(unsigned long));
+  goo_cleanse(scratch->bwins, scratch->wins_len * sizeof(unsigned long));
 
-  goo_cleanse(group->slab, sizeof(group->slab));
+  goo_cleanse(scratch->lanes, GOO_LANES * 4 * size);
+  goo_cleanse(scratch->wnaf4, sizeof(scratch->wnaf4));
+  goo_cleanse(scratch->wins4,
+              GOO_LANES * 2 * scratch->wins_len * sizeof(unsigned long));
+
+  goo_cleanse(scratch->slab, sizeof(scratch->slab));
 }
 
 static void
@@ -1750,10 +3618,26 @@ goo_group_is_reduced(goo_group_t *group, const mpz_t b) {
 }
 
 static void
-goo_group_sqr(goo_group_t *group, mpz_t ret, const mpz_t b) {
-  /* ret = b^2 mod n */
-  mpz_mul(ret, b, b);
-  mpz_mod(ret, ret, group->n);
+goo_group_to_mont(goo_group_t *group, mp_limb_t *rp, const mpz_t b) {
+  /* rp = b * R mod n */
+  if (mpz_sgn(b) < 0 || mpz_size(b) > (size_t)group->mont.limbs) {
+    mpz_t t;
+
+    mpz_init(t);
+    mpz_mod(t, b, group->n);
+
+    goo_mont_import(&group->mont, rp, t);
+
+    mpz_clear(t);
+  } else {
+    goo_mont_import(&group->mont, rp, b);
+  }
+}
+
+static void
+goo_group_from_mont(goo_group_t *group, mpz_t ret, const mp_limb_t *ap) {
+  /* ret = ap * R^-1 mod n */
+  goo_mont_export(&group->mont, ret, ap);
 }
 
 static void
@@ -1875,6 +3759,51 @@ fail:
   return r;
 }
 
+static int
+goo_group_invn(goo_group_t *group,
+               mpz_t *out,
+               mpz_srcptr *in,
+               size_t len) {
+  /* Montgomery's trick: invert `len` */
+  /* elements with a single inversion. */
+  int r = 0;
+  mpz_t acc, tmp;
+  size_t i;
+
+  if (len == 0)
+    return 1;
+
+  mpz_init(acc);
+  mpz_init(tmp);
+
+  /* out[i] = in[0] * ... * in[i] mod n */
+  mpz_set(out[0], in[0]);
+
+  for (i = 1; i < len; i++)
+    goo_group_mul(group, out[i], out[i - 1], in[i]);
+
+  /* acc = (in[0] * ... * in[len - 1])^-1 mod n */
+  if (!goo_group_inv(group, acc, out[len - 1]))
+    goto fail;
+
+  for (i = len - 1; i > 0; i--) {
+    /* out[i] = acc * out[i - 1] mod n */
+    goo_group_mul(group, tmp, acc, out[i - 1]);
+    mpz_swap(out[i], tmp);
+
+    /* acc = acc * in[i] mod n */
+    goo_group_mul(group, acc, acc, in[i]);
+  }
+
+  mpz_set(out[0], acc);
+
+  r = 1;
+fail:
+  mpz_clear(acc);
+  mpz_clear(tmp);
+  return r;
+}
+
 #ifdef GOO_TEST
 static int
 goo_group_powgh_slow(
@@ -1910,8 +3839,20 @@ goo_group_powgh_slow(
 #endif
 
 static int
-goo_group_powgh(goo_group_t *group, mpz_t ret, const mpz_t e1, const mpz_t e2) {
-  /* Compute g^e1 * h*e2 mod n. */
+goo_group_powbgh(goo_group_t *group,
+                 goo_scratch_t *scratch,
+                 mpz_t ret,
+                 const goo_comb_t *bcombs,
+                 const mpz_t e0,
+                 const mpz_t e1,
+                 const mpz_t e2) {
+  /* Compute b^e0 * g^e1 * h^e2 mod n, where `bcombs` */
+  /* holds combs for `b` shaped like the group's (or */
+  /* is NULL, in which case `e0` is ignored). */
+  goo_mont_t *mont = &group->mont;
+  mp_size_t limbs = mont->limbs;
+  mp_limb_t acc[GOO_MAX_LIMBS];
+  const goo_comb_t *bcomb = NULL;
   goo_comb_t *gcomb = NULL;
   goo_comb_t *hcomb = NULL;
   unsigned long bits1 = goo_mpz_bitlen(e1);
@@ -1919,10 +3860,21 @@ goo_group_powgh(goo_group_t *group, mpz_t ret, const mpz_t e1, const mpz_t e2) {
   unsigned long bits = bits1 > bits2 ? bits1 : bits2;
   unsigned long i;
 
+  if (bcombs != NULL) {
+    unsigned long bits0 = goo_mpz_bitlen(e0);
+
+    if (bits0 > bits)
+      bits = bits0;
+  }
+
   for (i = 0; i < (unsigned long)group->combs_len; i++) {
     if (bits <= group->combs[i].g.bits) {
       gcomb = &group->combs[i].g;
       hcomb = &group->combs[i].h;
+
+      if (bcombs != NULL)
+        bcomb = &bcombs[i];
+
       break;
     }
   }
@@ -1930,58 +3882,197 @@ goo_group_powgh(goo_group_t *group, mpz_t ret, const mpz_t e1, const mpz_t e2) {
   if (gcomb == NULL || hcomb == NULL)
     return 0;
 
-  if (!goo_comb_recode(gcomb, e1))
-    return 0;
+  if (gcomb->shifts * gcomb->adds_per_shift > scratch->wins_len)
+    return 0;
+
+  if (!goo_comb_recode(gcomb, scratch->gwins, e1))
+    return 0;
+
+  if (!goo_comb_recode(hcomb, scratch->hwins, e2))
+    return 0;
+
+  if (bcomb != NULL && !goo_comb_recode(bcomb, scratch->bwins, e0))
+    return 0;
+
+  mpn_copyi(acc, mont->one, limbs);
+
+  for (i = 0; i < gcomb->shifts; i++) {
+    unsigned long *us = &scratch->gwins[i * gcomb->adds_per_shift];
+    unsigned long *vs = &scratch->hwins[i * hcomb->adds_per_shift];
+    unsigned long *ws = &scratch->bwins[i * gcomb->adds_per_shift];
+    unsigned long j;
+
+    if (i != 0)
+      goo_mont_sqr(mont, acc, acc);
+
+    for (j = 0; j < gcomb->adds_per_shift; j++) {
+      unsigned long u = us[j];
+      unsigned long v = vs[j];
+
+      if (u != 0) {
+        unsigned long k = j * gcomb->points_per_subcomb + u - 1;
+        goo_mont_mul(mont, acc, acc, &gcomb->items[k * limbs]);
+      }
+
+      if (v != 0) {
+        unsigned long k = j * hcomb->points_per_subcomb + v - 1;
+        goo_mont_mul(mont, acc, acc, &hcomb->items[k * limbs]);
+      }
+
+      if (bcomb != NULL && ws[j] != 0) {
+        unsigned long k = j * bcomb->points_per_subcomb + ws[j] - 1;
+        goo_mont_mul(mont, acc, acc, &bcomb->items[k * limbs]);
+      }
+    }
+  }
+
+  goo_group_from_mont(group, ret, acc);
+
+  return 1;
+}
+
+static int
+goo_group_powgh(goo_group_t *group,
+                goo_scratch_t *scratch,
+                mpz_t ret,
+                const mpz_t e1,
+                const mpz_t e2) {
+  /* Compute g^e1 * h*e2 mod n. */
+  return goo_group_powbgh(group, scratch, ret, NULL, NULL, e1, e2);
+}
+
+static int
+goo_group_powgh_batch(goo_group_t *group,
+                      mpz_ptr *ret,
+                      mpz_srcptr *e1,
+                      mpz_srcptr *e2,
+                      size_t count) {
+  /* Compute ret[i] = g^e1[i] * h^e2[i] mod n. Up to */
+  /* GOO_BATCH_SIZE results are built together, column */
+  /* by column: each subcomb is visited once per shift */
+  /* and applied to every accumulator while it is hot, */
+  /* rather than the whole table once per exponent. */
+  goo_mont_t *mont = &group->mont;
+  mp_size_t limbs = mont->limbs;
+  mp_limb_t accs[GOO_BATCH_SIZE][GOO_MAX_LIMBS];
+  unsigned long *gwins = NULL;
+  unsigned long *hwins = NULL;
+  size_t off, len, k, n;
+  int r = 0;
+
+  for (off = 0; off < count; off += n) {
+    goo_comb_t *gcomb = NULL;
+    goo_comb_t *hcomb = NULL;
+    unsigned long bits = 0;
+    unsigned long adds, i, j;
+
+    n = count - off;
+
+    if (n > GOO_BATCH_SIZE)
+      n = GOO_BATCH_SIZE;
+
+    for (k = 0; k < n; k++) {
+      unsigned long bits1 = goo_mpz_bitlen(e1[off + k]);
+      unsigned long bits2 = goo_mpz_bitlen(e2[off + k]);
+
+      if (bits1 > bits)
+        bits = bits1;
+
+      if (bits2 > bits)
+        bits = bits2;
+    }
+
+    for (i = 0; i < (unsigned long)group->combs_len; i++) {
+      if (bits <= group->combs[i].g.bits) {
+        gcomb = &group->combs[i].g;
+        hcomb = &group->combs[i].h;
+        break;
+      }
+    }
+
+    if (gcomb == NULL || hcomb == NULL)
+      goto fail;
 
-  if (!goo_comb_recode(hcomb, e2))
-    return 0;
+    adds = gcomb->adds_per_shift;
+    len = gcomb->shifts * adds;
 
-  mpz_set_ui(ret, 1);
+    gwins = goo_malloc(n * len * sizeof(unsigned long));
+    hwins = goo_malloc(n * len * sizeof(unsigned long));
 
-  for (i = 0; i < gcomb->shifts; i++) {
-    unsigned long *us = gcomb->wins[i];
-    unsigned long *vs = hcomb->wins[i];
-    unsigned long j;
+    for (k = 0; k < n; k++) {
+      if (!goo_comb_recode(gcomb, &gwins[k * len], e1[off + k]))
+        goto fail;
 
-    if (i != 0)
-      goo_group_sqr(group, ret, ret);
+      if (!goo_comb_recode(hcomb, &hwins[k * len], e2[off + k]))
+        goto fail;
 
-    for (j = 0; j < gcomb->adds_per_shift; j++) {
-      unsigned long u = us[j];
-      unsigned long v = vs[j];
+      mpn_copyi(accs[k], mont->one, limbs);
+    }
 
-      if (u != 0) {
-        mpz_t *g = &gcomb->items[j * gcomb->points_per_subcomb + u - 1];
-        goo_group_mul(group, ret, ret, *g);
+    for (i = 0; i < gcomb->shifts; i++) {
+      if (i != 0) {
+        for (k = 0; k < n; k++)
+          goo_mont_sqr(mont, accs[k], accs[k]);
       }
 
-      if (v != 0) {
-        mpz_t *h = &hcomb->items[j * hcomb->points_per_subcomb + v - 1];
-        goo_group_mul(group, ret, ret, *h);
+      for (j = 0; j < adds; j++) {
+        unsigned long gpos = j * gcomb->points_per_subcomb;
+        unsigned long hpos = j * hcomb->points_per_subcomb;
+        const mp_limb_t *gitems = &gcomb->items[gpos * limbs];
+        const mp_limb_t *hitems = &hcomb->items[hpos * limbs];
+
+        for (k = 0; k < n; k++) {
+          unsigned long u = gwins[k * len + i * adds + j];
+
+          if (u != 0)
+            goo_mont_mul(mont, accs[k], accs[k], &gitems[(u - 1) * limbs]);
+        }
+
+        for (k = 0; k < n; k++) {
+          unsigned long v = hwins[k * len + i * adds + j];
+
+          if (v != 0)
+            goo_mont_mul(mont, accs[k], accs[k], &hitems[(v - 1) * limbs]);
+        }
       }
     }
+
+    for (k = 0; k < n; k++)
+      goo_group_from_mont(group, ret[off + k], accs[k]);
+
+    goo_free(gwins);
+    goo_free(hwins);
+
+    gwins = NULL;
+    hwins = NULL;
   }
 
-  return 1;
+  r = 1;
+fail:
+  goo_free(gwins);
+  goo_free(hwins);
+  return r;
 }
 
 static void
-goo_group_precomp_table(goo_group_t *group, mpz_t *out, const mpz_t b) {
-  mpz_t *b2 = &out[GOO_TABLEN - 1];
+goo_group_precomp_table(goo_group_t *group, mp_limb_t *out, const mpz_t b) {
+  /* out[i] = b^(2 * i + 1) mod n (Montgomery form) */
+  goo_mont_t *mont = &group->mont;
+  mp_size_t limbs = mont->limbs;
+  mp_limb_t *b2 = &out[(GOO_TABLEN - 1) * limbs];
   size_t i;
 
-  goo_group_sqr(group, *b2, b);
-
-  mpz_set(out[0], b);
+  goo_group_to_mont(group, &out[0], b);
+  goo_mont_sqr(mont, b2, &out[0]);
 
   for (i = 1; i < GOO_TABLEN; i++)
-    goo_group_mul(group, out[i], out[i - 1], *b2);
+    goo_mont_mul(mont, &out[i * limbs], &out[(i - 1) * limbs], b2);
 }
 
 static void
 goo_group_precomp_wnaf(goo_group_t *group,
-                       mpz_t *p,
-                       mpz_t *n,
+                       mp_limb_t *p,
+                       mp_limb_t *n,
                        const mpz_t b,
                        const mpz_t bi) {
   goo_group_precomp_table(group, p, b);
@@ -2029,11 +4120,17 @@ goo_group_wnaf(goo_group_t *group,
 }
 
 static void
-goo_group_one_mul(goo_group_t *group, mpz_t ret, long w, mpz_t *p, mpz_t *n) {
+goo_group_one_mul(goo_group_t *group,
+                  mp_limb_t *ret,
+                  long w,
+                  const mp_limb_t *p,
+                  const mp_limb_t *n) {
+  mp_size_t limbs = group->mont.limbs;
+
   if (w > 0)
-    goo_group_mul(group, ret, ret, p[(w - 1) >> 1]);
+    goo_mont_mul(&group->mont, ret, ret, &p[((w - 1) >> 1) * limbs]);
   else if (w < 0)
-    goo_group_mul(group, ret, ret, n[(-1 - w) >> 1]);
+    goo_mont_mul(&group->mont, ret, ret, &n[((-1 - w) >> 1) * limbs]);
 }
 
 static int
@@ -2050,41 +4147,6 @@ goo_group_pow_slow(goo_group_t *group,
   return 1;
 }
 
-static int
-goo_group_pow(goo_group_t *group,
-              mpz_t ret,
-              const mpz_t b,
-              const mpz_t bi,
-              const mpz_t e) {
-  /* Compute b^e mod n. */
-  mpz_t *p = &group->table_p1[0];
-  mpz_t *n = &group->table_n1[0];
-  size_t bits = goo_mpz_bitlen(e) + 1;
-  size_t i;
-
-  if (bits > GOO_MAX_RSA_BITS + 1)
-    return 0;
-
-  if (mpz_sgn(e) < 0)
-    return 0;
-
-  goo_group_precomp_wnaf(group, p, n, b, bi);
-  goo_group_wnaf(group, group->wnaf0, e, bits);
-
-  mpz_set_ui(ret, 1);
-
-  for (i = 0; i < bits; i++) {
-    long w = group->wnaf0[i];
-
-    if (i != 0)
-      goo_group_sqr(group, ret, ret);
-
-    goo_group_one_mul(group, ret, w, p, n);
-  }
-
-  return 1;
-}
-
 #ifdef GOO_TEST
 static int
 goo_group_pow2_slow(goo_group_t *group,
@@ -2120,54 +4182,143 @@ goo_group_pow2_slow(goo_group_t *group,
 #endif
 
 static int
-goo_group_pow2(goo_group_t *group,
-               mpz_t ret,
-               const mpz_t b1,
-               const mpz_t b1i,
-               const mpz_t e1,
-               const mpz_t b2,
-               const mpz_t b2i,
-               const mpz_t e2) {
-  /* Compute b1^e1 * b2^e2 mod n. */
-  mpz_t *p1 = &group->table_p1[0];
-  mpz_t *n1 = &group->table_n1[0];
-  mpz_t *p2 = &group->table_p2[0];
-  mpz_t *n2 = &group->table_n2[0];
-  size_t bits1 = goo_mpz_bitlen(e1);
-  size_t bits2 = goo_mpz_bitlen(e2);
-  size_t bits = (bits1 > bits2 ? bits1 : bits2) + 1;
+goo_group_multiexp(goo_group_t *group,
+                   goo_scratch_t *scratch,
+                   mpz_t ret,
+                   const mpz_t b1,
+                   const mpz_t b1i,
+                   const mpz_t e1,
+                   const mpz_t b2,
+                   const mpz_t b2i,
+                   const mpz_t e2,
+                   const mpz_t e3,
+                   const mpz_t e4) {
+  /* Compute b1^e1 * b2^e2 * g^e3 * h^e4 mod n.
+   *
+   * The second base is optional (b2 == NULL).
+   *
+   * This is an interleaved (Straus) evaluation:
+   * the wNAF digits of the variable bases and the
+   * comb columns of g and h share one squaring
+   * chain. Every component is aligned to the end
+   * of the chain so that its digits receive the
+   * same number of squarings as it would have in
+   * its own loop.
+   *
+   * All of the intermediate values (and the
+   * tables) are kept in Montgomery form.
+   */
+  goo_mont_t *mont = &group->mont;
+  mp_size_t limbs = mont->limbs;
+  mp_limb_t *p1 = scratch->table_p1;
+  mp_limb_t *n1 = scratch->table_n1;
+  mp_limb_t *p2 = scratch->table_p2;
+  mp_limb_t *n2 = scratch->table_n2;
+  mp_limb_t acc[GOO_MAX_LIMBS];
+  goo_comb_t *gcomb = NULL;
+  goo_comb_t *hcomb = NULL;
+  size_t bits1 = goo_mpz_bitlen(e1) + 1;
+  size_t bits2 = b2 != NULL ? goo_mpz_bitlen(e2) + 1 : 0;
+  size_t bits3 = goo_mpz_bitlen(e3);
+  size_t bits4 = goo_mpz_bitlen(e4);
+  size_t bits = bits3 > bits4 ? bits3 : bits4;
+  size_t len, off1, off2, off3;
   size_t i;
 
-  if (bits > GOO_ELL_BITS + 1)
+  if (bits1 > GOO_MAX_RSA_BITS + 1 || bits2 > GOO_ELL_BITS + 1)
     return 0;
 
-  if (mpz_sgn(e1) < 0 || mpz_sgn(e2) < 0)
+  if (mpz_sgn(e1) < 0 || (b2 != NULL && mpz_sgn(e2) < 0))
+    return 0;
+
+  for (i = 0; i < group->combs_len; i++) {
+    if (bits <= group->combs[i].g.bits) {
+      gcomb = &group->combs[i].g;
+      hcomb = &group->combs[i].h;
+      break;
+    }
+  }
+
+  if (gcomb == NULL || hcomb == NULL)
+    return 0;
+
+  if (gcomb->shifts * gcomb->adds_per_shift > scratch->wins_len)
+    return 0;
+
+  if (limbs > scratch->limbs)
+    return 0;
+
+  if (!goo_comb_recode(gcomb, scratch->gwins, e3))
+    return 0;
+
+  if (!goo_comb_recode(hcomb, scratch->hwins, e4))
     return 0;
 
   goo_group_precomp_wnaf(group, p1, n1, b1, b1i);
-  goo_group_precomp_wnaf(group, p2, n2, b2, b2i);
+  goo_group_wnaf(group, scratch->wnaf0, e1, bits1);
+
+  if (b2 != NULL) {
+    goo_group_precomp_wnaf(group, p2, n2, b2, b2i);
+    goo_group_wnaf(group, scratch->wnaf1, e2, bits2);
+  }
+
+  /* Length of the shared chain. */
+  len = bits1;
 
-  goo_group_wnaf(group, group->wnaf1, e1, bits);
-  goo_group_wnaf(group, group->wnaf2, e2, bits);
+  if (bits2 > len)
+    len = bits2;
 
-  mpz_set_ui(ret, 1);
+  if (gcomb->shifts > len)
+    len = gcomb->shifts;
 
-  for (i = 0; i < bits; i++) {
-    long w1 = group->wnaf1[i];
-    long w2 = group->wnaf2[i];
+  off1 = len - bits1;
+  off2 = len - bits2;
+  off3 = len - gcomb->shifts;
 
+  mpn_copyi(acc, mont->one, limbs);
+
+  for (i = 0; i < len; i++) {
     if (i != 0)
-      goo_group_sqr(group, ret, ret);
+      goo_mont_sqr(mont, acc, acc);
+
+    if (i >= off1)
+      goo_group_one_mul(group, acc, scratch->wnaf0[i - off1], p1, n1);
+
+    if (b2 != NULL && i >= off2)
+      goo_group_one_mul(group, acc, scratch->wnaf1[i - off2], p2, n2);
+
+    if (i >= off3) {
+      size_t aps = gcomb->adds_per_shift;
+      unsigned long *us = &scratch->gwins[(i - off3) * aps];
+      unsigned long *vs = &scratch->hwins[(i - off3) * aps];
+      size_t j;
 
-    goo_group_one_mul(group, ret, w1, p1, n1);
-    goo_group_one_mul(group, ret, w2, p2, n2);
+      for (j = 0; j < aps; j++) {
+        unsigned long u = us[j];
+        unsigned long v = vs[j];
+
+        if (u != 0) {
+          size_t k = j * gcomb->points_per_subcomb + u - 1;
+          goo_mont_mul(mont, acc, acc, &gcomb->items[k * limbs]);
+        }
+
+        if (v != 0) {
+          size_t k = j * hcomb->points_per_subcomb + v - 1;
+          goo_mont_mul(mont, acc, acc, &hcomb->items[k * limbs]);
+        }
+      }
+    }
   }
 
+  goo_group_from_mont(group, ret, acc);
+
   return 1;
 }
 
+#ifdef GOO_TEST
 static int
 goo_group_recover(goo_group_t *group,
+                  goo_scratch_t *scratch,
                   mpz_t ret,
                   const mpz_t b1,
                   const mpz_t b1i,
@@ -2178,34 +4329,333 @@ goo_group_recover(goo_group_t *group,
                   const mpz_t e3,
                   const mpz_t e4) {
   /* Compute b1^e1 * g^e3 * h^e4 / b2^e2 mod n. */
-  int r = 0;
-  mpz_t a;
-  mpz_ptr b = ret;
+  if (!goo_group_multiexp(group, scratch, ret, b1, b1i, e1,
+                          b2i, b2, e2, e3, e4)) {
+    return 0;
+  }
 
-  mpz_init(a);
+  /* ret = n - ret if ret > n / 2 */
+  goo_group_reduce(group, ret, ret);
 
-  /* a = b1^e1 / b2^e2 mod n */
-  if (!goo_group_pow2(group, a, b1, b1i, e1, b2i, b2, e2))
-    goto fail;
+  return 1;
+}
+#endif
 
-  /* b = g^e3 * h^e4 mod n */
-  if (!goo_group_powgh(group, b, e3, e4))
-    goto fail;
+static void
+goo_group_precomp_table4(goo_group_t *group,
+                         mp_limb_t **out,
+                         mpz_srcptr *b) {
+  /* out[l][i] = b[l]^(2 * i + 1) mod n (Montgomery form) */
+  goo_mont_t *mont = &group->mont;
+  mp_size_t limbs = mont->limbs;
+  mp_limb_t *rp[GOO_LANES];
+  const mp_limb_t *ap[GOO_LANES];
+  const mp_limb_t *bp[GOO_LANES];
+  mp_limb_t *b2[GOO_LANES];
+  size_t i, l;
+  mpz_t t;
+
+  mpz_init(t);
+
+  for (l = 0; l < GOO_LANES; l++) {
+    if (mpz_sgn(b[l]) < 0 || mpz_size(b[l]) > (size_t)limbs) {
+      mpz_mod(t, b[l], group->n);
+      goo_mpn_import(out[l], limbs, t);
+    } else {
+      goo_mpn_import(out[l], limbs, b[l]);
+    }
+
+    b2[l] = &out[l][(GOO_TABLEN - 1) * limbs];
+  }
+
+  mpz_clear(t);
+
+  /* out[l][0] = b[l] * R mod n */
+  for (l = 0; l < GOO_LANES; l++) {
+    rp[l] = out[l];
+    ap[l] = out[l];
+    bp[l] = mont->r2;
+  }
+
+  goo_mont_mul4(mont, rp, ap, bp);
+
+  for (l = 0; l < GOO_LANES; l++) {
+    rp[l] = b2[l];
+    bp[l] = out[l];
+  }
+
+  goo_mont_mul4(mont, rp, ap, bp);
+
+  for (i = 1; i < GOO_TABLEN; i++) {
+    for (l = 0; l < GOO_LANES; l++) {
+      rp[l] = &out[l][i * limbs];
+      ap[l] = &out[l][(i - 1) * limbs];
+      bp[l] = b2[l];
+    }
+
+    goo_mont_mul4(mont, rp, ap, bp);
+  }
+}
+
+static const mp_limb_t *
+goo_group_lane_next(goo_group_t *group, goo_lane_t *lane, size_t i) {
+  /* Returns the next multiplicand for step `i` */
+  /* of the chain, or NULL if the lane is done. */
+  mp_size_t limbs = group->mont.limbs;
+  size_t aps = lane->gcomb->adds_per_shift;
+  size_t phases = 2 + 2 * aps;
+
+  while (lane->phase < phases) {
+    size_t phase = lane->phase++;
+    unsigned long u;
+    size_t j, k;
+    long w;
+
+    if (phase < 2) {
+      const mp_limb_t *p = phase == 0 ? lane->p1 : lane->p2;
+      const mp_limb_t *n = phase == 0 ? lane->n1 : lane->n2;
+      size_t off = phase == 0 ? lane->off1 : lane->off2;
+
+      if (i < off)
+        continue;
+
+      w = phase == 0 ? lane->wnaf1[i - off] : lane->wnaf2[i - off];
+
+      if (w > 0)
+        return &p[((w - 1) >> 1) * limbs];
+
+      if (w < 0)
+        return &n[((-1 - w) >> 1) * limbs];
+
+      continue;
+    }
+
+    if (i < lane->off3) {
+      lane->phase = phases;
+      break;
+    }
+
+    j = (phase - 2) >> 1;
+
+    if ((phase & 1) == 0) {
+      u = lane->gwins[(i - lane->off3) * aps + j];
+
+      if (u != 0) {
+        k = j * lane->gcomb->points_per_subcomb + u - 1;
+        return &lane->gcomb->items[k * limbs];
+      }
+    } else {
+      u = lane->hwins[(i - lane->off3) * aps + j];
+
+      if (u != 0) {
+        k = j * lane->hcomb->points_per_subcomb + u - 1;
+        return &lane->hcomb->items[k * limbs];
+      }
+    }
+  }
+
+  return NULL;
+}
+
+static int
+goo_group_multiexp4(goo_group_t *group,
+                    goo_scratch_t *scratch,
+                    mpz_ptr *ret,
+                    mpz_srcptr *b1,
+                    mpz_srcptr *b1i,
+                    mpz_srcptr *e1,
+                    mpz_srcptr *b2,
+                    mpz_srcptr *b2i,
+                    mpz_srcptr *e2,
+                    mpz_srcptr *e3,
+                    mpz_srcptr *e4) {
+  /* Compute b1[l]^e1[l] * b2[l]^e2[l] * g^e3[l] * h^e4[l] mod n
+   * for each of the GOO_LANES lanes.
+   *
+   * Every lane runs the same interleaved chain as
+   * goo_group_multiexp(), but the chains advance
+   * in lockstep: one squaring of every lane, then
+   * rounds of one multiplication per lane until
+   * each lane has consumed its digits for the
+   * step. Each round is a single call into the
+   * multi-buffer kernel.
+   *
+   * Both variable exponents are limited to
+   * GOO_ELL_BITS (as they are in verification).
+   */
+  goo_mont_t *mont = &group->mont;
+  mp_size_t limbs = mont->limbs;
+  size_t size = GOO_TABLEN * limbs;
+  mp_limb_t acc[GOO_LANES][GOO_MAX_LIMBS];
+  goo_lane_t lanes[GOO_LANES];
+  mp_limb_t *tables[4][GOO_LANES];
+  mp_limb_t *rp[GOO_LANES];
+  const mp_limb_t *ap[GOO_LANES];
+  const mp_limb_t *bp[GOO_LANES];
+  size_t len = 0;
+  size_t i, l;
+
+  if (limbs > scratch->limbs)
+    return 0;
+
+  for (l = 0; l < GOO_LANES; l++) {
+    goo_lane_t *lane = &lanes[l];
+    size_t bits1 = goo_mpz_bitlen(e1[l]) + 1;
+    size_t bits2 = goo_mpz_bitlen(e2[l]) + 1;
+    size_t bits3 = goo_mpz_bitlen(e3[l]);
+    size_t bits4 = goo_mpz_bitlen(e4[l]);
+    size_t bits = bits3 > bits4 ? bits3 : bits4;
+    size_t wins_len = scratch->wins_len;
+
+    if (bits1 > GOO_ELL_BITS + 1 || bits2 > GOO_ELL_BITS + 1)
+      return 0;
+
+    if (mpz_sgn(e1[l]) < 0 || mpz_sgn(e2[l]) < 0)
+      return 0;
+
+    lane->gcomb = NULL;
+    lane->hcomb = NULL;
+
+    for (i = 0; i < group->combs_len; i++) {
+      if (bits <= group->combs[i].g.bits) {
+        lane->gcomb = &group->combs[i].g;
+        lane->hcomb = &group->combs[i].h;
+        break;
+      }
+    }
+
+    if (lane->gcomb == NULL || lane->hcomb == NULL)
+      return 0;
+
+    if (lane->gcomb->shifts * lane->gcomb->adds_per_shift > wins_len)
+      return 0;
+
+    lane->gwins = &scratch->wins4[(2 * l + 0) * wins_len];
+    lane->hwins = &scratch->wins4[(2 * l + 1) * wins_len];
+
+    if (!goo_comb_recode(lane->gcomb, lane->gwins, e3[l]))
+      return 0;
+
+    if (!goo_comb_recode(lane->hcomb, lane->hwins, e4[l]))
+      return 0;
+
+    lane->wnaf1 = scratch->wnaf4[l][0];
+    lane->wnaf2 = scratch->wnaf4[l][1];
+
+    goo_group_wnaf(group, lane->wnaf1, e1[l], bits1);
+    goo_group_wnaf(group, lane->wnaf2, e2[l], bits2);
+
+    lane->p1 = &scratch->lanes[(4 * l + 0) * size];
+    lane->n1 = &scratch->lanes[(4 * l + 1) * size];
+    lane->p2 = &scratch->lanes[(4 * l + 2) * size];
+    lane->n2 = &scratch->lanes[(4 * l + 3) * size];
+
+    tables[0][l] = lane->p1;
+    tables[1][l] = lane->n1;
+    tables[2][l] = lane->p2;
+    tables[3][l] = lane->n2;
+
+    /* Temporarily store the digit counts. */
+    lane->off1 = bits1;
+    lane->off2 = bits2;
+    lane->off3 = lane->gcomb->shifts;
+
+    if (bits1 > len)
+      len = bits1;
+
+    if (bits2 > len)
+      len = bits2;
+
+    if (lane->off3 > len)
+      len = lane->off3;
+  }
+
+  goo_group_precomp_table4(group, tables[0], b1);
+  goo_group_precomp_table4(group, tables[1], b1i);
+  goo_group_precomp_table4(group, tables[2], b2);
+  goo_group_precomp_table4(group, tables[3], b2i);
+
+  for (l = 0; l < GOO_LANES; l++) {
+    goo_lane_t *lane = &lanes[l];
+
+    lane->off1 = len - lane->off1;
+    lane->off2 = len - lane->off2;
+    lane->off3 = len - lane->off3;
+
+    /* Squaring one is a no-op; skip it. */
+    lane->start = lane->off1;
+
+    if (lane->off2 < lane->start)
+      lane->start = lane->off2;
+
+    if (lane->off3 < lane->start)
+      lane->start = lane->off3;
+
+    mpn_copyi(acc[l], mont->one, limbs);
+
+    rp[l] = acc[l];
+    ap[l] = acc[l];
+  }
+
+  for (i = 0; i < len; i++) {
+    int more = 1;
+
+    for (l = 0; l < GOO_LANES; l++) {
+      lanes[l].phase = 0;
+      bp[l] = i > lanes[l].start ? acc[l] : NULL;
+    }
+
+    goo_mont_mul4(mont, rp, ap, bp);
+
+    while (more) {
+      more = 0;
+
+      for (l = 0; l < GOO_LANES; l++) {
+        bp[l] = goo_group_lane_next(group, &lanes[l], i);
+        more |= (bp[l] != NULL);
+      }
+
+      if (more)
+        goo_mont_mul4(mont, rp, ap, bp);
+    }
+  }
 
-  /* ret = a * b mod n */
-  goo_group_mul(group, ret, a, b);
+  for (l = 0; l < GOO_LANES; l++)
+    goo_group_from_mont(group, ret[l], acc[l]);
+
+  return 1;
+}
+
+static int
+goo_group_recover4(goo_group_t *group,
+                   goo_scratch_t *scratch,
+                   mpz_ptr *ret,
+                   mpz_srcptr *b1,
+                   mpz_srcptr *b1i,
+                   mpz_srcptr *e1,
+                   mpz_srcptr *b2,
+                   mpz_srcptr *b2i,
+                   mpz_srcptr *e2,
+                   mpz_srcptr *e3,
+                   mpz_srcptr *e4) {
+  /* Compute b1[l]^e1[l] * g^e3[l] * h^e4[l] / b2[l]^e2[l] mod n. */
+  size_t l;
+
+  if (!goo_group_multiexp4(group, scratch, ret, b1, b1i, e1,
+                           b2i, b2, e2, e3, e4)) {
+    return 0;
+  }
 
   /* ret = n - ret if ret > n / 2 */
-  goo_group_reduce(group, ret, ret);
+  for (l = 0; l < GOO_LANES; l++)
+    goo_group_reduce(group, ret[l], ret[l]);
 
-  r = 1;
-fail:
-  mpz_clear(a);
-  return r;
+  return 1;
 }
 
 static int
 goo_group_hash(goo_group_t *group,
+               goo_scratch_t *scratch,
                unsigned char *out,
                const mpz_t C1,
                const mpz_t C2,
@@ -2218,7 +4668,7 @@ goo_group_hash(goo_group_t *group,
                const mpz_t E,
                const unsigned char *msg,
                size_t msg_len) {
-  unsigned char *slab = group->slab;
+  unsigned char *slab = scratch->slab;
   size_t GOO_MOD_BYTES = group->size;
   unsigned char sign[GOO_INT_BYTES] = {0, 0, 0, 0};
   goo_sha256_t ctx;
@@ -2261,6 +4711,7 @@ fail:
 
 static int
 goo_group_derive(goo_group_t *group,
+                 goo_scratch_t *scratch,
                  mpz_t chal,
                  mpz_t ell,
                  unsigned char *key,
@@ -2275,21 +4726,159 @@ goo_group_derive(goo_group_t *group,
                  const mpz_t E,
                  const unsigned char *msg,
                  size_t msg_len) {
-  if (!goo_group_hash(group, key, C1, C2, C3, t, A, B, C, D, E, msg, msg_len))
+  if (!goo_group_hash(group, scratch, key, C1, C2, C3,
+                      t, A, B, C, D, E, msg, msg_len)) {
     return 0;
+  }
+
+  goo_prng_seed(&scratch->prng, key, &GOO_PRNG_DERIVE);
+  goo_prng_random_bits(&scratch->prng, chal, GOO_CHAL_BITS);
+  goo_prng_random_bits(&scratch->prng, ell, GOO_ELL_BITS);
+
+  return 1;
+}
+
+static size_t
+goo_group_hash_size(goo_group_t *group) {
+  /* C1, C2, C3, A, B, C, D, t, E, sign(E) */
+  return group->size * 7 + GOO_INT_BYTES * 2 + GOO_EXP_BYTES;
+}
+
+static int
+goo_group_hash_encode(goo_group_t *group,
+                      unsigned char *out,
+                      mpz_srcptr *items) {
+  /* Serializes the items hashed by goo_group_hash(): */
+  /* C1, C2, C3, t, A, B, C, D, E (in that order). */
+  static const int widths[9] = {0, 0, 0, 1, 0, 0, 0, 0, 2};
+  size_t i, size;
+
+  for (i = 0; i < 9; i++) {
+    if (widths[i] == 0)
+      size = group->size;
+    else if (widths[i] == 1)
+      size = GOO_INT_BYTES;
+    else
+      size = GOO_EXP_BYTES;
+
+    if (i < 8 && mpz_sgn(items[i]) < 0)
+      return 0;
+
+    if (!goo_pad_int(out, items[i], size))
+      return 0;
+
+    out += size;
+  }
+
+  memset(out, 0x00, GOO_INT_BYTES);
+
+  out[GOO_INT_BYTES - 1] = mpz_sgn(items[8]) < 0 ? 1 : 0;
+
+  return 1;
+}
+
+static void
+goo_group_hash_batch(goo_group_t *group,
+                     int *ok,
+                     unsigned char *keys,
+                     mpz_srcptr *items,
+                     const unsigned char *const *msgs,
+                     const size_t *msg_lens,
+                     size_t count) {
+  /* goo_group_hash() for `count` independent entries
+   * (9 items each, as in goo_group_hash_encode()).
+   *
+   * The entries are serialized up front and the
+   * streams handed to the multi-buffer SHA256,
+   * which compresses them side by side. Entries
+   * with a zero `ok` are skipped; entries which
+   * fail to encode have `ok` cleared.
+   */
+  size_t size = goo_group_hash_size(group);
+  unsigned char *slab = goo_malloc(count * size + 1);
+  goo_sha256_t *ctxs = goo_malloc((count + 1) * sizeof(goo_sha256_t));
+  const unsigned char **data = goo_calloc(count + 1, sizeof(unsigned char *));
+  size_t *lens = goo_calloc(count + 1, sizeof(size_t));
+  size_t *idx = goo_calloc(count + 1, sizeof(size_t));
+  size_t len = 0;
+  size_t i;
+
+  for (i = 0; i < count; i++) {
+    if (!ok[i])
+      continue;
+
+    if (!goo_group_hash_encode(group, &slab[len * size], &items[i * 9])) {
+      ok[i] = 0;
+      continue;
+    }
+
+    /* Copy the state of SHA256(prefix || SHA256(g || h || n)). */
+    memcpy(&ctxs[len], &group->sha, sizeof(goo_sha256_t));
+
+    data[len] = &slab[len * size];
+    lens[len] = size;
+    idx[len] = i;
+    len += 1;
+  }
+
+  goo_sha256_update_multi(ctxs, data, lens, len);
+
+  for (i = 0; i < len; i++) {
+    data[i] = msgs[idx[i]];
+    lens[i] = msg_lens[idx[i]];
+  }
+
+  goo_sha256_update_multi(ctxs, data, lens, len);
+
+  for (i = 0; i < len; i++)
+    goo_sha256_final(&ctxs[i], &keys[idx[i] * GOO_SHA256_HASH_SIZE]);
+
+  goo_cleanse(slab, count * size);
+  goo_cleanse(ctxs, count * sizeof(goo_sha256_t));
+
+  goo_free(slab);
+  goo_free(ctxs);
+  goo_free(data);
+  goo_free(lens);
+  goo_free(idx);
+}
+
+static void
+goo_group_derive_batch(goo_group_t *group,
+                       goo_scratch_t *scratch,
+                       int *ok,
+                       mpz_t *chals,
+                       mpz_t *ells,
+                       unsigned char *keys,
+                       mpz_srcptr *items,
+                       const unsigned char *const *msgs,
+                       const size_t *msg_lens,
+                       size_t count) {
+  /* goo_group_derive() for `count` entries. */
+  size_t i;
 
-  goo_prng_seed(&group->prng, key, GOO_PRNG_DERIVE);
-  goo_prng_random_bits(&group->prng, chal, GOO_CHAL_BITS);
-  goo_prng_random_bits(&group->prng, ell, GOO_ELL_BITS);
+  goo_group_hash_batch(group, ok, keys, items, msgs, msg_lens, count);
 
-  return 1;
+  for (i = 0; i < count; i++) {
+    if (!ok[i])
+      continue;
+
+    goo_prng_seed(&scratch->prng, &keys[i * GOO_SHA256_HASH_SIZE],
+                  &GOO_PRNG_DERIVE);
+
+    goo_prng_random_bits(&scratch->prng, chals[i], GOO_CHAL_BITS);
+    goo_prng_random_bits(&scratch->prng, ells[i], GOO_ELL_BITS);
+  }
 }
 
 static void
-goo_group_expand_sprime(goo_group_t *group, mpz_t s,
+goo_group_expand_sprime(goo_group_t *group,
+                        goo_scratch_t *scratch,
+                        mpz_t s,
                         const unsigned char *s_prime) {
-  goo_prng_seed(&group->prng, s_prime, GOO_PRNG_EXPAND);
-  goo_prng_random_bits(&group->prng, s, GOO_EXP_BITS);
+  (void)group;
+  goo_prng_seed(&scratch->prng, s_prime, &GOO_PRNG_EXPAND);
+  goo_prng_random_bits(&scratch->prng, s, GOO_EXP_BITS);
 }
 
 static void
@@ -2359,6 +4948,7 @@ goo_is_valid_exponent(const mpz_t e) {
 
 static int
 goo_group_challenge(goo_group_t *group,
+                    goo_scratch_t *scratch,
                     mpz_t C1,
                     const unsigned char *s_prime,
                     const mpz_t n) {
@@ -2372,13 +4962,13 @@ goo_group_challenge(goo_group_t *group,
     goto fail;
   }
 
-  goo_group_expand_sprime(group, s, s_prime);
+  goo_group_expand_sprime(group, scratch, s, s_prime);
 
   /* Commit to the RSA modulus:
    *
    *   C1 = g^n * h^s in G
    */
-  if (!goo_group_powgh(group, C1, n, s))
+  if (!goo_group_powgh(group, scratch, C1, n, s))
     goto fail;
 
   goo_group_reduce(group, C1, C1);
@@ -2391,6 +4981,7 @@ fail:
 
 static int
 goo_group_validate(goo_group_t *group,
+                   goo_scratch_t *scratch,
                    const unsigned char *s_prime,
                    const mpz_t C1,
                    const mpz_t p,
@@ -2421,9 +5012,9 @@ goo_group_validate(goo_group_t *group,
   if (!goo_is_valid_modulus(n))
     goto fail;
 
-  goo_group_expand_sprime(group, s, s_prime);
+  goo_group_expand_sprime(group, scratch, s, s_prime);
 
-  if (!goo_group_powgh(group, x, n, s))
+  if (!goo_group_powgh(group, scratch, x, n, s))
     goto fail;
 
   goo_group_reduce(group, x, x);
@@ -2436,113 +5027,467 @@ fail:
   goo_mpz_clear(n);
   goo_mpz_clear(s);
   goo_mpz_clear(x);
-  goo_group_cleanse(group);
+  goo_scratch_cleanse(scratch);
   return r;
 }
 
+/* A wave of independent exponentiations, each */
+/* producing either g^e2 * h^e3 (b1 == NULL) or */
+/* b1^e1 * g^e2 * h^e3, reduced. The latter uses */
+/* combs for `b1` when they are available. */
+typedef struct goo_exp_job_s {
+  mpz_ptr ret;
+  const goo_comb_t *bcombs;
+  mpz_srcptr b1;
+  mpz_srcptr b1i;
+  mpz_srcptr e1;
+  mpz_srcptr e2;
+  mpz_srcptr e3;
+  int ok;
+} goo_exp_job_t;
+
+typedef struct goo_exp_wave_s {
+  goo_group_t *group;
+  goo_scratch_t **scratch;
+  goo_exp_job_t *jobs;
+} goo_exp_wave_t;
+
+static void
+goo_exp_job_set(goo_exp_job_t *job,
+                mpz_ptr ret,
+                const goo_comb_t *bcombs,
+                mpz_srcptr b1,
+                mpz_srcptr b1i,
+                mpz_srcptr e1,
+                mpz_srcptr e2,
+                mpz_srcptr e3) {
+  job->ret = ret;
+  job->bcombs = bcombs;
+  job->b1 = b1;
+  job->b1i = b1i;
+  job->e1 = e1;
+  job->e2 = e2;
+  job->e3 = e3;
+  job->ok = 0;
+}
+
+static void
+goo_exp_wave_work(void *arg, size_t index, size_t thread) {
+  goo_exp_wave_t *wave = (goo_exp_wave_t *)arg;
+  goo_exp_job_t *job = &wave->jobs[index];
+  goo_scratch_t *scratch = wave->scratch[thread];
+
+  if (job->b1 == NULL) {
+    job->ok = goo_group_powgh(wave->group, scratch, job->ret,
+                              job->e2, job->e3);
+  } else {
+    job->ok = 0;
+
+    if (job->bcombs != NULL) {
+      job->ok = goo_group_powbgh(wave->group, scratch, job->ret,
+                                 job->bcombs, job->e1, job->e2, job->e3);
+    }
+
+    if (!job->ok) {
+      job->ok = goo_group_multiexp(wave->group, scratch, job->ret,
+                                   job->b1, job->b1i, job->e1,
+                                   NULL, NULL, NULL, job->e2, job->e3);
+    }
+  }
+
+  if (job->ok)
+    goo_group_reduce(wave->group, job->ret, job->ret);
+}
+
 static int
-goo_group_sign(goo_group_t *group,
-               goo_sig_t *S,
-               const unsigned char *msg,
-               size_t msg_len,
-               const unsigned char *s_prime,
-               const mpz_t p,
-               const mpz_t q) {
-  int r = 0;
-  int found;
-  unsigned long primes[GOO_PRIMES_LEN];
+goo_group_exp_wave(goo_group_t *group,
+                   goo_scratch_t **scratch,
+                   size_t threads,
+                   goo_exp_job_t *jobs,
+                   size_t count) {
+  /* Run the jobs on up to `threads` threads, */
+  /* one scratch per thread. With one thread */
+  /* they simply run in order. */
+  goo_exp_wave_t wave;
+  size_t i;
+
+  wave.group = group;
+  wave.scratch = scratch;
+  wave.jobs = jobs;
+
+  goo_pool_run(threads, count, goo_exp_wave_work, &wave);
+
+  for (i = 0; i < count; i++) {
+    if (!jobs[i].ok)
+      return 0;
+  }
+
+  return 1;
+}
+
+/* One guess at `A` in the signer's `ell` loop. */
+typedef struct goo_ell_try_s {
+  mpz_t r_s1;
+  mpz_t A;
+  mpz_t chal;
+  mpz_t ell;
   unsigned char key[GOO_SHA256_HASH_SIZE];
-  goo_prng_t prng;
-  unsigned long i;
+  int ok;
+} goo_ell_try_t;
+
+typedef struct goo_ell_search_s {
+  goo_group_t *group;
+  goo_scratch_t **scratch;
+  goo_ell_try_t *tries;
+  mpz_srcptr zero;
+  mpz_srcptr gw;
+  mpz_srcptr items[8]; /* C1, C2, C3, t, B, C, D, E */
+  const unsigned char *msg;
+  size_t msg_len;
+} goo_ell_search_t;
 
-  mpz_t n, s, C1, w, a, s1, s2;
-  mpz_t t1, t2, t3, t4, t5;
-  mpz_t C1i, C2i;
-  mpz_t r_w, r_w2, r_s1, r_a, r_an, r_s1w, r_sa, r_s2;
-  mpz_t A, B, C, D, E;
+static int
+goo_ell_search_derive(goo_ell_search_t *search,
+                      goo_ell_try_t *guess,
+                      goo_scratch_t *scratch) {
+  /* chal, ell = H(..., A, ...), for a known `A` */
+  mpz_srcptr *x = search->items;
+
+  if (!goo_group_derive(search->group, scratch,
+                        guess->chal, guess->ell, guess->key,
+                        x[0], x[1], x[2], x[3], guess->A,
+                        x[4], x[5], x[6], x[7],
+                        search->msg, search->msg_len)) {
+    return 0;
+  }
 
-  mpz_t *C2 = &S->C2;
-  mpz_t *C3 = &S->C3;
-  mpz_t *t = &S->t;
-  mpz_t *chal = &S->chal;
-  mpz_t *ell = &S->ell;
-  mpz_t *Aq = &S->Aq;
-  mpz_t *Bq = &S->Bq;
-  mpz_t *Cq = &S->Cq;
-  mpz_t *Dq = &S->Dq;
-  mpz_t *Eq = &S->Eq;
-  mpz_t *z_w = &S->z_w;
-  mpz_t *z_w2 = &S->z_w2;
-  mpz_t *z_s1 = &S->z_s1;
-  mpz_t *z_a = &S->z_a;
-  mpz_t *z_an = &S->z_an;
-  mpz_t *z_s1w = &S->z_s1w;
-  mpz_t *z_sa = &S->z_sa;
-  mpz_t *z_s2 = &S->z_s2;
+  if (!goo_next_prime(guess->ell, guess->ell, guess->key, GOO_ELLDIFF_MAX))
+    mpz_set_ui(guess->ell, 0);
 
-  goo_prng_init(&prng);
+  return 1;
+}
 
-  mpz_init(n);
-  mpz_init(s);
-  mpz_init(C1);
-  mpz_init(w);
-  mpz_init(a);
-  mpz_init(s1);
-  mpz_init(s2);
-  mpz_init(t1);
-  mpz_init(t2);
-  mpz_init(t3);
-  mpz_init(t4);
-  mpz_init(t5);
-  mpz_init(C1i);
-  mpz_init(C2i);
-  mpz_init(r_w);
-  mpz_init(r_w2);
-  mpz_init(r_s1);
-  mpz_init(r_a);
-  mpz_init(r_an);
-  mpz_init(r_s1w);
-  mpz_init(r_sa);
-  mpz_init(r_s2);
-  mpz_init(A);
-  mpz_init(B);
-  mpz_init(C);
-  mpz_init(D);
-  mpz_init(E);
+static void
+goo_ell_search_work(void *arg, size_t index, size_t thread) {
+  /* A = g^r_w * h^r_s1, from a cached g^r_w */
+  goo_ell_search_t *search = (goo_ell_search_t *)arg;
+  goo_ell_try_t *guess = &search->tries[index];
+  goo_group_t *group = search->group;
+  goo_scratch_t *scratch = search->scratch[thread];
+
+  guess->ok = 0;
+
+  if (!goo_group_powgh(group, scratch, guess->A, search->zero, guess->r_s1))
+    return;
+
+  goo_group_mul(group, guess->A, guess->A, search->gw);
+  goo_group_reduce(group, guess->A, guess->A);
+
+  guess->ok = goo_ell_search_derive(search, guess, scratch);
+}
+
+/*
+ * Signer
+ */
+
+static void
+goo_signer_uninit(goo_signer_t *signer);
+
+static int
+goo_signer_init(goo_signer_t *signer,
+                goo_group_t *group,
+                goo_scratch_t *scratch,
+                const unsigned char *s_prime,
+                const mpz_t p,
+                const mpz_t q,
+                int precompute) {
+  /* Key state for goo_group_sign(). With `precompute`, */
+  /* everything that depends on the key alone is cached */
+  /* as well: C1 and its inverse, the square roots of */
+  /* the small primes, and combs for C1^-1. */
+  unsigned char qr[GOO_PRIMES_LEN];
+  goo_combspec_t spec;
+  mpz_t t;
+  size_t i;
+
+  signer->group = group;
+  signer->precomputed = 0;
+  signer->roots = NULL;
+  signer->combs_len = 0;
+  signer->presigned = 0;
+
+  memcpy(signer->s_prime, s_prime, 32);
+
+  mpz_init(signer->p);
+  mpz_init(signer->q);
+  mpz_init(signer->n);
+  mpz_init(signer->s);
+  mpz_init(signer->C1);
+  mpz_init(signer->C1i);
+  mpz_init(t);
 
   if (!goo_is_valid_prime(p) || !goo_is_valid_prime(q)) {
     /* Invalid RSA public key. */
     goto fail;
   }
 
-  mpz_mul(n, p, q);
+  mpz_set(signer->p, p);
+  mpz_set(signer->q, q);
+  mpz_mul(signer->n, p, q);
 
-  if (!goo_is_valid_modulus(n)) {
+  if (!goo_is_valid_modulus(signer->n)) {
     /* Invalid RSA public key. */
     goto fail;
   }
 
-  /* Seed the PRNG using the primes and message as entropy. */
-  if (!goo_prng_seed_sign(&prng, p, q, s_prime, msg, msg_len, group->slab))
+  goo_group_expand_sprime(group, scratch, signer->s, s_prime);
+
+  if (!precompute) {
+    mpz_clear(t);
+    return 1;
+  }
+
+  /* C1 = g^n * h^s in G */
+  if (!goo_group_powgh(group, scratch, signer->C1, signer->n, signer->s))
     goto fail;
 
-  /* Find a small quadratic residue prime `t`. */
-  found = 0;
+  goo_group_reduce(group, signer->C1, signer->C1);
+
+  if (!goo_group_inv(group, signer->C1i, signer->C1))
+    goto fail;
+
+  /* roots[i] = goo_primes[i]^(1 / 2) in F(p * q) */
+  signer->roots = goo_calloc(GOO_PRIMES_LEN, sizeof(mpz_t));
+
+  for (i = 0; i < GOO_PRIMES_LEN; i++)
+    mpz_init(signer->roots[i]);
+
+  goo_primes_qr(qr, p, q);
+
+  for (i = 0; i < GOO_PRIMES_LEN; i++) {
+    if (!qr[i])
+      continue;
+
+    mpz_set_ui(t, goo_primes[i]);
+
+    if (!goo_mpz_sqrtpq(signer->roots[i], t, p, q))
+      mpz_set_ui(signer->roots[i], 0);
+  }
+
+  goo_cleanse(qr, sizeof(qr));
+
+  /* Combs for C1^-1 mirror the group's g combs, so */
+  /* that goo_group_powbgh() can walk all three. */
+  for (i = 0; i < group->combs_len; i++) {
+    goo_comb_t *gcomb = &group->combs[i].g;
+
+    spec.points_per_add = gcomb->points_per_add;
+    spec.adds_per_shift = gcomb->adds_per_shift;
+    spec.shifts = gcomb->shifts;
+    spec.bits_per_window = gcomb->bits_per_window;
+    spec.size = gcomb->size;
+
+    goo_comb_init(&signer->combs[i], group, signer->C1i, &spec);
+
+    signer->combs_len = i + 1;
+  }
+
+  signer->precomputed = 1;
+
+  mpz_clear(t);
+
+  return 1;
+fail:
+  mpz_clear(t);
+  goo_signer_uninit(signer);
+  return 0;
+}
+
+static void
+goo_signer_uninit(goo_signer_t *signer) {
+  size_t i;
+
+  goo_mpz_clear(signer->p);
+  goo_mpz_clear(signer->q);
+  goo_mpz_clear(signer->n);
+  goo_mpz_clear(signer->s);
+  goo_mpz_clear(signer->C1);
+  goo_mpz_clear(signer->C1i);
+
+  if (signer->roots != NULL) {
+    for (i = 0; i < GOO_PRIMES_LEN; i++)
+      goo_mpz_clear(signer->roots[i]);
+
+    goo_free(signer->roots);
+  }
+
+  for (i = 0; i < signer->combs_len; i++)
+    goo_comb_uninit(&signer->combs[i]);
+
+  goo_cleanse(signer->s_prime, sizeof(signer->s_prime));
+
+  signer->group = NULL;
+  signer->precomputed = 0;
+  signer->roots = NULL;
+  signer->combs_len = 0;
+}
+
+static void
+goo_presig_init(goo_presig_t *ps) {
+  goo_prng_init(&ps->prng);
+
+  ps->has_A = 0;
+
+  mpz_init(ps->C1);
+  mpz_init(ps->C1i);
+  mpz_init(ps->C2);
+  mpz_init(ps->C2i);
+  mpz_init(ps->C3);
+  mpz_init(ps->t);
+  mpz_init(ps->w);
+  mpz_init(ps->a);
+  mpz_init(ps->s1);
+  mpz_init(ps->s2);
+  mpz_init(ps->r_w);
+  mpz_init(ps->r_w2);
+  mpz_init(ps->r_s1);
+  mpz_init(ps->r_a);
+  mpz_init(ps->r_an);
+  mpz_init(ps->r_s1w);
+  mpz_init(ps->r_sa);
+  mpz_init(ps->r_s2);
+  mpz_init(ps->A);
+  mpz_init(ps->B);
+  mpz_init(ps->C);
+  mpz_init(ps->D);
+  mpz_init(ps->E);
+  mpz_init(ps->gw);
+}
+
+static void
+goo_presig_uninit(goo_presig_t *ps) {
+  goo_prng_uninit(&ps->prng);
+
+  goo_mpz_clear(ps->C1);
+  goo_mpz_clear(ps->C1i);
+  goo_mpz_clear(ps->C2);
+  goo_mpz_clear(ps->C2i);
+  goo_mpz_clear(ps->C3);
+  goo_mpz_clear(ps->t);
+  goo_mpz_clear(ps->w);
+  goo_mpz_clear(ps->a);
+  goo_mpz_clear(ps->s1);
+  goo_mpz_clear(ps->s2);
+  goo_mpz_clear(ps->r_w);
+  goo_mpz_clear(ps->r_w2);
+  goo_mpz_clear(ps->r_s1);
+  goo_mpz_clear(ps->r_a);
+  goo_mpz_clear(ps->r_an);
+  goo_mpz_clear(ps->r_s1w);
+  goo_mpz_clear(ps->r_sa);
+  goo_mpz_clear(ps->r_s2);
+  goo_mpz_clear(ps->A);
+  goo_mpz_clear(ps->B);
+  goo_mpz_clear(ps->C);
+  goo_mpz_clear(ps->D);
+  goo_mpz_clear(ps->E);
+  goo_mpz_clear(ps->gw);
+
+  goo_cleanse(&ps->prng, sizeof(goo_prng_t));
+
+  ps->has_A = 0;
+}
+
+static size_t
+goo_scratch_pool_create(goo_group_t *group,
+                        goo_scratch_t *scratch,
+                        goo_scratch_t **pool,
+                        size_t threads) {
+  /* One scratch for each of up to five threads, */
+  /* the first being the caller's. */
+  size_t i;
+
+  threads = goo_pool_threads(threads, 5);
+
+  pool[0] = scratch;
+
+  for (i = 1; i < threads; i++)
+    pool[i] = goo_scratch_create(group);
+
+  return threads;
+}
+
+static void
+goo_scratch_pool_destroy(goo_scratch_t **pool, size_t threads) {
+  size_t i;
+
+  for (i = 1; i < threads; i++)
+    goo_scratch_destroy(pool[i]);
+}
+
+static int
+goo_signer_commit(goo_signer_t *signer,
+                  goo_scratch_t **pool,
+                  size_t threads,
+                  goo_presig_t *ps,
+                  int presign) {
+  /* Everything up to the challenge that does not */
+  /* depend on the message, drawn from `ps->prng`. */
+  /* A presignature also makes its first guess at */
+  /* `A` here, ahead of the message. */
+  goo_group_t *group = signer->group;
+  const goo_comb_t *bcombs = NULL;
+  mpz_srcptr p = signer->p;
+  mpz_srcptr q = signer->q;
+  mpz_srcptr n = signer->n;
+  mpz_srcptr s = signer->s;
+  unsigned long order[GOO_PRIMES_LEN];
+  unsigned char qr[GOO_PRIMES_LEN];
+  goo_exp_job_t jobs[5];
+  unsigned long i, k;
+  int found = 0;
+  int r = 0;
+  mpz_t t1, t2, zero;
+
+  mpz_init(t1);
+  mpz_init(t2);
+  mpz_init(zero);
+
+  if (signer->precomputed) {
+    mpz_set(ps->C1, signer->C1);
+    mpz_set(ps->C1i, signer->C1i);
+    bcombs = signer->combs;
+  }
 
-  memcpy(primes, goo_primes, sizeof(goo_primes));
+  /* Find a small quadratic residue prime `t`. The */
+  /* Legendre symbols of every candidate are cheap, */
+  /* so only the chosen one needs its square root. */
+  if (!signer->precomputed)
+    goo_primes_qr(qr, p, q);
+
+  for (i = 0; i < GOO_PRIMES_LEN; i++)
+    order[i] = i;
 
   for (i = 0; i < GOO_PRIMES_LEN; i++) {
     /* Fisher-Yates shuffle to choose random `t`. */
-    unsigned long j = goo_prng_random_num(&prng, GOO_PRIMES_LEN - i);
+    unsigned long j = goo_prng_random_num(&ps->prng, GOO_PRIMES_LEN - i);
 
-    goo_swap(&primes[i], &primes[i + j]);
+    goo_swap(&order[i], &order[i + j]);
 
-    mpz_set_ui(*t, primes[i]);
+    mpz_set_ui(ps->t, goo_primes[order[i]]);
 
     /* w = t^(1 / 2) in F(p * q) */
-    if (goo_mpz_sqrtpq(w, *t, p, q)) {
-      found = 1;
-      break;
+    if (signer->precomputed) {
+      if (mpz_sgn(signer->roots[order[i]]) > 0) {
+        mpz_set(ps->w, signer->roots[order[i]]);
+        found = 1;
+        break;
+      }
+    } else if (qr[order[i]]) {
+      if (goo_mpz_sqrtpq(ps->w, ps->t, p, q)) {
+        found = 1;
+        break;
+      }
     }
   }
 
@@ -2551,19 +5496,19 @@ goo_group_sign(goo_group_t *group,
     goto fail;
   }
 
-  ASSERT(mpz_sgn(w) > 0);
+  ASSERT(mpz_sgn(ps->w) > 0);
 
   /* a = (w^2 - t) / n */
-  mpz_mul(a, w, w);
-  mpz_sub(a, a, *t);
-  mpz_fdiv_q(a, a, n);
+  mpz_mul(ps->a, ps->w, ps->w);
+  mpz_sub(ps->a, ps->a, ps->t);
+  mpz_fdiv_q(ps->a, ps->a, n);
 
-  ASSERT(mpz_sgn(a) >= 0);
+  ASSERT(mpz_sgn(ps->a) >= 0);
 
   /* `w` and `a` must satisfy `w^2 = t + a * n`. */
-  mpz_mul(t1, a, n);
-  mpz_mul(t2, w, w);
-  mpz_sub(t2, t2, *t);
+  mpz_mul(t1, ps->a, n);
+  mpz_mul(t2, ps->w, ps->w);
+  mpz_sub(t2, t2, ps->t);
 
   if (mpz_cmp(t1, t2) != 0) {
     /* `w^2 - t` was not divisible by `n`! */
@@ -2579,40 +5524,21 @@ goo_group_sign(goo_group_t *group,
    * Where `s`, `s1`, and `s2` are
    * random 2048-bit integers.
    */
-  goo_group_expand_sprime(group, s, s_prime);
-
-  if (!goo_group_powgh(group, C1, n, s))
-    goto fail;
-
-  goo_group_reduce(group, C1, C1);
-
-  goo_group_random_scalar(group, &prng, s1);
-
-  if (!goo_group_powgh(group, *C2, w, s1))
-    goto fail;
-
-  goo_group_reduce(group, *C2, *C2);
-
-  goo_group_random_scalar(group, &prng, s2);
-
-  if (!goo_group_powgh(group, *C3, a, s2))
-    goto fail;
-
-  goo_group_reduce(group, *C3, *C3);
-
-  /* Inverses of `C1` and `C2`. */
-  if (!goo_group_inv2(group, C1i, C2i, C1, *C2))
-    goto fail;
+  goo_group_random_scalar(group, &ps->prng, ps->s1);
+  goo_group_random_scalar(group, &ps->prng, ps->s2);
 
   /* Eight random 2048-bit integers: */
   /*   r_w, r_w2, r_s1, r_a, r_an, r_s1w, r_sa, r_s2 */
-  goo_group_random_scalar(group, &prng, r_w);
-  goo_group_random_scalar(group, &prng, r_w2);
-  goo_group_random_scalar(group, &prng, r_a);
-  goo_group_random_scalar(group, &prng, r_an);
-  goo_group_random_scalar(group, &prng, r_s1w);
-  goo_group_random_scalar(group, &prng, r_sa);
-  goo_group_random_scalar(group, &prng, r_s2);
+  goo_group_random_scalar(group, &ps->prng, ps->r_w);
+  goo_group_random_scalar(group, &ps->prng, ps->r_w2);
+  goo_group_random_scalar(group, &ps->prng, ps->r_a);
+  goo_group_random_scalar(group, &ps->prng, ps->r_an);
+  goo_group_random_scalar(group, &ps->prng, ps->r_s1w);
+  goo_group_random_scalar(group, &ps->prng, ps->r_sa);
+  goo_group_random_scalar(group, &ps->prng, ps->r_s2);
+
+  if (presign)
+    goo_group_random_scalar(group, &ps->prng, ps->r_s1);
 
   /* Compute:
    *
@@ -2622,52 +5548,191 @@ goo_group_sign(goo_group_t *group,
    *   D = g^r_an * h^r_sa / C1^r_a in G
    *   E = r_w2 - r_an
    *
-   * `A` must be recomputed until a prime
-   * `ell` is found within range.
+   * `A` must be recomputed with a new `r_s1`
+   * until a prime `ell` is found within range,
+   * so `g^r_w` is computed once and kept.
+   *
+   * C1, C2, C3, B and g^r_w are independent
+   * of each other (C1 may be cached). C and D
+   * need the inverses of C2 and C1.
    */
-  if (!goo_group_powgh(group, B, r_a, r_s2))
-    goto fail;
+  k = 0;
 
-  goo_group_reduce(group, B, B);
+  if (!signer->precomputed)
+    goo_exp_job_set(&jobs[k++], ps->C1, NULL, NULL, NULL, NULL, n, s);
 
-  goo_group_pow(group, t1, C2i, *C2, r_w);
+  goo_exp_job_set(&jobs[k++], ps->C2, NULL, NULL, NULL, NULL, ps->w, ps->s1);
+  goo_exp_job_set(&jobs[k++], ps->C3, NULL, NULL, NULL, NULL, ps->a, ps->s2);
+  goo_exp_job_set(&jobs[k++], ps->B, NULL, NULL, NULL, NULL,
+                  ps->r_a, ps->r_s2);
+  goo_exp_job_set(&jobs[k++], ps->gw, NULL, NULL, NULL, NULL, ps->r_w, zero);
 
-  if (!goo_group_powgh(group, t2, r_w2, r_s1w))
+  if (!goo_group_exp_wave(group, pool, threads, jobs, k))
     goto fail;
 
-  goo_group_mul(group, C, t1, t2);
-  goo_group_reduce(group, C, C);
+  /* Inverses of `C1` and `C2`. */
+  if (signer->precomputed) {
+    if (!goo_group_inv(group, ps->C2i, ps->C2))
+      goto fail;
+  } else {
+    if (!goo_group_inv2(group, ps->C1i, ps->C2i, ps->C1, ps->C2))
+      goto fail;
+  }
+
+  k = 0;
+
+  goo_exp_job_set(&jobs[k++], ps->C, NULL, ps->C2i, ps->C2,
+                  ps->r_w, ps->r_w2, ps->r_s1w);
+  goo_exp_job_set(&jobs[k++], ps->D, bcombs, ps->C1i, ps->C1,
+                  ps->r_a, ps->r_an, ps->r_sa);
 
-  goo_group_pow(group, t1, C1i, C1, r_a);
+  if (presign) {
+    goo_exp_job_set(&jobs[k++], ps->A, NULL, NULL, NULL, NULL,
+                    ps->r_w, ps->r_s1);
+  }
 
-  if (!goo_group_powgh(group, t2, r_an, r_sa))
+  if (!goo_group_exp_wave(group, pool, threads, jobs, k))
     goto fail;
 
-  goo_group_mul(group, D, t1, t2);
-  goo_group_reduce(group, D, D);
+  mpz_sub(ps->E, ps->r_w2, ps->r_an);
+
+  ps->has_A = presign;
+
+  r = 1;
+fail:
+  goo_mpz_clear(t1);
+  goo_mpz_clear(t2);
+  mpz_clear(zero);
+  goo_cleanse(order, sizeof(order));
+  goo_cleanse(qr, sizeof(qr));
+  goo_cleanse(&i, sizeof(i));
+  return r;
+}
+
+static int
+goo_signer_challenge(goo_signer_t *signer,
+                     goo_scratch_t **pool,
+                     size_t threads,
+                     goo_presig_t *ps,
+                     goo_sig_t *S,
+                     const unsigned char *msg,
+                     size_t msg_len) {
+  /* Each round draws the next `threads` values */
+  /* of `r_s1` and keeps the first one that */
+  /* yields an `ell`, as the serial loop would. */
+  /* A presigned guess at `A` is tried first. */
+  goo_group_t *group = signer->group;
+  goo_ell_search_t search;
+  goo_ell_try_t *tries;
+  int found = 0;
+  int r = 0;
+  size_t i = 0;
+  mpz_t zero;
 
-  mpz_sub(E, r_w2, r_an);
+  mpz_init(zero);
 
-  mpz_set_ui(*ell, 0);
+  tries = goo_calloc(threads, sizeof(goo_ell_try_t));
 
-  while (goo_mpz_bitlen(*ell) != GOO_ELL_BITS) {
-    goo_group_random_scalar(group, &prng, r_s1);
+  for (i = 0; i < threads; i++) {
+    mpz_init(tries[i].r_s1);
+    mpz_init(tries[i].A);
+    mpz_init(tries[i].chal);
+    mpz_init(tries[i].ell);
+  }
 
-    if (!goo_group_powgh(group, A, r_w, r_s1))
+  search.group = group;
+  search.scratch = pool;
+  search.tries = tries;
+  search.zero = zero;
+  search.gw = ps->gw;
+  search.items[0] = ps->C1;
+  search.items[1] = ps->C2;
+  search.items[2] = ps->C3;
+  search.items[3] = ps->t;
+  search.items[4] = ps->B;
+  search.items[5] = ps->C;
+  search.items[6] = ps->D;
+  search.items[7] = ps->E;
+  search.msg = msg;
+  search.msg_len = msg_len;
+
+  i = 0;
+
+  if (ps->has_A) {
+    mpz_set(tries[0].r_s1, ps->r_s1);
+    mpz_set(tries[0].A, ps->A);
+
+    if (!goo_ell_search_derive(&search, &tries[0], pool[0]))
       goto fail;
 
-    goo_group_reduce(group, A, A);
+    found = (goo_mpz_bitlen(tries[0].ell) == GOO_ELL_BITS);
+  }
+
+  while (!found) {
+    for (i = 0; i < threads; i++)
+      goo_group_random_scalar(group, &ps->prng, tries[i].r_s1);
 
-    if (!goo_group_derive(group,
-                          *chal, *ell, key, C1, *C2, *C3,
-                          *t, A, B, C, D, E, msg, msg_len)) {
-      goto fail;
+    goo_pool_run(threads, threads, goo_ell_search_work, &search);
+
+    for (i = 0; i < threads; i++) {
+      if (!tries[i].ok)
+        goto fail;
+
+      if (goo_mpz_bitlen(tries[i].ell) == GOO_ELL_BITS) {
+        found = 1;
+        break;
+      }
     }
+  }
 
-    if (!goo_next_prime(*ell, *ell, key, GOO_ELLDIFF_MAX))
-      mpz_set_ui(*ell, 0);
+  mpz_swap(ps->r_s1, tries[i].r_s1);
+  mpz_swap(ps->A, tries[i].A);
+  mpz_swap(S->chal, tries[i].chal);
+  mpz_swap(S->ell, tries[i].ell);
+
+  r = 1;
+fail:
+  for (i = 0; i < threads; i++) {
+    goo_mpz_clear(tries[i].r_s1);
+    goo_mpz_clear(tries[i].A);
+    goo_mpz_clear(tries[i].chal);
+    goo_mpz_clear(tries[i].ell);
   }
 
+  goo_cleanse(tries, threads * sizeof(goo_ell_try_t));
+  goo_free(tries);
+
+  mpz_clear(zero);
+
+  return r;
+}
+
+static int
+goo_signer_respond(goo_signer_t *signer,
+                   goo_scratch_t **pool,
+                   size_t threads,
+                   goo_presig_t *ps,
+                   goo_sig_t *S) {
+  goo_group_t *group = signer->group;
+  const goo_comb_t *bcombs = NULL;
+  mpz_srcptr n = signer->n;
+  mpz_srcptr s = signer->s;
+  goo_exp_job_t jobs[4];
+
+  mpz_t *chal = &S->chal;
+  mpz_t *ell = &S->ell;
+  mpz_t *z_w = &S->z_w;
+  mpz_t *z_w2 = &S->z_w2;
+  mpz_t *z_s1 = &S->z_s1;
+  mpz_t *z_a = &S->z_a;
+  mpz_t *z_an = &S->z_an;
+  mpz_t *z_s1w = &S->z_s1w;
+  mpz_t *z_sa = &S->z_sa;
+  mpz_t *z_s2 = &S->z_s2;
+
+  if (signer->precomputed)
+    bcombs = signer->combs;
+
   /* Compute the integer vector `z`:
    *
    *   z_w = chal * w + r_w
@@ -2679,33 +5744,33 @@ goo_group_sign(goo_group_t *group,
    *   z_sa = chal * s * a + r_sa
    *   z_s2 = chal * s2 + r_s2
    */
-  mpz_mul(*z_w, *chal, w);
-  mpz_add(*z_w, *z_w, r_w);
+  mpz_mul(*z_w, *chal, ps->w);
+  mpz_add(*z_w, *z_w, ps->r_w);
 
-  mpz_mul(*z_w2, *chal, w);
-  mpz_mul(*z_w2, *z_w2, w);
-  mpz_add(*z_w2, *z_w2, r_w2);
+  mpz_mul(*z_w2, *chal, ps->w);
+  mpz_mul(*z_w2, *z_w2, ps->w);
+  mpz_add(*z_w2, *z_w2, ps->r_w2);
 
-  mpz_mul(*z_s1, *chal, s1);
-  mpz_add(*z_s1, *z_s1, r_s1);
+  mpz_mul(*z_s1, *chal, ps->s1);
+  mpz_add(*z_s1, *z_s1, ps->r_s1);
 
-  mpz_mul(*z_a, *chal, a);
-  mpz_add(*z_a, *z_a, r_a);
+  mpz_mul(*z_a, *chal, ps->a);
+  mpz_add(*z_a, *z_a, ps->r_a);
 
-  mpz_mul(*z_an, *chal, a);
+  mpz_mul(*z_an, *chal, ps->a);
   mpz_mul(*z_an, *z_an, n);
-  mpz_add(*z_an, *z_an, r_an);
+  mpz_add(*z_an, *z_an, ps->r_an);
 
-  mpz_mul(*z_s1w, *chal, s1);
-  mpz_mul(*z_s1w, *z_s1w, w);
-  mpz_add(*z_s1w, *z_s1w, r_s1w);
+  mpz_mul(*z_s1w, *chal, ps->s1);
+  mpz_mul(*z_s1w, *z_s1w, ps->w);
+  mpz_add(*z_s1w, *z_s1w, ps->r_s1w);
 
   mpz_mul(*z_sa, *chal, s);
-  mpz_mul(*z_sa, *z_sa, a);
-  mpz_add(*z_sa, *z_sa, r_sa);
+  mpz_mul(*z_sa, *z_sa, ps->a);
+  mpz_add(*z_sa, *z_sa, ps->r_sa);
 
-  mpz_mul(*z_s2, *chal, s2);
-  mpz_add(*z_s2, *z_s2, r_s2);
+  mpz_mul(*z_s2, *chal, ps->s2);
+  mpz_add(*z_s2, *z_s2, ps->r_s2);
 
   /* Compute quotient commitments:
    *
@@ -2714,105 +5779,170 @@ goo_group_sign(goo_group_t *group,
    *   Cq = g^(z_w2 / ell) * h^(z_s1w / ell) / C2^(z_w / ell) in G
    *   Dq = g^(z_an / ell) * h^(z_sa  / ell) / C1^(z_a / ell) in G
    *   Eq = (z_w2 - z_an) / ell
+   *
+   * The quotients of `z` by `ell` are kept
+   * in `r_*`, which are no longer needed.
    */
-  mpz_fdiv_q(t1, *z_w, *ell);
-  mpz_fdiv_q(t2, *z_s1, *ell);
+  mpz_fdiv_q(ps->r_w, *z_w, *ell);
+  mpz_fdiv_q(ps->r_w2, *z_w2, *ell);
+  mpz_fdiv_q(ps->r_s1, *z_s1, *ell);
+  mpz_fdiv_q(ps->r_a, *z_a, *ell);
+  mpz_fdiv_q(ps->r_an, *z_an, *ell);
+  mpz_fdiv_q(ps->r_s1w, *z_s1w, *ell);
+  mpz_fdiv_q(ps->r_sa, *z_sa, *ell);
+  mpz_fdiv_q(ps->r_s2, *z_s2, *ell);
+
+  goo_exp_job_set(&jobs[0], S->Aq, NULL, NULL, NULL, NULL,
+                  ps->r_w, ps->r_s1);
+  goo_exp_job_set(&jobs[1], S->Bq, NULL, NULL, NULL, NULL,
+                  ps->r_a, ps->r_s2);
+  goo_exp_job_set(&jobs[2], S->Cq, NULL, ps->C2i, ps->C2,
+                  ps->r_w, ps->r_w2, ps->r_s1w);
+  goo_exp_job_set(&jobs[3], S->Dq, bcombs, ps->C1i, ps->C1,
+                  ps->r_a, ps->r_an, ps->r_sa);
+
+  if (!goo_group_exp_wave(group, pool, threads, jobs, 4))
+    return 0;
 
-  if (!goo_group_powgh(group, *Aq, t1, t2))
-    goto fail;
+  mpz_sub(S->Eq, *z_w2, *z_an);
+  mpz_fdiv_q(S->Eq, S->Eq, *ell);
+
+  ASSERT(goo_mpz_bitlen(S->Eq) <= GOO_EXP_BITS);
+
+  /* Compute `z' = (z mod ell)`. */
+  mpz_mod(*z_w, *z_w, *ell);
+  mpz_mod(*z_w2, *z_w2, *ell);
+  mpz_mod(*z_s1, *z_s1, *ell);
+  mpz_mod(*z_a, *z_a, *ell);
+  mpz_mod(*z_an, *z_an, *ell);
+  mpz_mod(*z_s1w, *z_s1w, *ell);
+  mpz_mod(*z_sa, *z_sa, *ell);
+  mpz_mod(*z_s2, *z_s2, *ell);
+
+  /* S = (C2, C3, t, chal, ell, Aq, Bq, Cq, Dq, Eq, z') */
+  mpz_set(S->C2, ps->C2);
+  mpz_set(S->C3, ps->C3);
+  mpz_set(S->t, ps->t);
+
+  return 1;
+}
+
+static int
+goo_signer_sign_sig(goo_signer_t *signer,
+                    goo_scratch_t *scratch,
+                    goo_sig_t *S,
+                    const unsigned char *msg,
+                    size_t msg_len,
+                    size_t threads) {
+  /* The exponentiations run in three waves of */
+  /* independent jobs, spread over `threads` */
+  /* threads (zero picks the number of usable */
+  /* CPUs), and as many guesses at `A` are */
+  /* tried at once. Every scalar is drawn in */
+  /* the same order regardless, so the output */
+  /* does not depend on the thread count, or */
+  /* on whether the signer was precomputed. */
+  goo_scratch_t *pool[5];
+  goo_presig_t ps;
+  int r = 0;
 
-  goo_group_reduce(group, *Aq, *Aq);
+  threads = goo_scratch_pool_create(signer->group, scratch, pool, threads);
 
-  mpz_fdiv_q(t1, *z_a, *ell);
-  mpz_fdiv_q(t2, *z_s2, *ell);
+  goo_presig_init(&ps);
 
-  if (!goo_group_powgh(group, *Bq, t1, t2))
+  /* Seed the PRNG using the primes and message as entropy. */
+  if (!goo_prng_seed_sign(&ps.prng, signer->p, signer->q, signer->s_prime,
+                          msg, msg_len, scratch->slab)) {
     goto fail;
+  }
 
-  goo_group_reduce(group, *Bq, *Bq);
+  if (!goo_signer_commit(signer, pool, threads, &ps, 0))
+    goto fail;
 
-  mpz_fdiv_q(t1, *z_w, *ell);
-  mpz_fdiv_q(t2, *z_w2, *ell);
-  mpz_fdiv_q(t3, *z_s1w, *ell);
-  goo_group_pow(group, t4, C2i, *C2, t1);
+  if (!goo_signer_challenge(signer, pool, threads, &ps, S, msg, msg_len))
+    goto fail;
 
-  if (!goo_group_powgh(group, t5, t2, t3))
+  if (!goo_signer_respond(signer, pool, threads, &ps, S))
     goto fail;
 
-  goo_group_mul(group, *Cq, t4, t5);
-  goo_group_reduce(group, *Cq, *Cq);
+  r = 1;
+fail:
+  goo_presig_uninit(&ps);
+  goo_scratch_pool_destroy(pool, threads);
+  goo_scratch_cleanse(scratch);
+  return r;
+}
 
-  mpz_fdiv_q(t1, *z_a, *ell);
-  mpz_fdiv_q(t2, *z_an, *ell);
-  mpz_fdiv_q(t3, *z_sa, *ell);
-  goo_group_pow(group, t4, C1i, C1, t1);
+static int
+goo_signer_presign_sig(goo_signer_t *signer,
+                       goo_scratch_t *scratch,
+                       goo_presig_t *ps,
+                       const unsigned char *entropy,
+                       size_t index,
+                       size_t threads) {
+  /* The nonces cannot be derived from a message */
+  /* that is not known yet, so they come from the */
+  /* key, fresh entropy, and the signer's counter. */
+  /* The counter keeps a repeated entropy from */
+  /* repeating nonces under the same signer. */
+  goo_scratch_t *pool[5];
+  unsigned char seed[40];
+  int r = 0;
+  int i;
 
-  if (!goo_group_powgh(group, t5, t2, t3))
-    goto fail;
+  threads = goo_scratch_pool_create(signer->group, scratch, pool, threads);
 
-  goo_group_mul(group, *Dq, t4, t5);
-  goo_group_reduce(group, *Dq, *Dq);
+  memcpy(seed, entropy, 32);
 
-  mpz_sub(*Eq, *z_w2, *z_an);
-  mpz_fdiv_q(*Eq, *Eq, *ell);
+  for (i = 39; i >= 32; i--) {
+    seed[i] = index & 0xff;
+    index >>= 8;
+  }
 
-  ASSERT(goo_mpz_bitlen(*Eq) <= GOO_EXP_BITS);
+  if (!goo_prng_seed_key(&ps->prng, signer->p, signer->q, signer->s_prime,
+                         seed, sizeof(seed), &GOO_PRNG_PRESIGN,
+                         scratch->slab)) {
+    goto fail;
+  }
 
-  /* Compute `z' = (z mod ell)`. */
-  mpz_mod(*z_w, *z_w, *ell);
-  mpz_mod(*z_w2, *z_w2, *ell);
-  mpz_mod(*z_s1, *z_s1, *ell);
-  mpz_mod(*z_a, *z_a, *ell);
-  mpz_mod(*z_an, *z_an, *ell);
-  mpz_mod(*z_s1w, *z_s1w, *ell);
-  mpz_mod(*z_sa, *z_sa, *ell);
-  mpz_mod(*z_s2, *z_s2, *ell);
+  if (!goo_signer_commit(signer, pool, threads, ps, 1))
+    goto fail;
 
-  /* S = (C2, C3, t, chal, ell, Aq, Bq, Cq, Dq, Eq, z') */
   r = 1;
 fail:
-  goo_prng_uninit(&prng);
-  goo_mpz_clear(n);
-  goo_mpz_clear(s);
-  goo_mpz_clear(C1);
-  goo_mpz_clear(w);
-  goo_mpz_clear(a);
-  goo_mpz_clear(s1);
-  goo_mpz_clear(s2);
-  goo_mpz_clear(t1);
-  goo_mpz_clear(t2);
-  goo_mpz_clear(t3);
-  goo_mpz_clear(t4);
-  goo_mpz_clear(t5);
-  goo_mpz_clear(C1i);
-  goo_mpz_clear(C2i);
-  goo_mpz_clear(r_w);
-  goo_mpz_clear(r_w2);
-  goo_mpz_clear(r_s1);
-  goo_mpz_clear(r_a);
-  goo_mpz_clear(r_an);
-  goo_mpz_clear(r_s1w);
-  goo_mpz_clear(r_sa);
-  goo_mpz_clear(r_s2);
-  goo_mpz_clear(A);
-  goo_mpz_clear(B);
-  goo_mpz_clear(C);
-  goo_mpz_clear(D);
-  goo_mpz_clear(E);
-  goo_cleanse(&prng, sizeof(goo_prng_t));
-  goo_cleanse(primes, sizeof(primes));
-  goo_cleanse(&i, sizeof(i));
-  goo_cleanse(key, sizeof(key));
-  goo_group_cleanse(group);
+  goo_cleanse(seed, sizeof(seed));
+  goo_scratch_pool_destroy(pool, threads);
+  goo_scratch_cleanse(scratch);
   return r;
 }
 
 static int
-goo_group_verify(goo_group_t *group,
-                 const unsigned char *msg,
-                 size_t msg_len,
-                 const goo_sig_t *S,
-                 const mpz_t C1) {
+goo_group_sign(goo_group_t *group,
+               goo_scratch_t *scratch,
+               goo_sig_t *S,
+               const unsigned char *msg,
+               size_t msg_len,
+               const unsigned char *s_prime,
+               const mpz_t p,
+               const mpz_t q,
+               size_t threads) {
+  goo_signer_t signer;
+  int r;
+
+  if (!goo_signer_init(&signer, group, scratch, s_prime, p, q, 0))
+    return 0;
+
+  r = goo_signer_sign_sig(&signer, scratch, S, msg, msg_len, threads);
+
+  goo_signer_uninit(&signer);
+
+  return r;
+}
+
+static int
+goo_group_verify_params(goo_group_t *group,
+                        const goo_sig_t *S,
+                        const mpz_t C1) {
   int r = 0;
   const mpz_t *C2 = &S->C2;
   const mpz_t *C3 = &S->C3;
@@ -2832,32 +5962,9 @@ goo_group_verify(goo_group_t *group,
   const mpz_t *z_s1w = &S->z_s1w;
   const mpz_t *z_sa = &S->z_sa;
   const mpz_t *z_s2 = &S->z_s2;
-
-  mpz_t C1i, C2i, C3i, Aqi, Bqi, Cqi, Dqi;
-  mpz_t A, B, C, D, E;
-  mpz_t tmp, chal0, ell0, ell1;
-
-  unsigned char key[GOO_SHA256_HASH_SIZE];
   size_t i;
   int found;
 
-  mpz_init(C1i);
-  mpz_init(C2i);
-  mpz_init(C3i);
-  mpz_init(Aqi);
-  mpz_init(Bqi);
-  mpz_init(Cqi);
-  mpz_init(Dqi);
-  mpz_init(A);
-  mpz_init(B);
-  mpz_init(C);
-  mpz_init(D);
-  mpz_init(E);
-  mpz_init(tmp);
-  mpz_init(chal0);
-  mpz_init(ell0);
-  mpz_init(ell1);
-
   VERIFY_POS(C1);
   VERIFY_POS(*C2);
   VERIFY_POS(*C3);
@@ -2926,11 +6033,53 @@ goo_group_verify(goo_group_t *group,
     goto fail;
   }
 
-  /* Compute inverses of C1, C2, C3, Aq, Bq, Cq, Dq. */
-  if (!goo_group_inv7(group, C1i, C2i, C3i, Aqi, Bqi, Cqi, Dqi,
-                             C1, *C2, *C3, *Aq, *Bq, *Cq, *Dq)) {
-    goto fail;
-  }
+  r = 1;
+fail:
+  return r;
+}
+
+static int
+goo_group_verify_recover(goo_group_t *group,
+                         goo_scratch_t *scratch,
+                         const goo_sig_t *S,
+                         const mpz_t C1,
+                         mpz_t *inv,
+                         mpz_t *out) {
+  /* Expects `inv` to hold the inverses of */
+  /* C1, C2, C3, Aq, Bq, Cq, Dq (in that order). */
+  /* Writes A, B, C, D, and E to `out`. */
+  const mpz_t *C2 = &S->C2;
+  const mpz_t *C3 = &S->C3;
+  const mpz_t *t = &S->t;
+  const mpz_t *chal = &S->chal;
+  const mpz_t *ell = &S->ell;
+  const mpz_t *Aq = &S->Aq;
+  const mpz_t *Bq = &S->Bq;
+  const mpz_t *Cq = &S->Cq;
+  const mpz_t *Dq = &S->Dq;
+  const mpz_t *Eq = &S->Eq;
+  const mpz_t *z_w = &S->z_w;
+  const mpz_t *z_w2 = &S->z_w2;
+  const mpz_t *z_s1 = &S->z_s1;
+  const mpz_t *z_a = &S->z_a;
+  const mpz_t *z_an = &S->z_an;
+  const mpz_t *z_s1w = &S->z_s1w;
+  const mpz_t *z_sa = &S->z_sa;
+  const mpz_t *z_s2 = &S->z_s2;
+  mpz_srcptr C1i = inv[0];
+  mpz_srcptr C2i = inv[1];
+  mpz_srcptr C3i = inv[2];
+  mpz_srcptr Aqi = inv[3];
+  mpz_srcptr Bqi = inv[4];
+  mpz_srcptr Cqi = inv[5];
+  mpz_srcptr Dqi = inv[6];
+  mpz_ptr E = out[4];
+  mpz_ptr rets[GOO_LANES];
+  mpz_srcptr b1[GOO_LANES], b1i[GOO_LANES], e1[GOO_LANES];
+  mpz_srcptr b2[GOO_LANES], b2i[GOO_LANES], e2[GOO_LANES];
+  mpz_srcptr e3[GOO_LANES], e4[GOO_LANES];
+  mpz_t tmp;
+  size_t i;
 
   /* Reconstruct A, B, C, D, and E from signature:
    *
@@ -2940,25 +6089,54 @@ goo_group_verify(goo_group_t *group,
    *   D = Dq^ell * g^z_an * h^z_sa / C1^z_a in G
    *   E = Eq * ell + ((z_w2 - z_an) mod ell) - t * chal
    */
-  if (!goo_group_recover(group, A, *Aq, Aqi, *ell,
-                         *C2, C2i, *chal, *z_w, *z_s1)) {
-    goto fail;
-  }
-
-  if (!goo_group_recover(group, B, *Bq, Bqi, *ell,
-                         *C3, C3i, *chal, *z_a, *z_s2)) {
-    goto fail;
+  /* The four exponentiations are independent, */
+  /* so they are evaluated side by side. */
+  for (i = 0; i < GOO_LANES; i++) {
+    rets[i] = out[i];
+    e1[i] = *ell;
   }
 
-  if (!goo_group_recover(group, C, *Cq, Cqi, *ell,
-                         *C2, C2i, *z_w, *z_w2, *z_s1w)) {
-    goto fail;
+  b1[0] = *Aq;
+  b1[1] = *Bq;
+  b1[2] = *Cq;
+  b1[3] = *Dq;
+
+  b1i[0] = Aqi;
+  b1i[1] = Bqi;
+  b1i[2] = Cqi;
+  b1i[3] = Dqi;
+
+  b2[0] = *C2;
+  b2[1] = *C3;
+  b2[2] = *C2;
+  b2[3] = C1;
+
+  b2i[0] = C2i;
+  b2i[1] = C3i;
+  b2i[2] = C2i;
+  b2i[3] = C1i;
+
+  e2[0] = *chal;
+  e2[1] = *chal;
+  e2[2] = *z_w;
+  e2[3] = *z_a;
+
+  e3[0] = *z_w;
+  e3[1] = *z_a;
+  e3[2] = *z_w2;
+  e3[3] = *z_an;
+
+  e4[0] = *z_s1;
+  e4[1] = *z_s2;
+  e4[2] = *z_s1w;
+  e4[3] = *z_sa;
+
+  if (!goo_group_recover4(group, scratch, rets, b1, b1i, e1,
+                          b2, b2i, e2, e3, e4)) {
+    return 0;
   }
 
-  if (!goo_group_recover(group, D, *Dq, Dqi, *ell,
-                         C1, C1i, *z_a, *z_an, *z_sa)) {
-    goto fail;
-  }
+  mpz_init(tmp);
 
   mpz_mul(E, *Eq, *ell);
   mpz_sub(tmp, *z_w2, *z_an);
@@ -2967,45 +6145,306 @@ goo_group_verify(goo_group_t *group,
   mpz_mul(tmp, *t, *chal);
   mpz_sub(E, E, tmp);
 
-  /* Recompute `chal` and `ell`. */
-  if (!goo_group_derive(group, chal0, ell0, key,
-                        C1, *C2, *C3, *t, A, B, C, D, E,
-                        msg, msg_len)) {
-    goto fail;
-  }
+  mpz_clear(tmp);
+
+  return 1;
+}
+
+static int
+goo_group_verify_final(goo_group_t *group,
+                       const goo_sig_t *S,
+                       const mpz_t chal0,
+                       const mpz_t ell0,
+                       const unsigned char *key) {
+  /* Checks `chal` and `ell` against the values */
+  /* derived from the recovered commitments. */
+  int r = 0;
+  mpz_t ell1;
+
+  (void)group;
+
+  mpz_init(ell1);
 
   /* `chal` must be equal to the computed value. */
-  if (mpz_cmp(*chal, chal0) != 0)
+  if (mpz_cmp(S->chal, chal0) != 0)
     goto fail;
 
   /* `ell` must be in the interval [ell',ell'+512]. */
   mpz_add_ui(ell1, ell0, GOO_ELLDIFF_MAX);
 
-  if (mpz_cmp(*ell, ell0) < 0 || mpz_cmp(*ell, ell1) > 0)
+  if (mpz_cmp(S->ell, ell0) < 0 || mpz_cmp(S->ell, ell1) > 0)
     goto fail;
 
   /* `ell` must be prime. */
-  if (!goo_is_prime(*ell, key))
+  if (!goo_is_prime(S->ell, key))
     goto fail;
 
   r = 1;
 fail:
-  mpz_clear(C1i);
-  mpz_clear(C2i);
-  mpz_clear(C3i);
-  mpz_clear(Aqi);
-  mpz_clear(Bqi);
-  mpz_clear(Cqi);
-  mpz_clear(Dqi);
-  mpz_clear(A);
-  mpz_clear(B);
-  mpz_clear(C);
-  mpz_clear(D);
-  mpz_clear(E);
-  mpz_clear(tmp);
+  mpz_clear(ell1);
+  return r;
+}
+
+static int
+goo_group_verify_inv(goo_group_t *group,
+                     goo_scratch_t *scratch,
+                     const unsigned char *msg,
+                     size_t msg_len,
+                     const goo_sig_t *S,
+                     const mpz_t C1,
+                     mpz_t *inv) {
+  /* Expects `inv` to hold the inverses of */
+  /* C1, C2, C3, Aq, Bq, Cq, Dq (in that order). */
+  int r = 0;
+  mpz_t out[5];
+  mpz_t chal0, ell0;
+  unsigned char key[GOO_SHA256_HASH_SIZE];
+  size_t i;
+
+  for (i = 0; i < 5; i++)
+    mpz_init(out[i]);
+
+  mpz_init(chal0);
+  mpz_init(ell0);
+
+  if (!goo_group_verify_recover(group, scratch, S, C1, inv, out))
+    goto fail;
+
+  /* Recompute `chal` and `ell`. */
+  if (!goo_group_derive(group, scratch, chal0, ell0, key,
+                        C1, S->C2, S->C3, S->t,
+                        out[0], out[1], out[2], out[3], out[4],
+                        msg, msg_len)) {
+    goto fail;
+  }
+
+  if (!goo_group_verify_final(group, S, chal0, ell0, key))
+    goto fail;
+
+  r = 1;
+fail:
+  for (i = 0; i < 5; i++)
+    mpz_clear(out[i]);
+
   mpz_clear(chal0);
   mpz_clear(ell0);
-  mpz_clear(ell1);
+  return r;
+}
+
+static int
+goo_group_verify(goo_group_t *group,
+                 goo_scratch_t *scratch,
+                 const unsigned char *msg,
+                 size_t msg_len,
+                 const goo_sig_t *S,
+                 const mpz_t C1) {
+  int r = 0;
+  mpz_t inv[7];
+  int i;
+
+  for (i = 0; i < 7; i++)
+    mpz_init(inv[i]);
+
+  if (!goo_group_verify_params(group, S, C1))
+    goto fail;
+
+  /* Compute inverses of C1, C2, C3, Aq, Bq, Cq, Dq. */
+  if (!goo_group_inv7(group, inv[0], inv[1], inv[2], inv[3],
+                             inv[4], inv[5], inv[6],
+                             C1, S->C2, S->C3, S->Aq,
+                             S->Bq, S->Cq, S->Dq)) {
+    goto fail;
+  }
+
+  if (!goo_group_verify_inv(group, scratch, msg, msg_len, S, C1, inv))
+    goto fail;
+
+  r = 1;
+fail:
+  for (i = 0; i < 7; i++)
+    mpz_clear(inv[i]);
+
+  return r;
+}
+
+static void
+goo_group_verify_invn(goo_group_t *group,
+                      int *ok,
+                      mpz_t *out,
+                      mpz_srcptr *in,
+                      size_t len) {
+  /* Invert all 7 elements of `len` signatures */
+  /* at once. If any element is not invertible, */
+  /* bisect the batch to isolate the culprits. */
+  size_t half;
+
+  if (len == 0)
+    return;
+
+  if (goo_group_invn(group, out, in, len * 7))
+    return;
+
+  if (len == 1) {
+    ok[0] = 0;
+    return;
+  }
+
+  half = len >> 1;
+
+  goo_group_verify_invn(group, ok, out, in, half);
+  goo_group_verify_invn(group, ok + half, out + half * 7,
+                        in + half * 7, len - half);
+}
+
+static int
+goo_group_verify_batch(goo_group_t *group,
+                       goo_scratch_t *scratch,
+                       int *results,
+                       const unsigned char *const *msgs,
+                       const size_t *msg_lens,
+                       const goo_sig_t *sigs,
+                       mpz_t *C1s,
+                       size_t len) {
+  /* Batch verification.
+   *
+   * Unlike a Schnorr-style scheme, the verifier
+   * does not check equations of the form
+   * `lhs == rhs` which could be combined with
+   * random weights: A, B, C, and D are recomputed
+   * and fed into the Fiat-Shamir hash, so every
+   * signature needs its own exact values.
+   *
+   * What we can share is the modular inversion.
+   * All 7 inverses for every signature in the
+   * batch are computed with Montgomery's trick,
+   * costing a single inversion for the batch.
+   * Should the inversion fail, we bisect.
+   *
+   * The Fiat-Shamir hashes are also independent
+   * of one another once A..E are known, so they
+   * are computed together with the multi-buffer
+   * SHA256 (see goo_group_derive_batch()).
+   */
+  size_t *idx = goo_calloc(len + 1, sizeof(size_t));
+  mpz_srcptr *elems = goo_calloc(len * 7 + 1, sizeof(mpz_srcptr));
+  mpz_t *inv = goo_calloc(len * 7 + 1, sizeof(mpz_t));
+  mpz_t *vals = goo_calloc(len * 5 + 1, sizeof(mpz_t));
+  mpz_t *chals = goo_calloc(len + 1, sizeof(mpz_t));
+  mpz_t *ells = goo_calloc(len + 1, sizeof(mpz_t));
+  mpz_srcptr *items = goo_calloc(len * 9 + 1, sizeof(mpz_srcptr));
+  const unsigned char **data = goo_calloc(len + 1, sizeof(unsigned char *));
+  size_t *lens = goo_calloc(len + 1, sizeof(size_t));
+  unsigned char *keys = goo_malloc(len * GOO_SHA256_HASH_SIZE + 1);
+  int *ok = goo_calloc(len + 1, sizeof(int));
+  size_t count = 0;
+  size_t i, j;
+  int r = 1;
+
+  for (i = 0; i < len * 7; i++)
+    mpz_init(inv[i]);
+
+  for (i = 0; i < len * 5; i++)
+    mpz_init(vals[i]);
+
+  for (i = 0; i < len; i++) {
+    mpz_init(chals[i]);
+    mpz_init(ells[i]);
+  }
+
+  for (i = 0; i < len; i++) {
+    const goo_sig_t *S = &sigs[i];
+
+    results[i] = 0;
+
+    if (!goo_group_verify_params(group, S, C1s[i]))
+      continue;
+
+    elems[count * 7 + 0] = C1s[i];
+    elems[count * 7 + 1] = S->C2;
+    elems[count * 7 + 2] = S->C3;
+    elems[count * 7 + 3] = S->Aq;
+    elems[count * 7 + 4] = S->Bq;
+    elems[count * 7 + 5] = S->Cq;
+    elems[count * 7 + 6] = S->Dq;
+
+    idx[count] = i;
+    ok[count] = 1;
+    count += 1;
+  }
+
+  goo_group_verify_invn(group, ok, inv, elems, count);
+
+  /* Recover A, B, C, D, and E. */
+  for (j = 0; j < count; j++) {
+    const goo_sig_t *S;
+    mpz_t *out = &vals[j * 5];
+
+    i = idx[j];
+    S = &sigs[i];
+
+    if (!ok[j])
+      continue;
+
+    if (!goo_group_verify_recover(group, scratch, S, C1s[i],
+                                  &inv[j * 7], out)) {
+      ok[j] = 0;
+      continue;
+    }
+
+    items[j * 9 + 0] = C1s[i];
+    items[j * 9 + 1] = S->C2;
+    items[j * 9 + 2] = S->C3;
+    items[j * 9 + 3] = S->t;
+    items[j * 9 + 4] = out[0];
+    items[j * 9 + 5] = out[1];
+    items[j * 9 + 6] = out[2];
+    items[j * 9 + 7] = out[3];
+    items[j * 9 + 8] = out[4];
+
+    data[j] = msgs[i];
+    lens[j] = msg_lens[i];
+  }
+
+  /* Recompute every `chal` and `ell`. */
+  goo_group_derive_batch(group, scratch, ok, chals, ells,
+                         keys, items, data, lens, count);
+
+  for (j = 0; j < count; j++) {
+    i = idx[j];
+
+    if (!ok[j])
+      continue;
+
+    results[i] = goo_group_verify_final(group, &sigs[i], chals[j], ells[j],
+                                        &keys[j * GOO_SHA256_HASH_SIZE]);
+  }
+
+  for (i = 0; i < len; i++)
+    r &= results[i];
+
+  for (i = 0; i < len * 7; i++)
+    mpz_clear(inv[i]);
+
+  for (i = 0; i < len * 5; i++)
+    mpz_clear(vals[i]);
+
+  for (i = 0; i < len; i++) {
+    mpz_clear(chals[i]);
+    mpz_clear(ells[i]);
+  }
+
+  goo_free(idx);
+  goo_free(elems);
+  goo_free(inv);
+  goo_free(vals);
+  goo_free(chals);
+  goo_free(ells);
+  goo_free(items);
+  goo_free(data);
+  goo_free(lens);
+  goo_free(keys);
+  goo_free(ok);
+
   return r;
 }
 
@@ -3132,22 +6571,22 @@ goo_unveil(mpz_t m,
 }
 
 static int
-goo_encrypt_oaep(unsigned char **out,
-                 size_t *out_len,
-                 const unsigned char *msg,
-                 size_t msg_len,
-                 const mpz_t n,
-                 const mpz_t e,
-                 const unsigned char *label,
-                 size_t label_len,
-                 const unsigned char *entropy) {
+goo_encrypt_oaep_raw(unsigned char *out,
+                     const unsigned char *msg,
+                     size_t msg_len,
+                     const mpz_t n,
+                     const mpz_t e,
+                     const unsigned char *label,
+                     size_t label_len,
+                     const unsigned char *entropy) {
   /* [RFC8017] Page 22, Section 7.1.1. */
+  /* Writes GOO_CT_BYTES to `out`. */
   int r = 0;
   goo_prng_t prng;
   size_t klen = goo_mpz_bytelen(n);
   size_t mlen = msg_len;
   size_t hlen = GOO_SHA256_HASH_SIZE;
-  unsigned char *em = NULL;
+  unsigned char em[GOO_MAX_RSA_BYTES];
   unsigned char *seed, *db;
   unsigned char lhash[GOO_SHA256_HASH_SIZE];
   size_t slen, dlen;
@@ -3169,7 +6608,6 @@ goo_encrypt_oaep(unsigned char **out,
     goto fail;
 
   /* EM = 0x00 || (seed) || (Hash(L) || PS || 0x01 || M) */
-  em = goo_calloc(klen, sizeof(unsigned char));
   goo_sha256(lhash, label, label_len);
   seed = &em[1];
   slen = hlen;
@@ -3178,7 +6616,7 @@ goo_encrypt_oaep(unsigned char **out,
 
   em[0] = 0x00;
 
-  goo_prng_seed(&prng, entropy, GOO_PRNG_ENCRYPT);
+  goo_prng_seed(&prng, entropy, &GOO_PRNG_ENCRYPT);
   goo_prng_generate(&prng, seed, slen);
   memcpy(&db[0], lhash, sizeof(lhash));
   memset(&db[hlen], 0x00, (dlen - mlen - 1) - hlen);
@@ -3197,10 +6635,7 @@ goo_encrypt_oaep(unsigned char **out,
   if (!goo_veil(m, m, n, GOO_MAX_RSA_BITS + 8, &prng))
     goto fail;
 
-  *out_len = (GOO_MAX_RSA_BITS + 8 + 7) / 8;
-  *out = goo_mpz_pad(NULL, *out_len, m);
-
-  if (*out == NULL)
+  if (goo_mpz_pad(out, GOO_CT_BYTES, m) == NULL)
     goto fail;
 
   r = 1;
@@ -3208,76 +6643,101 @@ fail:
   goo_prng_uninit(&prng);
   goo_cleanse(&prng, sizeof(goo_prng_t));
   goo_mpz_clear(m);
-  goo_free(em);
   return r;
 }
 
 static int
-goo_decrypt_oaep(unsigned char **out,
+goo_encrypt_oaep(unsigned char **out,
                  size_t *out_len,
                  const unsigned char *msg,
                  size_t msg_len,
-                 const mpz_t p,
-                 const mpz_t q,
+                 const mpz_t n,
                  const mpz_t e,
                  const unsigned char *label,
                  size_t label_len,
                  const unsigned char *entropy) {
-  /* [RFC8017] Page 25, Section 7.1.2. */
+  unsigned char *ct = goo_malloc(GOO_CT_BYTES);
+
+  if (!goo_encrypt_oaep_raw(ct, msg, msg_len, n, e,
+                            label, label_len, entropy)) {
+    goo_free(ct);
+    return 0;
+  }
+
+  *out = ct;
+  *out_len = GOO_CT_BYTES;
+
+  return 1;
+}
+
+static void
+goo_decryptor_uninit(goo_decryptor_t *key);
+
+static int
+goo_decryptor_init(goo_decryptor_t *key,
+                   const mpz_t p,
+                   const mpz_t q,
+                   const mpz_t e,
+                   const unsigned char *entropy) {
+  /* An RSA private key in CRT form, along with */
+  /* a blinding pair generated from `entropy`. */
   int r = 0;
   goo_prng_t prng;
-  mpz_t n, t, d, m, s, b, bi;
-  unsigned char *em = NULL;
-  unsigned char *seed, *db, *rest, *lhash;
-  size_t i, klen, slen, dlen, rlen;
-  size_t hlen = GOO_SHA256_HASH_SIZE;
-  uint32_t zero, lvalid, looking, index, invalid, valid;
-  unsigned char expect[GOO_SHA256_HASH_SIZE];
+  mpz_t t, s;
 
   goo_prng_init(&prng);
 
-  mpz_init(n);
+  mpz_init(key->n);
+  mpz_init(key->e);
+  mpz_init(key->p);
+  mpz_init(key->q);
+  mpz_init(key->dp);
+  mpz_init(key->dq);
+  mpz_init(key->qinv);
+  mpz_init(key->b);
+  mpz_init(key->bi);
   mpz_init(t);
-  mpz_init(d);
-  mpz_init(m);
   mpz_init(s);
-  mpz_init(b);
-  mpz_init(bi);
 
   if (!goo_is_valid_prime(p) || !goo_is_valid_prime(q))
     goto fail;
 
   /* n = p * q */
-  mpz_mul(n, p, q);
+  mpz_mul(key->n, p, q);
 
-  if (!goo_is_valid_modulus(n))
+  if (!goo_is_valid_modulus(key->n))
     goto fail;
 
   if (!goo_is_valid_exponent(e))
     goto fail;
 
-  /* t = (p - 1) * (q - 1) */
+  mpz_set(key->e, e);
+  mpz_set(key->p, p);
+  mpz_set(key->q, q);
+
+  /* dp = e^-1 mod (p - 1) */
   mpz_sub_ui(t, p, 1);
-  mpz_sub_ui(d, q, 1);
-  mpz_mul(t, t, d);
 
-  /* d = e^-1 mod t */
-  if (!mpz_invert(d, e, t))
+  if (!mpz_invert(key->dp, e, t))
     goto fail;
 
-  klen = goo_mpz_bytelen(n);
+  /* dq = e^-1 mod (q - 1) */
+  mpz_sub_ui(t, q, 1);
 
-  if (klen < hlen * 2 + 2)
+  if (!mpz_invert(key->dq, e, t))
     goto fail;
 
-  if (!goo_unveil(m, msg, msg_len, n, GOO_MAX_RSA_BITS + 8))
+  /* qinv = q^-1 mod p */
+  if (!mpz_invert(key->qinv, q, p))
     goto fail;
 
+  key->size = goo_mpz_bytelen(key->n);
+
   /* Seed PRNG with user-provided entropy. */
-  goo_prng_seed(&prng, entropy, GOO_PRNG_DECRYPT);
+  goo_prng_seed(&prng, entropy, &GOO_PRNG_DECRYPT);
 
   /* t = n - 1 */
-  mpz_sub_ui(t, n, 1);
+  mpz_sub_ui(t, key->n, 1);
 
   /* Generate blinding factor. */
   for (;;) {
@@ -3286,32 +6746,143 @@ goo_decrypt_oaep(unsigned char **out,
     mpz_add_ui(s, s, 1);
 
     /* bi = s^-1 mod n */
-    if (!mpz_invert(bi, s, n))
+    if (!mpz_invert(key->bi, s, key->n))
       continue;
 
     /* b = s^e mod n */
-    mpz_powm(b, s, e, n);
+    mpz_powm(key->b, s, e, key->n);
 
     break;
   }
 
-  /* c' = c * b mod n (blind) */
-  mpz_mul(m, m, b);
-  mpz_mod(m, m, n);
+  r = 1;
+fail:
+  goo_prng_uninit(&prng);
+  goo_cleanse(&prng, sizeof(goo_prng_t));
+  goo_mpz_clear(t);
+  goo_mpz_clear(s);
+
+  if (!r)
+    goo_decryptor_uninit(key);
+
+  return r;
+}
+
+static void
+goo_decryptor_uninit(goo_decryptor_t *key) {
+  goo_mpz_clear(key->n);
+  goo_mpz_clear(key->e);
+  goo_mpz_clear(key->p);
+  goo_mpz_clear(key->q);
+  goo_mpz_clear(key->dp);
+  goo_mpz_clear(key->dq);
+  goo_mpz_clear(key->qinv);
+  goo_mpz_clear(key->b);
+  goo_mpz_clear(key->bi);
+
+  key->size = 0;
+}
 
-  /* m' = c'^d mod n */
+static void
+goo_mpz_powm_sec(mpz_t ret, const mpz_t b, const mpz_t e, const mpz_t m) {
 #ifdef GOO_HAS_GMP
-  if (mpz_sgn(d) > 0 && mpz_odd_p(n))
-    mpz_powm_sec(m, m, d, n);
+  if (mpz_sgn(e) > 0 && mpz_odd_p(m))
+    mpz_powm_sec(ret, b, e, m);
   else
-    mpz_powm(m, m, d, n);
+    mpz_powm(ret, b, e, m);
 #else
-  mpz_powm(m, m, d, n);
+  mpz_powm(ret, b, e, m);
 #endif
+}
 
-  /* m = m' * bi mod n (unblind) */
-  mpz_mul(m, m, bi);
-  mpz_mod(m, m, n);
+static int
+goo_decryptor_pow(goo_decryptor_t *key, mpz_t m) {
+  /* m = m^d mod n for m < n, blinded, with two */
+  /* half-size exponentiations (Garner's formula). */
+  /* The result is checked against the public key */
+  /* before unblinding, as a faulty CRT half would */
+  /* otherwise reveal a factor of n. */
+  int r = 0;
+  mpz_t mp, mq, c;
+
+  mpz_init(mp);
+  mpz_init(mq);
+  mpz_init(c);
+
+  /* c' = c * b mod n (blind) */
+  mpz_mul(c, m, key->b);
+  mpz_mod(c, c, key->n);
+
+  /* mp = c'^dp mod p */
+  mpz_mod(mp, c, key->p);
+  goo_mpz_powm_sec(mp, mp, key->dp, key->p);
+
+  /* mq = c'^dq mod q */
+  mpz_mod(mq, c, key->q);
+  goo_mpz_powm_sec(mq, mq, key->dq, key->q);
+
+  /* m' = mq + q * ((mp - mq) * qinv mod p) */
+  mpz_sub(mp, mp, mq);
+  mpz_mul(mp, mp, key->qinv);
+  mpz_mod(mp, mp, key->p);
+  mpz_mul(mp, mp, key->q);
+  mpz_add(m, mq, mp);
+
+  /* m'^e == c' mod n */
+  mpz_powm(mq, m, key->e, key->n);
+
+  if (mpz_cmp(mq, c) == 0) {
+    /* m = m' * bi mod n (unblind) */
+    mpz_mul(m, m, key->bi);
+    mpz_mod(m, m, key->n);
+    r = 1;
+  } else {
+    mpz_set_ui(m, 0);
+  }
+
+  /* The next call blinds with (b^2, bi^2), which */
+  /* costs two squarings rather than a fresh pair. */
+  mpz_mul(key->b, key->b, key->b);
+  mpz_mod(key->b, key->b, key->n);
+  mpz_mul(key->bi, key->bi, key->bi);
+  mpz_mod(key->bi, key->bi, key->n);
+
+  goo_mpz_clear(mp);
+  goo_mpz_clear(mq);
+  goo_mpz_clear(c);
+  return r;
+}
+
+static int
+goo_decryptor_oaep(goo_decryptor_t *key,
+                   unsigned char **out,
+                   size_t *out_len,
+                   const unsigned char *msg,
+                   size_t msg_len,
+                   const unsigned char *label,
+                   size_t label_len) {
+  /* [RFC8017] Page 25, Section 7.1.2. */
+  int r = 0;
+  mpz_t m;
+  unsigned char *em = NULL;
+  unsigned char *seed, *db, *rest, *lhash;
+  size_t i, klen, slen, dlen, rlen;
+  size_t hlen = GOO_SHA256_HASH_SIZE;
+  uint32_t zero, lvalid, looking, index, invalid, valid;
+  unsigned char expect[GOO_SHA256_HASH_SIZE];
+
+  mpz_init(m);
+
+  klen = key->size;
+
+  if (klen < hlen * 2 + 2)
+    goto fail;
+
+  if (!goo_unveil(m, msg, msg_len, key->n, GOO_MAX_RSA_BITS + 8))
+    goto fail;
+
+  if (!goo_decryptor_pow(key, m))
+    goto fail;
 
   /* EM = 0x00 || (seed) || (Hash(L) || PS || 0x01 || M) */
   em = goo_mpz_pad(NULL, klen, m);
@@ -3356,23 +6927,40 @@ goo_decrypt_oaep(unsigned char **out,
   *out = goo_malloc(*out_len);
   memcpy(*out, rest + index + 1, *out_len);
 
-  goo_cleanse(em, klen);
-
   r = 1;
 fail:
-  goo_prng_uninit(&prng);
-  goo_cleanse(&prng, sizeof(goo_prng_t));
-  goo_mpz_clear(n);
-  goo_mpz_clear(t);
-  goo_mpz_clear(d);
+  if (em != NULL)
+    goo_cleanse(em, klen);
+
   goo_mpz_clear(m);
-  goo_mpz_clear(s);
-  goo_mpz_clear(b);
-  goo_mpz_clear(bi);
   goo_free(em);
   return r;
 }
 
+static int
+goo_decrypt_oaep(unsigned char **out,
+                 size_t *out_len,
+                 const unsigned char *msg,
+                 size_t msg_len,
+                 const mpz_t p,
+                 const mpz_t q,
+                 const mpz_t e,
+                 const unsigned char *label,
+                 size_t label_len,
+                 const unsigned char *entropy) {
+  goo_decryptor_t key;
+  int r;
+
+  if (!goo_decryptor_init(&key, p, q, e, entropy))
+    return 0;
+
+  r = goo_decryptor_oaep(&key, out, out_len, msg, msg_len, label, label_len);
+
+  goo_decryptor_uninit(&key);
+
+  return r;
+}
+
 /*
  * API
  */
@@ -3413,6 +7001,29 @@ goo_destroy(goo_group_t *ctx) {
   }
 }
 
+goo_scratch_t *
+goo_scratch_create(const goo_group_t *ctx) {
+  goo_scratch_t *scratch;
+
+  if (ctx == NULL)
+    return NULL;
+
+  scratch = goo_malloc(sizeof(goo_scratch_t));
+
+  goo_scratch_init(scratch, ctx);
+
+  return scratch;
+}
+
+void
+goo_scratch_destroy(goo_scratch_t *scratch) {
+  if (scratch != NULL) {
+    goo_scratch_cleanse(scratch);
+    goo_scratch_uninit(scratch);
+    goo_free(scratch);
+  }
+}
+
 int
 goo_generate(goo_group_t *ctx,
              unsigned char *s_prime,
@@ -3439,119 +7050,448 @@ goo_generate(goo_group_t *ctx,
 
 int
 goo_challenge(goo_group_t *ctx,
+              goo_scratch_t *scratch,
               unsigned char **C1,
               size_t *C1_len,
               const unsigned char *s_prime,
               const unsigned char *n,
               size_t n_len) {
+  goo_scratch_t *tmp = NULL;
+  int r = 0;
+  mpz_t C1_n, n_n;
+
+  if (ctx == NULL
+      || s_prime == NULL
+      || C1 == NULL
+      || C1_len == NULL
+      || n == NULL) {
+    return 0;
+  }
+
+  if (scratch == NULL)
+    scratch = tmp = goo_scratch_create(ctx);
+
+  mpz_init(C1_n);
+  mpz_init(n_n);
+
+  goo_mpz_import(n_n, n, n_len);
+
+  if (!goo_group_challenge(ctx, scratch, C1_n, s_prime, n_n))
+    goto fail;
+
+  *C1_len = ctx->size;
+  *C1 = goo_mpz_pad(NULL, *C1_len, C1_n);
+
+  if (*C1 == NULL)
+    goto fail;
+
+  r = 1;
+fail:
+  goo_mpz_clear(C1_n);
+  goo_mpz_clear(n_n);
+  goo_scratch_destroy(tmp);
+  return r;
+}
+
+int
+goo_validate(goo_group_t *ctx,
+             goo_scratch_t *scratch,
+             const unsigned char *s_prime,
+             const unsigned char *C1,
+             size_t C1_len,
+             const unsigned char *p,
+             size_t p_len,
+             const unsigned char *q,
+             size_t q_len) {
+  goo_scratch_t *tmp = NULL;
+  int r = 0;
+  mpz_t C1_n, p_n, q_n;
+
+  if (ctx == NULL
+      || s_prime == NULL
+      || C1 == NULL
+      || p == NULL
+      || q == NULL) {
+    return 0;
+  }
+
+  if (C1_len != ctx->size)
+    return 0;
+
+  if (scratch == NULL)
+    scratch = tmp = goo_scratch_create(ctx);
+
+  mpz_init(C1_n);
+  mpz_init(p_n);
+  mpz_init(q_n);
+
+  goo_mpz_import(C1_n, C1, C1_len);
+  goo_mpz_import(p_n, p, p_len);
+  goo_mpz_import(q_n, q, q_len);
+
+  if (!goo_group_validate(ctx, scratch, s_prime, C1_n, p_n, q_n))
+    goto fail;
+
+  r = 1;
+fail:
+  goo_mpz_clear(C1_n);
+  goo_mpz_clear(p_n);
+  goo_mpz_clear(q_n);
+  goo_scratch_destroy(tmp);
+  return r;
+}
+
+int
+goo_sign(goo_group_t *ctx,
+         goo_scratch_t *scratch,
+         unsigned char **out,
+         size_t *out_len,
+         const unsigned char *msg,
+         size_t msg_len,
+         const unsigned char *s_prime,
+         const unsigned char *p,
+         size_t p_len,
+         const unsigned char *q,
+         size_t q_len) {
+  return goo_sign_parallel(ctx, scratch, out, out_len, msg, msg_len,
+                           s_prime, p, p_len, q, q_len, 1);
+}
+
+int
+goo_sign_parallel(goo_group_t *ctx,
+                  goo_scratch_t *scratch,
+                  unsigned char **out,
+                  size_t *out_len,
+                  const unsigned char *msg,
+                  size_t msg_len,
+                  const unsigned char *s_prime,
+                  const unsigned char *p,
+                  size_t p_len,
+                  const unsigned char *q,
+                  size_t q_len,
+                  size_t threads) {
+  /* goo_sign() on `threads` threads (zero picks */
+  /* the number of usable CPUs). The signature is */
+  /* identical to the one goo_sign() produces. */
+  goo_scratch_t *tmp = NULL;
+  int r = 0;
+  mpz_t p_n, q_n;
+  goo_sig_t S;
+  size_t size;
+  unsigned char *data = NULL;
+
+  if (ctx == NULL
+      || out == NULL
+      || out_len == NULL
+      || s_prime == NULL
+      || p == NULL
+      || q == NULL) {
+    return 0;
+  }
+
+  if (scratch == NULL)
+    scratch = tmp = goo_scratch_create(ctx);
+
+  mpz_init(p_n);
+  mpz_init(q_n);
+  goo_sig_init(&S);
+
+  goo_mpz_import(p_n, p, p_len);
+  goo_mpz_import(q_n, q, q_len);
+
+  if (!goo_group_sign(ctx, scratch, &S, msg, msg_len,
+                      s_prime, p_n, q_n, threads)) {
+    goto fail;
+  }
+
+  size = goo_sig_size(&S, ctx->bits);
+  data = goo_malloc(size);
+
+  if (!goo_sig_export(data, &S, ctx->bits))
+    goto fail;
+
+  *out = data;
+  *out_len = size;
+  data = NULL;
+
+  r = 1;
+fail:
+  goo_mpz_clear(p_n);
+  goo_mpz_clear(q_n);
+  goo_sig_uninit(&S);
+  goo_free(data);
+  goo_scratch_destroy(tmp);
+  return r;
+}
+
+goo_signer_t *
+goo_signer_create(goo_group_t *ctx,
+                  goo_scratch_t *scratch,
+                  const unsigned char *s_prime,
+                  const unsigned char *p,
+                  size_t p_len,
+                  const unsigned char *q,
+                  size_t q_len) {
+  /* Everything goo_sign() derives from the key */
+  /* alone, computed once. The signer is only */
+  /* read while signing, so it may be shared */
+  /* between threads with a scratch per thread. */
+  goo_scratch_t *tmp = NULL;
+  goo_signer_t *signer = NULL;
+  mpz_t p_n, q_n;
+
+  if (ctx == NULL || s_prime == NULL || p == NULL || q == NULL)
+    return NULL;
+
+  if (scratch == NULL)
+    scratch = tmp = goo_scratch_create(ctx);
+
+  mpz_init(p_n);
+  mpz_init(q_n);
+
+  goo_mpz_import(p_n, p, p_len);
+  goo_mpz_import(q_n, q, q_len);
+
+  signer = goo_malloc(sizeof(goo_signer_t));
+
+  if (!goo_signer_init(signer, ctx, scratch, s_prime, p_n, q_n, 1)) {
+    goo_free(signer);
+    signer = NULL;
+  }
+
+  goo_mpz_clear(p_n);
+  goo_mpz_clear(q_n);
+  goo_scratch_destroy(tmp);
+
+  return signer;
+}
+
+void
+goo_signer_destroy(goo_signer_t *signer) {
+  if (signer != NULL) {
+    goo_signer_uninit(signer);
+    goo_free(signer);
+  }
+}
+
+int
+goo_signer_sign(goo_signer_t *signer,
+                goo_scratch_t *scratch,
+                unsigned char **out,
+                size_t *out_len,
+                const unsigned char *msg,
+                size_t msg_len,
+                size_t threads) {
+  /* Identical to goo_sign_parallel() with the */
+  /* signer's key. */
+  goo_scratch_t *tmp = NULL;
+  goo_group_t *ctx;
   int r = 0;
-  mpz_t C1_n, n_n;
+  goo_sig_t S;
+  size_t size;
+  unsigned char *data = NULL;
 
-  if (ctx == NULL
-      || s_prime == NULL
-      || C1 == NULL
-      || C1_len == NULL
-      || n == NULL) {
+  if (signer == NULL || out == NULL || out_len == NULL)
     return 0;
-  }
 
-  mpz_init(C1_n);
-  mpz_init(n_n);
+  ctx = signer->group;
 
-  goo_mpz_import(n_n, n, n_len);
+  if (scratch == NULL)
+    scratch = tmp = goo_scratch_create(ctx);
+
+  goo_sig_init(&S);
 
-  if (!goo_group_challenge(ctx, C1_n, s_prime, n_n))
+  if (!goo_signer_sign_sig(signer, scratch, &S, msg, msg_len, threads))
     goto fail;
 
-  *C1_len = ctx->size;
-  *C1 = goo_mpz_pad(NULL, *C1_len, C1_n);
+  size = goo_sig_size(&S, ctx->bits);
+  data = goo_malloc(size);
 
-  if (*C1 == NULL)
+  if (!goo_sig_export(data, &S, ctx->bits))
     goto fail;
 
+  *out = data;
+  *out_len = size;
+  data = NULL;
+
   r = 1;
 fail:
-  goo_mpz_clear(C1_n);
-  goo_mpz_clear(n_n);
+  goo_sig_uninit(&S);
+  goo_free(data);
+  goo_scratch_destroy(tmp);
   return r;
 }
 
+goo_presig_t *
+goo_signer_presign(goo_signer_t *signer,
+                   goo_scratch_t *scratch,
+                   const unsigned char *entropy,
+                   size_t threads) {
+  /* The message-independent half of a signature. */
+  /* Unlike goo_sign(), the result depends on the */
+  /* entropy, which must be fresh for every call. */
+  /* Not safe to call concurrently on one signer. */
+  goo_scratch_t *tmp = NULL;
+  goo_presig_t *presig;
+  size_t index;
+
+  if (signer == NULL || entropy == NULL)
+    return NULL;
+
+  if (scratch == NULL)
+    scratch = tmp = goo_scratch_create(signer->group);
+
+  presig = goo_malloc(sizeof(goo_presig_t));
+
+  goo_presig_init(presig);
+
+  index = signer->presigned++;
+
+  if (!goo_signer_presign_sig(signer, scratch, presig,
+                              entropy, index, threads)) {
+    goo_presig_destroy(presig);
+    presig = NULL;
+  }
+
+  goo_scratch_destroy(tmp);
+
+  return presig;
+}
+
+typedef struct goo_presign_many_s {
+  goo_signer_t *signer;
+  goo_scratch_t **scratch;
+  goo_presig_t **out;
+  const unsigned char *entropy;
+  size_t base;
+  int *ok;
+} goo_presign_many_t;
+
+static void
+goo_presign_many_work(void *arg, size_t index, size_t thread) {
+  goo_presign_many_t *job = (goo_presign_many_t *)arg;
+  goo_presig_t *ps = job->out[index];
+
+  job->ok[index] = goo_signer_presign_sig(job->signer, job->scratch[thread],
+                                          ps, job->entropy,
+                                          job->base + index, 1);
+}
+
 int
-goo_validate(goo_group_t *ctx,
-             const unsigned char *s_prime,
-             const unsigned char *C1,
-             size_t C1_len,
-             const unsigned char *p,
-             size_t p_len,
-             const unsigned char *q,
-             size_t q_len) {
-  int r = 0;
-  mpz_t C1_n, p_n, q_n;
+goo_signer_presign_many(goo_signer_t *signer,
+                        goo_presig_t **out,
+                        size_t count,
+                        const unsigned char *entropy,
+                        size_t threads) {
+  /* Fill `out` with `count` presignatures, one */
+  /* per thread at a time. The batch reserves */
+  /* `count` values of the signer's counter up */
+  /* front, so bundles never share a seed. */
+  goo_presign_many_t job;
+  goo_scratch_t **scratch;
+  int *ok;
+  int r = 1;
+  size_t i;
 
-  if (ctx == NULL
-      || s_prime == NULL
-      || C1 == NULL
-      || p == NULL
-      || q == NULL) {
+  if (signer == NULL || out == NULL || entropy == NULL)
     return 0;
+
+  if (count == 0)
+    return 1;
+
+  threads = goo_pool_threads(threads, count);
+
+  scratch = goo_calloc(threads, sizeof(goo_scratch_t *));
+  ok = goo_calloc(count, sizeof(int));
+
+  for (i = 0; i < threads; i++)
+    scratch[i] = goo_scratch_create(signer->group);
+
+  for (i = 0; i < count; i++) {
+    out[i] = goo_malloc(sizeof(goo_presig_t));
+    goo_presig_init(out[i]);
   }
 
-  if (C1_len != ctx->size)
-    return 0;
+  job.signer = signer;
+  job.scratch = scratch;
+  job.out = out;
+  job.entropy = entropy;
+  job.base = signer->presigned;
+  job.ok = ok;
 
-  mpz_init(C1_n);
-  mpz_init(p_n);
-  mpz_init(q_n);
+  signer->presigned += count;
 
-  goo_mpz_import(C1_n, C1, C1_len);
-  goo_mpz_import(p_n, p, p_len);
-  goo_mpz_import(q_n, q, q_len);
+  goo_pool_run(threads, count, goo_presign_many_work, &job);
 
-  if (!goo_group_validate(ctx, s_prime, C1_n, p_n, q_n))
-    goto fail;
+  for (i = 0; i < count; i++)
+    r &= ok[i];
+
+  if (!r) {
+    for (i = 0; i < count; i++) {
+      goo_presig_destroy(out[i]);
+      out[i] = NULL;
+    }
+  }
+
+  for (i = 0; i < threads; i++)
+    goo_scratch_destroy(scratch[i]);
+
+  goo_free(scratch);
+  goo_free(ok);
 
-  r = 1;
-fail:
-  goo_mpz_clear(C1_n);
-  goo_mpz_clear(p_n);
-  goo_mpz_clear(q_n);
   return r;
 }
 
+void
+goo_presig_destroy(goo_presig_t *presig) {
+  if (presig != NULL) {
+    goo_presig_uninit(presig);
+    goo_free(presig);
+  }
+}
+
 int
-goo_sign(goo_group_t *ctx,
-         unsigned char **out,
-         size_t *out_len,
-         const unsigned char *msg,
-         size_t msg_len,
-         const unsigned char *s_prime,
-         const unsigned char *p,
-         size_t p_len,
-         const unsigned char *q,
-         size_t q_len) {
+goo_signer_sign_presig(goo_signer_t *signer,
+                       goo_scratch_t *scratch,
+                       goo_presig_t *presig,
+                       unsigned char **out,
+                       size_t *out_len,
+                       const unsigned char *msg,
+                       size_t msg_len,
+                       size_t threads) {
+  /* The online half: `ell` and the responses. */
+  /* The presignature is consumed (and destroyed) */
+  /* whether or not signing succeeds, as signing */
+  /* twice with one would reveal the key. */
+  goo_scratch_t *tmp = NULL;
+  goo_scratch_t *pool[5];
+  goo_group_t *ctx;
   int r = 0;
-  mpz_t p_n, q_n;
   goo_sig_t S;
   size_t size;
   unsigned char *data = NULL;
 
-  if (ctx == NULL
-      || out == NULL
-      || out_len == NULL
-      || s_prime == NULL
-      || p == NULL
-      || q == NULL) {
+  if (signer == NULL || presig == NULL || out == NULL || out_len == NULL) {
+    goo_presig_destroy(presig);
     return 0;
   }
 
-  mpz_init(p_n);
-  mpz_init(q_n);
+  ctx = signer->group;
+
+  if (scratch == NULL)
+    scratch = tmp = goo_scratch_create(ctx);
+
+  threads = goo_scratch_pool_create(ctx, scratch, pool, threads);
+
   goo_sig_init(&S);
 
-  goo_mpz_import(p_n, p, p_len);
-  goo_mpz_import(q_n, q, q_len);
+  if (!presig->has_A)
+    goto fail;
 
-  if (!goo_group_sign(ctx, &S, msg, msg_len, s_prime, p_n, q_n))
+  if (!goo_signer_challenge(signer, pool, threads, presig, &S, msg, msg_len))
+    goto fail;
+
+  if (!goo_signer_respond(signer, pool, threads, presig, &S))
     goto fail;
 
   size = goo_sig_size(&S, ctx->bits);
@@ -3566,21 +7506,25 @@ goo_sign(goo_group_t *ctx,
 
   r = 1;
 fail:
-  goo_mpz_clear(p_n);
-  goo_mpz_clear(q_n);
+  goo_presig_destroy(presig);
   goo_sig_uninit(&S);
   goo_free(data);
+  goo_scratch_pool_destroy(pool, threads);
+  goo_scratch_cleanse(scratch);
+  goo_scratch_destroy(tmp);
   return r;
 }
 
 int
 goo_verify(goo_group_t *ctx,
+           goo_scratch_t *scratch,
            const unsigned char *msg,
            size_t msg_len,
            const unsigned char *sig,
            size_t sig_len,
            const unsigned char *C1,
            size_t C1_len) {
+  goo_scratch_t *tmp = NULL;
   int r = 0;
   goo_sig_t S;
   mpz_t C1_n;
@@ -3591,6 +7535,9 @@ goo_verify(goo_group_t *ctx,
   if (C1_len != ctx->size)
     return 0;
 
+  if (scratch == NULL)
+    scratch = tmp = goo_scratch_create(ctx);
+
   goo_sig_init(&S);
   mpz_init(C1_n);
 
@@ -3599,13 +7546,142 @@ goo_verify(goo_group_t *ctx,
   if (!goo_sig_import(&S, sig, sig_len, ctx->bits))
     goto fail;
 
-  if (!goo_group_verify(ctx, msg, msg_len, &S, C1_n))
+  if (!goo_group_verify(ctx, scratch, msg, msg_len, &S, C1_n))
     goto fail;
 
   r = 1;
 fail:
   goo_sig_uninit(&S);
   mpz_clear(C1_n);
+  goo_scratch_destroy(tmp);
+  return r;
+}
+
+int
+goo_verify_batch(goo_group_t *ctx,
+                 goo_scratch_t *scratch,
+                 size_t len,
+                 const unsigned char *const *msgs,
+                 const size_t *msg_lens,
+                 const unsigned char *const *sigs,
+                 const size_t *sig_lens,
+                 const unsigned char *const *C1s,
+                 const size_t *C1_lens,
+                 int *results) {
+  goo_scratch_t *tmp = NULL;
+  goo_sig_t *S;
+  mpz_t *C1_n;
+  size_t i;
+  int r;
+
+  if (ctx == NULL || results == NULL)
+    return 0;
+
+  if (len == 0)
+    return 1;
+
+  if (msgs == NULL
+      || msg_lens == NULL
+      || sigs == NULL
+      || sig_lens == NULL
+      || C1s == NULL
+      || C1_lens == NULL) {
+    return 0;
+  }
+
+  if (scratch == NULL)
+    scratch = tmp = goo_scratch_create(ctx);
+
+  S = goo_calloc(len, sizeof(goo_sig_t));
+  C1_n = goo_calloc(len, sizeof(mpz_t));
+
+  for (i = 0; i < len; i++) {
+    goo_sig_init(&S[i]);
+    mpz_init(C1_n[i]);
+
+    if (sigs[i] == NULL || C1s[i] == NULL)
+      continue;
+
+    if (C1_lens[i] != ctx->size)
+      continue;
+
+    goo_mpz_import(C1_n[i], C1s[i], C1_lens[i]);
+
+    /* A zero `t` fails the parameter checks. */
+    if (!goo_sig_import(&S[i], sigs[i], sig_lens[i], ctx->bits))
+      mpz_set_ui(S[i].t, 0);
+  }
+
+  r = goo_group_verify_batch(ctx, scratch, results,
+                             msgs, msg_lens, S, C1_n, len);
+
+  for (i = 0; i < len; i++) {
+    goo_sig_uninit(&S[i]);
+    mpz_clear(C1_n[i]);
+  }
+
+  goo_free(S);
+  goo_free(C1_n);
+  goo_scratch_destroy(tmp);
+
+  return r;
+}
+
+typedef struct goo_verify_many_s {
+  goo_group_t *ctx;
+  goo_scratch_t **scratch;
+  goo_verify_job_t *jobs;
+} goo_verify_many_t;
+
+static void
+goo_verify_many_work(void *arg, size_t index, size_t thread) {
+  goo_verify_many_t *state = (goo_verify_many_t *)arg;
+  goo_verify_job_t *job = &state->jobs[index];
+
+  job->result = goo_verify(state->ctx, state->scratch[thread],
+                           job->msg, job->msg_len,
+                           job->sig, job->sig_len,
+                           job->C1, job->C1_len);
+}
+
+int
+goo_verify_many(goo_group_t *ctx,
+                goo_verify_job_t *jobs,
+                size_t count,
+                size_t threads) {
+  /* Verify independent signatures on `threads` */
+  /* threads (zero picks the number of usable */
+  /* CPUs). The context is shared read-only; */
+  /* every thread gets its own scratch. */
+  goo_verify_many_t state;
+  size_t i;
+  int r = 1;
+
+  if (ctx == NULL || (jobs == NULL && count != 0))
+    return 0;
+
+  if (count == 0)
+    return 1;
+
+  threads = goo_pool_threads(threads, count);
+
+  state.ctx = ctx;
+  state.scratch = goo_calloc(threads, sizeof(goo_scratch_t *));
+  state.jobs = jobs;
+
+  for (i = 0; i < threads; i++)
+    state.scratch[i] = goo_scratch_create(ctx);
+
+  goo_pool_run(threads, count, goo_verify_many_work, &state);
+
+  for (i = 0; i < threads; i++)
+    goo_scratch_destroy(state.scratch[i]);
+
+  goo_free(state.scratch);
+
+  for (i = 0; i < count; i++)
+    r &= jobs[i].result;
+
   return r;
 }
 
@@ -3653,6 +7729,194 @@ fail:
   return r;
 }
 
+size_t
+goo_airdrop_size(const goo_group_t *ctx) {
+  if (ctx == NULL)
+    return 0;
+
+  /* s_prime || C1 || ct */
+  return 32 + ctx->size + GOO_CT_BYTES;
+}
+
+typedef struct goo_airdrop_s {
+  goo_group_t *ctx;
+  goo_scratch_t **scratch;
+  mpz_t *n; /* GOO_BATCH_SIZE temporaries per thread */
+  mpz_t *e;
+  mpz_t *s;
+  mpz_t *C1;
+  goo_airdrop_job_t *jobs;
+  size_t count;
+  const unsigned char *label;
+  size_t label_len;
+} goo_airdrop_t;
+
+static void
+goo_airdrop_work(void *arg, size_t index, size_t thread) {
+  /* Same steps as goo_generate(), goo_challenge() */
+  /* and goo_encrypt() for a block of jobs, but `n` */
+  /* is imported once, the commitments share comb */
+  /* passes and records are written in place. */
+  goo_airdrop_t *state = (goo_airdrop_t *)arg;
+  goo_group_t *ctx = state->ctx;
+  goo_scratch_t *scratch = state->scratch[thread];
+  size_t size = goo_airdrop_size(ctx);
+  size_t off = index * GOO_BATCH_SIZE;
+  size_t base = thread * GOO_BATCH_SIZE;
+  goo_airdrop_job_t *valid[GOO_BATCH_SIZE];
+  mpz_ptr C1s[GOO_BATCH_SIZE];
+  mpz_srcptr ns[GOO_BATCH_SIZE];
+  mpz_srcptr ss[GOO_BATCH_SIZE];
+  int ok[GOO_BATCH_SIZE];
+  size_t len = 0;
+  size_t i, k;
+
+  for (i = off; i < state->count && i < off + GOO_BATCH_SIZE; i++) {
+    goo_airdrop_job_t *job = &state->jobs[i];
+
+    job->result = 0;
+
+    if (job->n == NULL || job->e == NULL || job->entropy == NULL)
+      continue;
+
+    k = base + len;
+
+    goo_mpz_import(state->n[k], job->n, job->n_len);
+    goo_mpz_import(state->e[k], job->e, job->e_len);
+
+    /* Invalid RSA public key. */
+    if (!goo_is_valid_modulus(state->n[k]))
+      continue;
+
+    if (!goo_generate(ctx, job->out, job->entropy))
+      continue;
+
+    goo_group_expand_sprime(ctx, scratch, state->s[k], job->out);
+
+    valid[len] = job;
+    C1s[len] = state->C1[k];
+    ns[len] = state->n[k];
+    ss[len] = state->s[k];
+
+    len += 1;
+  }
+
+  /* C1 = g^n * h^s in G */
+  if (goo_group_powgh_batch(ctx, C1s, ns, ss, len)) {
+    for (i = 0; i < len; i++)
+      ok[i] = 1;
+  } else {
+    /* One bad exponent should not sink the block. */
+    for (i = 0; i < len; i++)
+      ok[i] = goo_group_powgh(ctx, scratch, C1s[i], ns[i], ss[i]);
+  }
+
+  for (i = 0; i < len; i++) {
+    goo_airdrop_job_t *job = valid[i];
+    unsigned char *s_prime = job->out;
+    unsigned char *C1 = s_prime + 32;
+    unsigned char *ct = C1 + ctx->size;
+
+    if (!ok[i])
+      continue;
+
+    k = base + i;
+
+    goo_group_reduce(ctx, state->C1[k], state->C1[k]);
+    goo_mpz_pad(C1, ctx->size, state->C1[k]);
+
+    if (!goo_encrypt_oaep_raw(ct, s_prime, 32,
+                              state->n[k], state->e[k],
+                              state->label, state->label_len,
+                              job->entropy + 32)) {
+      continue;
+    }
+
+    job->result = 1;
+  }
+
+  for (i = off; i < state->count && i < off + GOO_BATCH_SIZE; i++) {
+    if (!state->jobs[i].result)
+      goo_cleanse(state->jobs[i].out, size);
+  }
+}
+
+int
+goo_airdrop_many(goo_group_t *ctx,
+                 goo_airdrop_job_t *jobs,
+                 size_t count,
+                 const unsigned char *label,
+                 size_t label_len,
+                 size_t threads) {
+  /* Build airdrop records on `threads` threads (zero */
+  /* picks the number of usable CPUs), GOO_BATCH_SIZE */
+  /* jobs at a time. The context and its combs are */
+  /* shared; every thread gets its own scratch. A */
+  /* failed job leaves a zeroed record. */
+  goo_airdrop_t state;
+  size_t blocks, temps, i;
+  int r = 1;
+
+  if (ctx == NULL || (jobs == NULL && count != 0))
+    return 0;
+
+  for (i = 0; i < count; i++) {
+    if (jobs[i].out == NULL)
+      return 0;
+  }
+
+  if (count == 0)
+    return 1;
+
+  blocks = (count + GOO_BATCH_SIZE - 1) / GOO_BATCH_SIZE;
+  threads = goo_pool_threads(threads, blocks);
+  temps = threads * GOO_BATCH_SIZE;
+
+  state.ctx = ctx;
+  state.scratch = goo_calloc(threads, sizeof(goo_scratch_t *));
+  state.n = goo_calloc(temps, sizeof(mpz_t));
+  state.e = goo_calloc(temps, sizeof(mpz_t));
+  state.s = goo_calloc(temps, sizeof(mpz_t));
+  state.C1 = goo_calloc(temps, sizeof(mpz_t));
+  state.jobs = jobs;
+  state.count = count;
+  state.label = label;
+  state.label_len = label_len;
+
+  for (i = 0; i < threads; i++)
+    state.scratch[i] = goo_scratch_create(ctx);
+
+  for (i = 0; i < temps; i++) {
+    mpz_init(state.n[i]);
+    mpz_init(state.e[i]);
+    mpz_init(state.s[i]);
+    mpz_init(state.C1[i]);
+  }
+
+  goo_pool_run(threads, blocks, goo_airdrop_work, &state);
+
+  for (i = 0; i < threads; i++)
+    goo_scratch_destroy(state.scratch[i]);
+
+  for (i = 0; i < temps; i++) {
+    mpz_clear(state.n[i]);
+    mpz_clear(state.e[i]);
+    goo_mpz_clear(state.s[i]);
+    mpz_clear(state.C1[i]);
+  }
+
+  goo_free(state.scratch);
+  goo_free(state.n);
+  goo_free(state.e);
+  goo_free(state.s);
+  goo_free(state.C1);
+
+  for (i = 0; i < count; i++)
+    r &= jobs[i].result;
+
+  return r;
+}
+
 int
 goo_decrypt(goo_group_t *ctx,
             unsigned char **out,
@@ -3703,3 +7967,65 @@ fail:
   goo_mpz_clear(e_n);
   return r;
 }
+
+goo_decryptor_t *
+goo_decryptor_create(const unsigned char *p,
+                     size_t p_len,
+                     const unsigned char *q,
+                     size_t q_len,
+                     const unsigned char *e,
+                     size_t e_len,
+                     const unsigned char *entropy) {
+  /* Key state for repeated goo_decrypt() calls. */
+  /* Decryption updates the blinding pair, so a */
+  /* decryptor must not be shared between threads. */
+  goo_decryptor_t *key;
+  mpz_t p_n, q_n, e_n;
+
+  if (p == NULL || q == NULL || e == NULL || entropy == NULL)
+    return NULL;
+
+  mpz_init(p_n);
+  mpz_init(q_n);
+  mpz_init(e_n);
+
+  goo_mpz_import(p_n, p, p_len);
+  goo_mpz_import(q_n, q, q_len);
+  goo_mpz_import(e_n, e, e_len);
+
+  key = goo_malloc(sizeof(goo_decryptor_t));
+
+  if (!goo_decryptor_init(key, p_n, q_n, e_n, entropy)) {
+    goo_free(key);
+    key = NULL;
+  }
+
+  goo_mpz_clear(p_n);
+  goo_mpz_clear(q_n);
+  goo_mpz_clear(e_n);
+
+  return key;
+}
+
+void
+goo_decryptor_destroy(goo_decryptor_t *key) {
+  if (key != NULL) {
+    goo_decryptor_uninit(key);
+    goo_free(key);
+  }
+}
+
+int
+goo_decryptor_decrypt(goo_decryptor_t *key,
+                      unsigned char **out,
+                      size_t *out_len,
+                      const unsigned char *msg,
+                      size_t msg_len,
+                      const unsigned char *label,
+                      size_t label_len) {
+  if (key == NULL || out == NULL || out_len == NULL || msg == NULL)
+    return 0;
+
+  return goo_decryptor_oaep(key, out, out_len, msg, msg_len,
+                            label, label_len);
+}
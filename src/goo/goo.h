@@ -13,7 +13,37 @@
 extern "C" {
 #endif
 
+/* Supported RSA modulus sizes. */
+#define GOO_MIN_RSA_BITS 1024
+#define GOO_MAX_RSA_BITS 4096
+
 typedef struct goo_group_s goo_ctx_t;
+typedef struct goo_scratch_s goo_scratch_t;
+typedef struct goo_signer_s goo_signer_t;
+typedef struct goo_presig_s goo_presig_t;
+typedef struct goo_decryptor_s goo_decryptor_t;
+
+typedef struct goo_verify_job_s {
+  const unsigned char *msg;
+  size_t msg_len;
+  const unsigned char *sig;
+  size_t sig_len;
+  const unsigned char *C1;
+  size_t C1_len;
+  int result;
+} goo_verify_job_t;
+
+typedef struct goo_airdrop_job_s {
+  const unsigned char *n;
+  size_t n_len;
+  const unsigned char *e;
+  size_t e_len;
+  /* 64 bytes: goo_generate() entropy, then goo_encrypt() entropy. */
+  const unsigned char *entropy;
+  /* goo_airdrop_size() bytes: s_prime || C1 || ct. */
+  unsigned char *out;
+  int result;
+} goo_airdrop_job_t;
 
 goo_ctx_t *
 goo_create(const unsigned char *n,
@@ -25,6 +55,12 @@ goo_create(const unsigned char *n,
 void
 goo_destroy(goo_ctx_t *ctx);
 
+goo_scratch_t *
+goo_scratch_create(const goo_ctx_t *ctx);
+
+void
+goo_scratch_destroy(goo_scratch_t *scratch);
+
 int
 goo_generate(goo_ctx_t *ctx,
              unsigned char *s_prime,
@@ -32,6 +68,7 @@ goo_generate(goo_ctx_t *ctx,
 
 int
 goo_challenge(goo_ctx_t *ctx,
+              goo_scratch_t *scratch,
               unsigned char **C1,
               size_t *C1_len,
               const unsigned char *s_prime,
@@ -40,6 +77,7 @@ goo_challenge(goo_ctx_t *ctx,
 
 int
 goo_validate(goo_ctx_t *ctx,
+             goo_scratch_t *scratch,
              const unsigned char *s_prime,
              const unsigned char *C1,
              size_t C1_len,
@@ -50,6 +88,7 @@ goo_validate(goo_ctx_t *ctx,
 
 int
 goo_sign(goo_ctx_t *ctx,
+         goo_scratch_t *scratch,
          unsigned char **out,
          size_t *out_len,
          const unsigned char *msg,
@@ -60,8 +99,70 @@ goo_sign(goo_ctx_t *ctx,
          const unsigned char *q,
          size_t q_len);
 
+int
+goo_sign_parallel(goo_ctx_t *ctx,
+                  goo_scratch_t *scratch,
+                  unsigned char **out,
+                  size_t *out_len,
+                  const unsigned char *msg,
+                  size_t msg_len,
+                  const unsigned char *s_prime,
+                  const unsigned char *p,
+                  size_t p_len,
+                  const unsigned char *q,
+                  size_t q_len,
+                  size_t threads);
+
+goo_signer_t *
+goo_signer_create(goo_ctx_t *ctx,
+                  goo_scratch_t *scratch,
+                  const unsigned char *s_prime,
+                  const unsigned char *p,
+                  size_t p_len,
+                  const unsigned char *q,
+                  size_t q_len);
+
+void
+goo_signer_destroy(goo_signer_t *signer);
+
+int
+goo_signer_sign(goo_signer_t *signer,
+                goo_scratch_t *scratch,
+                unsigned char **out,
+                size_t *out_len,
+                const unsigned char *msg,
+                size_t msg_len,
+                size_t threads);
+
+goo_presig_t *
+goo_signer_presign(goo_signer_t *signer,
+                   goo_scratch_t *scratch,
+                   const unsigned char *entropy,
+                   size_t threads);
+
+int
+goo_signer_presign_many(goo_signer_t *signer,
+                        goo_presig_t **out,
+                        size_t count,
+                        const unsigned char *entropy,
+                        size_t threads);
+
+void
+goo_presig_destroy(goo_presig_t *presig);
+
+int
+goo_signer_sign_presig(goo_signer_t *signer,
+                       goo_scratch_t *scratch,
+                       goo_presig_t *presig,
+                       unsigned char **out,
+                       size_t *out_len,
+                       const unsigned char *msg,
+                       size_t msg_len,
+                       size_t threads);
+
 int
 goo_verify(goo_ctx_t *ctx,
+           goo_scratch_t *scratch,
            const unsigned char *msg,
            size_t msg_len,
            const unsigned char *sig,
@@ -69,6 +170,24 @@ goo_verify(goo_ctx_t *ctx,
            const unsigned char *C1,
            size_t C1_len);
 
+int
+goo_verify_batch(goo_ctx_t *ctx,
+                 goo_scratch_t *scratch,
+                 size_t len,
+                 const unsigned char *const *msgs,
+                 const size_t *msg_lens,
+                 const unsigned char *const *sigs,
+                 const size_t *sig_lens,
+                 const unsigned char *const *C1s,
+                 const size_t *C1_lens,
+                 int *results);
+
+int
+goo_verify_many(goo_ctx_t *ctx,
+                goo_verify_job_t *jobs,
+                size_t count,
+                size_t threads);
+
 int
 goo_encrypt(goo_ctx_t *ctx,
             unsigned char **out,
@@ -83,6 +202,17 @@ goo_encrypt(goo_ctx_t *ctx,
             size_t label_len,
             const unsigned char *entropy);
 
+size_t
+goo_airdrop_size(const goo_ctx_t *ctx);
+
+int
+goo_airdrop_many(goo_ctx_t *ctx,
+                 goo_airdrop_job_t *jobs,
+                 size_t count,
+                 const unsigned char *label,
+                 size_t label_len,
+                 size_t threads);
+
 int
 goo_decrypt(goo_ctx_t *ctx,
             unsigned char **out,
@@ -99,6 +229,27 @@ goo_decrypt(goo_ctx_t *ctx,
             size_t label_len,
             const unsigned char *entropy);
 
+goo_decryptor_t *
+goo_decryptor_create(const unsigned char *p,
+                     size_t p_len,
+                     const unsigned char *q,
+                     size_t q_len,
+                     const unsigned char *e,
+                     size_t e_len,
+                     const unsigned char *entropy);
+
+void
+goo_decryptor_destroy(goo_decryptor_t *key);
+
+int
+goo_decryptor_decrypt(goo_decryptor_t *key,
+                      unsigned char **out,
+                      size_t *out_len,
+                      const unsigned char *msg,
+                      size_t msg_len,
+                      const unsigned char *label,
+                      size_t label_len);
+
 /**
  * Moduli of unknown factorization.
  */
@@ -0,0 +1,503 @@
+/*!
+ * pool.c - work-stealing thread pool for C89
+ * Copyright (c) 2018-2019, Christopher Jeffrey (MIT License).
+ * https://github.com/handshake-org/goosig
+ *
+ * Resources:
+ *   https://www.kernel.org/doc/html/latest/admin-guide/cgroup-v2.html
+ *   https://www.kernel.org/doc/Documentation/scheduler/sched-bwc.txt
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+/* For sched_getaffinity(2) and CPU_COUNT. */
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(GOO_HAS_PTHREAD)
+#include <pthread.h>
+#endif
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+#include "pool.h"
+#include "util.h"
+
+#if defined(_WIN32) || defined(GOO_HAS_PTHREAD)
+#define GOO_POOL_THREADED
+#endif
+
+/*
+ * Mutex
+ */
+
+#if defined(_WIN32)
+typedef CRITICAL_SECTION goo_mutex_t;
+#define goo_mutex_init(m) InitializeCriticalSection(m)
+#define goo_mutex_destroy(m) DeleteCriticalSection(m)
+#define goo_mutex_lock(m) EnterCriticalSection(m)
+#define goo_mutex_unlock(m) LeaveCriticalSection(m)
+#elif defined(GOO_HAS_PTHREAD)
+typedef pthread_mutex_t goo_mutex_t;
+#define goo_mutex_init(m) ASSERT(pthread_mutex_init(m, NULL) == 0)
+#define goo_mutex_destroy(m) ASSERT(pthread_mutex_destroy(m) == 0)
+#define goo_mutex_lock(m) ASSERT(pthread_mutex_lock(m) == 0)
+#define goo_mutex_unlock(m) ASSERT(pthread_mutex_unlock(m) == 0)
+#else
+typedef int goo_mutex_t;
+#define goo_mutex_init(m) (void)(m)
+#define goo_mutex_destroy(m) (void)(m)
+#define goo_mutex_lock(m) (void)(m)
+#define goo_mutex_unlock(m) (void)(m)
+#endif
+
+/*
+ * CPU Count
+ */
+
+#if defined(__linux__)
+#define GOO_CGROUP_PATH 4096
+
+static int
+goo_read_words(const char *file, char *a, char *b) {
+  /* Read up to two words (of up to 31 characters). */
+  FILE *stream = fopen(file, "r");
+  int r;
+
+  if (stream == NULL)
+    return 0;
+
+  r = fscanf(stream, "%31s %31s", a, b);
+
+  fclose(stream);
+
+  return r > 0 ? r : 0;
+}
+
+static size_t
+goo_cgroup_quota(const char *quota, const char *period) {
+  /* ceil(quota / period), or zero for "unlimited". */
+  double q, p;
+
+  if (strcmp(quota, "max") == 0)
+    return 0;
+
+  q = atof(quota);
+  p = atof(period);
+
+  if (q <= 0 || p <= 0)
+    return 0;
+
+  return (size_t)((q + p - 1) / p);
+}
+
+static int
+goo_cgroup_path(char *out, size_t size) {
+  /* The process's cgroup v2 path (the "0::" entry). */
+  FILE *stream = fopen("/proc/self/cgroup", "r");
+  char line[GOO_CGROUP_PATH + 8];
+  size_t len;
+  int r = 0;
+
+  if (stream == NULL)
+    return 0;
+
+  while (fgets(line, sizeof(line), stream) != NULL) {
+    if (strncmp(line, "0::", 3) != 0)
+      continue;
+
+    len = strcspn(line + 3, "\n");
+
+    if (len < size) {
+      memcpy(out, line + 3, len);
+      out[len] = '\0';
+      r = 1;
+    }
+
+    break;
+  }
+
+  fclose(stream);
+
+  return r;
+}
+
+static size_t
+goo_cgroup_cpus(void) {
+  /* Derive a CPU limit from the CFS bandwidth quota. */
+  char path[GOO_CGROUP_PATH];
+  char file[GOO_CGROUP_PATH + 32];
+  char quota[32], period[32], tmp[32];
+  size_t cpus = 0;
+  size_t n;
+  int found = 0;
+  char *slash;
+
+  /* cgroup v2: "$MAX $PERIOD" or "max $PERIOD". A */
+  /* nested cgroup is bounded by each of its parents, */
+  /* so walk up from our own to the (namespace) root. */
+  if (!goo_cgroup_path(path, sizeof(path)) || strcmp(path, "/") == 0)
+    path[0] = '\0';
+
+  for (;;) {
+    sprintf(file, "/sys/fs/cgroup%s/cpu.max", path);
+
+    if (goo_read_words(file, quota, period) == 2) {
+      n = goo_cgroup_quota(quota, period);
+
+      if (n != 0 && (cpus == 0 || n < cpus))
+        cpus = n;
+
+      found = 1;
+    }
+
+    slash = strrchr(path, '/');
+
+    if (slash == NULL)
+      break;
+
+    *slash = '\0';
+  }
+
+  if (found)
+    return cpus;
+
+  /* cgroup v1: quota of -1 means "unlimited". */
+  if (goo_read_words("/sys/fs/cgroup/cpu/cpu.cfs_quota_us",
+                     quota, tmp) < 1) {
+    return 0;
+  }
+
+  if (goo_read_words("/sys/fs/cgroup/cpu/cpu.cfs_period_us",
+                     period, tmp) < 1) {
+    return 0;
+  }
+
+  return goo_cgroup_quota(quota, period);
+}
+#endif
+
+static size_t
+goo_pool_count(void) {
+  size_t count = 0;
+
+#if defined(_WIN32)
+  {
+    DWORD_PTR proc, sys;
+
+    if (GetProcessAffinityMask(GetCurrentProcess(), &proc, &sys)) {
+      while (proc != 0) {
+        count += 1;
+        proc &= proc - 1;
+      }
+    }
+
+    if (count == 0) {
+      SYSTEM_INFO info;
+      GetSystemInfo(&info);
+      count = info.dwNumberOfProcessors;
+    }
+  }
+#else
+#if defined(__linux__)
+  {
+    cpu_set_t set;
+    size_t quota;
+
+    CPU_ZERO(&set);
+
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+      count = CPU_COUNT(&set);
+
+    quota = goo_cgroup_cpus();
+
+    if (quota != 0 && (count == 0 || quota < count))
+      count = quota;
+  }
+#endif
+
+#if defined(_SC_NPROCESSORS_ONLN)
+  if (count == 0) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (n > 0)
+      count = n;
+  }
+#endif
+#endif
+
+  if (count == 0)
+    count = 1;
+
+  return count;
+}
+
+/* Counted once per process: later affinity or */
+/* quota changes are not seen. */
+static size_t goo_pool_ncpus = 0;
+
+static void
+goo_pool_cpus_init(void) {
+  goo_pool_ncpus = goo_pool_count();
+}
+
+#if defined(_WIN32)
+static INIT_ONCE goo_pool_once = INIT_ONCE_STATIC_INIT;
+
+static BOOL CALLBACK
+goo_pool_cpus_once(PINIT_ONCE once, PVOID param, PVOID *ctx) {
+  (void)once;
+  (void)param;
+  (void)ctx;
+  goo_pool_cpus_init();
+  return TRUE;
+}
+#elif defined(GOO_HAS_PTHREAD)
+static pthread_once_t goo_pool_once = PTHREAD_ONCE_INIT;
+#endif
+
+size_t
+goo_pool_cpus(void) {
+#if defined(_WIN32)
+  ASSERT(InitOnceExecuteOnce(&goo_pool_once, goo_pool_cpus_once,
+                             NULL, NULL));
+#elif defined(GOO_HAS_PTHREAD)
+  ASSERT(pthread_once(&goo_pool_once, goo_pool_cpus_init) == 0);
+#else
+  if (goo_pool_ncpus == 0)
+    goo_pool_cpus_init();
+#endif
+
+  return goo_pool_ncpus;
+}
+
+/*
+ * Pool
+ */
+
+typedef struct goo_range_s {
+  goo_mutex_t lock;
+  size_t begin;
+  size_t end;
+} goo_range_t;
+
+typedef struct goo_pool_s {
+  goo_pool_work_f *work;
+  void *arg;
+  size_t threads;
+  goo_range_t *ranges;
+} goo_pool_t;
+
+typedef struct goo_worker_s {
+  goo_pool_t *pool;
+  size_t id;
+} goo_worker_t;
+
+size_t
+goo_pool_threads(size_t threads, size_t count) {
+#ifdef GOO_POOL_THREADED
+  if (threads == 0)
+    threads = goo_pool_cpus();
+#else
+  threads = 1;
+#endif
+
+  if (threads > count)
+    threads = count;
+
+  if (threads == 0)
+    threads = 1;
+
+  return threads;
+}
+
+static int
+goo_pool_take(goo_range_t *range, size_t *index) {
+  int r = 0;
+
+  goo_mutex_lock(&range->lock);
+
+  if (range->begin < range->end) {
+    *index = range->begin;
+    range->begin += 1;
+    r = 1;
+  }
+
+  goo_mutex_unlock(&range->lock);
+
+  return r;
+}
+
+static int
+goo_pool_steal(goo_pool_t *pool, size_t id) {
+  /* Take the back half of another worker's range. */
+  goo_range_t *own = &pool->ranges[id];
+  size_t i;
+
+  for (i = 1; i < pool->threads; i++) {
+    goo_range_t *victim = &pool->ranges[(id + i) % pool->threads];
+    size_t begin = 0;
+    size_t end = 0;
+
+    goo_mutex_lock(&victim->lock);
+
+    if (victim->begin < victim->end) {
+      size_t half = (victim->end - victim->begin + 1) >> 1;
+
+      end = victim->end;
+      begin = end - half;
+
+      victim->end = begin;
+    }
+
+    goo_mutex_unlock(&victim->lock);
+
+    if (begin < end) {
+      goo_mutex_lock(&own->lock);
+      own->begin = begin;
+      own->end = end;
+      goo_mutex_unlock(&own->lock);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+static void
+goo_pool_work(goo_pool_t *pool, size_t id) {
+  goo_range_t *own = &pool->ranges[id];
+  size_t index;
+
+  for (;;) {
+    if (!goo_pool_take(own, &index)) {
+      if (!goo_pool_steal(pool, id))
+        break;
+      continue;
+    }
+
+    pool->work(pool->arg, index, id);
+  }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI
+goo_pool_thread(LPVOID ptr) {
+  goo_worker_t *worker = (goo_worker_t *)ptr;
+  goo_pool_work(worker->pool, worker->id);
+  return 0;
+}
+#elif defined(GOO_HAS_PTHREAD)
+static void *
+goo_pool_thread(void *ptr) {
+  goo_worker_t *worker = (goo_worker_t *)ptr;
+  goo_pool_work(worker->pool, worker->id);
+  return NULL;
+}
+#endif
+
+void
+goo_pool_run(size_t threads,
+             size_t count,
+             goo_pool_work_f *work,
+             void *arg) {
+  goo_pool_t pool;
+  size_t i;
+
+  if (count == 0)
+    return;
+
+  threads = goo_pool_threads(threads, count);
+
+  pool.work = work;
+  pool.arg = arg;
+  pool.threads = threads;
+  pool.ranges = (goo_range_t *)malloc(threads * sizeof(goo_range_t));
+
+  ASSERT(pool.ranges != NULL);
+
+  /* Split the indices evenly to begin with. */
+  for (i = 0; i < threads; i++) {
+    goo_range_t *range = &pool.ranges[i];
+    size_t extra = count % threads;
+
+    goo_mutex_init(&range->lock);
+
+    range->begin = i * (count / threads) + (i < extra ? i : extra);
+    range->end = range->begin + count / threads + (i < extra);
+  }
+
+#ifdef GOO_POOL_THREADED
+  if (threads > 1) {
+    goo_worker_t *workers;
+#if defined(_WIN32)
+    HANDLE *handles;
+#else
+    pthread_t *handles;
+#endif
+    int *started;
+
+    workers = (goo_worker_t *)malloc(threads * sizeof(goo_worker_t));
+#if defined(_WIN32)
+    handles = (HANDLE *)malloc(threads * sizeof(HANDLE));
+#else
+    handles = (pthread_t *)malloc(threads * sizeof(pthread_t));
+#endif
+    started = (int *)calloc(threads, sizeof(int));
+
+    ASSERT(workers != NULL && handles != NULL && started != NULL);
+
+    /* The calling thread acts as worker zero. If a */
+    /* thread fails to spawn, its range is stolen. */
+    for (i = 1; i < threads; i++) {
+      workers[i].pool = &pool;
+      workers[i].id = i;
+#if defined(_WIN32)
+      handles[i] = CreateThread(NULL, 0, goo_pool_thread,
+                                &workers[i], 0, NULL);
+      started[i] = (handles[i] != NULL);
+#else
+      started[i] = (pthread_create(&handles[i], NULL, goo_pool_thread,
+                                   &workers[i]) == 0);
+#endif
+    }
+
+    goo_pool_work(&pool, 0);
+
+    for (i = 1; i < threads; i++) {
+      if (!started[i])
+        continue;
+#if defined(_WIN32)
+      WaitForSingleObject(handles[i], INFINITE);
+      CloseHandle(handles[i]);
+#else
+      ASSERT(pthread_join(handles[i], NULL) == 0);
+#endif
+    }
+
+    free(workers);
+    free(handles);
+    free(started);
+  } else {
+    goo_pool_work(&pool, 0);
+  }
+#else
+  goo_pool_work(&pool, 0);
+#endif
+
+  for (i = 0; i < threads; i++)
+    goo_mutex_destroy(&pool.ranges[i].lock);
+
+  free(pool.ranges);
+}
@@ -0,0 +1,36 @@
+/*!
+ * pool.c - work-stealing thread pool for C89
+ * Copyright (c) 2018-2019, Christopher Jeffrey (MIT License).
+ * https://github.com/handshake-org/goosig
+ */
+
+#ifndef _GOOSIG_POOL_H
+#define _GOOSIG_POOL_H
+
+#include <stdlib.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Called once for every index in [0, count). `thread` */
+/* is in [0, threads) and identifies the calling worker. */
+typedef void goo_pool_work_f(void *arg, size_t index, size_t thread);
+
+size_t
+goo_pool_cpus(void);
+
+size_t
+goo_pool_threads(size_t threads, size_t count);
+
+void
+goo_pool_run(size_t threads,
+             size_t count,
+             goo_pool_work_f *work,
+             void *arg);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
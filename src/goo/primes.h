@@ -16,6 +16,7 @@
 
 #define GOO_PRIMES_LEN 168
 #define GOO_TEST_PRIMES_LEN 1000
+#define GOO_TEST_PRIMORIAL_LEN 353
 
 static unsigned long goo_primes[168] = {
   2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67, 71,
@@ -109,4 +110,68 @@ static unsigned long goo_test_primes[1000] = {
   7841, 7853, 7867, 7873, 7877, 7879, 7883, 7901, 7907, 7919
 };
 
+/* Product of goo_test_primes[1..999], as 32 bit */
+/* words in little-endian order. */
+static const uint32_t goo_test_primorial[GOO_TEST_PRIMORIAL_LEN] = {
+  0x6f1a47e9, 0x7a9f35fc, 0xbf09e293, 0x4ed8b423, 0xb9fc337d, 0x45f3d5fb,
+  0xece27788, 0x451ca8bf, 0xf68426bd, 0x8b0ffe7a, 0x79146e63, 0xc36a7c9a,
+  0x30996a8b, 0x50bd2e44, 0xde94796c, 0xc838de47, 0x729c2116, 0xfa7ae7ce,
+  0x3d555ec9, 0xb95c7cc7, 0xb41e8286, 0x90cc1a38, 0xdb407d4c, 0x4d575683,
+  0xa59f1d35, 0x89258bc9, 0x37730ecb, 0xed7d4f2b, 0xcaace3e0, 0x9cc12868,
+  0x9db7a925, 0xd1341a27, 0x9e068853, 0x0f8aa63f, 0xcd25879d, 0xf3b96132,
+  0x6a1eff84, 0xaa5e65b3, 0x2062c2f5, 0xfdcb3127, 0xe7c788f9, 0x55f6e0cb,
+  0x2964eafd, 0xe9e223f8, 0x2922b1ba, 0x4174d047, 0x800ed45c, 0xd4c52323,
+  0xc0aaba21, 0x8229a404, 0xe9b9f253, 0xeb80eda9, 0x51cc424d, 0xbcbe45c8,
+  0x067a8f8e, 0x8f8da862, 0x691b3a86, 0xfe4b35fe, 0xded9f74f, 0x2f84e750,
+  0xca6870ac, 0xd7ec0f25, 0x311daafa, 0x3119f073, 0xea77e55e, 0x4f1d147a,
+  0x54bd2d4f, 0x3003f45d, 0x94c3b2e3, 0xbfa7ef95, 0x8adce2d3, 0x5b406ce3,
+  0x85802c55, 0xc11fa609, 0x7e416c0b, 0xc09e2c60, 0xe20d185e, 0xa73b9ae7,
+  0x55d75547, 0x79fc7c36, 0x963bb384, 0xcf28d1be, 0x35593978, 0x14d53a57,
+  0x0fd48763, 0xeba31a37, 0x19d53fa2, 0x29ee3f8a, 0x84121658, 0x5071e3dc,
+  0x95314a90, 0x0b4f560b, 0x4cc04eeb, 0xa452577e, 0xd0384a3c, 0x31e481a8,
+  0x5808c60e, 0x3e9c83e8, 0x78059326, 0x83dd0785, 0x9b99d2f9, 0xf16950bb,
+  0x2468bb62, 0x18f78e2e, 0x999c1961, 0x74a41593, 0xb960726e, 0x22ec8106,
+  0x7f1a4982, 0xb39f90ab, 0xf7e6c0c3, 0x4e8c679a, 0xe2a19c44, 0xd0715d62,
+  0x0a0e9161, 0x6c1fd594, 0xdf27faa7, 0x884d20f8, 0xee251ba2, 0x7cfc486e,
+  0x90ad1e95, 0xb3885328, 0xa81bceb0, 0x51cdb5cd, 0xc99fb42b, 0xf80d369a,
+  0x6058bef8, 0x6d1e1385, 0xe60c9215, 0x8be859ef, 0x672e0abb, 0xc128b257,
+  0xd1357035, 0x16443175, 0x41d23b30, 0x78fa6134, 0x52dea5d9, 0x39b33dad,
+  0xc12fb88f, 0xfcbee008, 0xb9d6ffa6, 0x19b8888d, 0x453b96eb, 0x663b77e4,
+  0x9dabef49, 0x73205302, 0xc1408913, 0x08ce480c, 0xcd39f570, 0x03cf8978,
+  0xbe3ceff7, 0x87f88ea8, 0x88a462c1, 0x7bb4031c, 0x019aac2b, 0xb11c634a,
+  0xf3499b5e, 0xa85ad52f, 0xc528e998, 0x5148e116, 0x8edd6297, 0x0a5463e1,
+  0x43e06cf5, 0x9d0dc036, 0x6c910eb0, 0x563e2ccd, 0x2955abf6, 0xa9efe93e,
+  0xa2eb02c0, 0xe5add89d, 0x918d5f39, 0x88015fe6, 0xf8dcf30e, 0xcd6efa5c,
+  0x3a3abc67, 0x3ce932a8, 0x2e0628bf, 0x650e1430, 0x50148dd7, 0xe23aa2bc,
+  0x27ebe1c9, 0x235db7df, 0xa1bc19f4, 0x9b8ac5f4, 0x7062dd39, 0xfc7e74a0,
+  0x28db0eac, 0xc57d5d73, 0x8be4e1aa, 0x02ef67db, 0x7697252f, 0x60ebcf1f,
+  0x67d08924, 0xecc0f600, 0x7d0fcf24, 0xaa3d1d77, 0xe361f161, 0x8f483f09,
+  0xb8bdb3d6, 0x1a7417cf, 0xc58331e2, 0xaf8161a2, 0xa568d853, 0x7cf688e8,
+  0x27fda790, 0xa478fcd0, 0x95d4b554, 0x2464c070, 0x13a58541, 0xaf972185,
+  0x131a18f8, 0xbc850212, 0x003981f0, 0xd829f890, 0x82dac094, 0x22803eb6,
+  0x981d65c2, 0x168a2384, 0xe5dc8692, 0x6526bbdd, 0x1b0adbbc, 0x62ef088d,
+  0x06a1cde0, 0xbe2dc2f8, 0x84b98f64, 0xf833877a, 0xef1a359f, 0x55259b85,
+  0x9bc16201, 0x9928dbdd, 0x6683d15b, 0x2435bcde, 0x71d07f9d, 0x81e1f6b2,
+  0x44f7eb51, 0x7341bd96, 0x49659c81, 0x7eeb7208, 0xf32b1844, 0x03f2ff76,
+  0x92e7a9bf, 0x9a18991a, 0xb6486237, 0xce4b3cf3, 0xf98a3e87, 0x2c088842,
+  0x48810daa, 0x45a65f98, 0xeaacb329, 0xacb10f21, 0x81e11db4, 0xb29e3eea,
+  0x2334eec4, 0xc4432471, 0x6fbd3999, 0xcd272be0, 0x93cfd3da, 0xdd095afe,
+  0x41bdf893, 0x044a7f9f, 0x322c3c67, 0x40e4889d, 0x56ca79be, 0xaab30d74,
+  0x8a172dd9, 0x97dde857, 0x2468af02, 0xc41cc8a3, 0xa63f5ae0, 0xe3246dcb,
+  0x496c128a, 0xe3cb0170, 0xfac5e8e2, 0x23bd97e7, 0x3e0c8360, 0xe11e780f,
+  0x702b4cf7, 0x45b86206, 0x0dacb5ff, 0xe40646f7, 0x214ca202, 0xe2612b1c,
+  0xed786be0, 0x5f88ba54, 0x3bc948dd, 0x397391be, 0x1fabf86c, 0x6d44c063,
+  0x600de6eb, 0x36b44878, 0xd0667e1f, 0x505afcbc, 0x6a92f458, 0xd03f95a3,
+  0x88a1df79, 0xb419a236, 0xc1a3edcd, 0x1a104304, 0x66196d5d, 0xaaad3a08,
+  0x8b1ef118, 0x0af1de1f, 0xd6fe8bb6, 0xea706ec5, 0xe8d81f11, 0xab7e6619,
+  0x91f435ab, 0x714a35b7, 0x68706899, 0x488cd429, 0x526f2be1, 0xf25447d8,
+  0xaf70924a, 0x96af62b2, 0x5ec61b43, 0xd771f622, 0x5a91ce12, 0xef44522e,
+  0xc76809a7, 0x097f9be0, 0x68257a48, 0xe6b147c7, 0x3aba5fca, 0xf5ddbb9e,
+  0xaae9558f, 0xd4e657f8, 0x9dd2123a, 0x7281d187, 0xeddcdd92, 0xa542ab9a,
+  0x15881d91, 0x885a7b90, 0x3f18d7f6, 0xd61b3358, 0x5b2238a6, 0x0ae8ebc9,
+  0x7b4d55bf, 0x75f203a2, 0xde51c4fe, 0xe11c6a52, 0xbb1906d2, 0x7d832991,
+  0x9722bd08, 0x035d78e5, 0xea7829fe, 0x8855dca6, 0xd8f6da1d, 0xf38a1a56,
+  0x5b1072e4, 0x2f6f188d, 0xdf137f31, 0x8bebf339, 0x00000035
+};
+
 #endif
@@ -0,0 +1,393 @@
+/*!
+ * scan.c - parallel trial decryption for C89
+ * Copyright (c) 2018-2019, Christopher Jeffrey (MIT License).
+ * https://github.com/handshake-org/goosig
+ */
+
+#if defined(__unix__) && !defined(_POSIX_C_SOURCE)
+/* For mmap(2). */
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define GOO_SCAN_MMAP
+#endif
+
+#include "internal.h"
+#include "goo.h"
+#include "pool.h"
+#include "scan.h"
+#include "sha256.h"
+#include "util.h"
+
+#if GOO_SCAN_SIZE != GOO_CT_BYTES
+#error "GOO_SCAN_SIZE must match GOO_CT_BYTES"
+#endif
+
+/*
+ * File Mapping
+ */
+
+typedef struct goo_map_s {
+  const unsigned char *data;
+  size_t len;
+  int mapped; /* otherwise `data` was read into memory */
+#if defined(_WIN32)
+  HANDLE file;
+  HANDLE mapping;
+#endif
+} goo_map_t;
+
+static int
+goo_map_read(goo_map_t *map, const char *file) {
+  /* Fallback: read the whole file. */
+  FILE *stream = fopen(file, "rb");
+  unsigned char *data = NULL;
+  size_t len = 0;
+  size_t size = 1 << 16;
+  size_t nread;
+
+  if (stream == NULL)
+    return 0;
+
+  for (;;) {
+    unsigned char *tmp = (unsigned char *)realloc(data, size);
+
+    if (tmp == NULL) {
+      free(data);
+      fclose(stream);
+      return 0;
+    }
+
+    data = tmp;
+    nread = fread(data + len, 1, size - len, stream);
+    len += nread;
+
+    if (len < size)
+      break;
+
+    size *= 2;
+  }
+
+  if (ferror(stream)) {
+    free(data);
+    fclose(stream);
+    return 0;
+  }
+
+  fclose(stream);
+
+  map->data = data;
+  map->len = len;
+  map->mapped = 0;
+
+  return 1;
+}
+
+static int
+goo_map_open(goo_map_t *map, const char *file) {
+  map->data = NULL;
+  map->len = 0;
+  map->mapped = 0;
+
+#if defined(_WIN32)
+  {
+    LARGE_INTEGER size;
+    void *view;
+
+    map->file = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+    if (map->file == INVALID_HANDLE_VALUE)
+      return 0;
+
+    if (!GetFileSizeEx(map->file, &size)) {
+      CloseHandle(map->file);
+      return 0;
+    }
+
+    if (size.QuadPart == 0) {
+      CloseHandle(map->file);
+      return 1;
+    }
+
+    if ((unsigned __int64)size.QuadPart > (size_t)-1) {
+      CloseHandle(map->file);
+      return 0;
+    }
+
+    map->mapping = CreateFileMappingA(map->file, NULL, PAGE_READONLY,
+                                      0, 0, NULL);
+
+    if (map->mapping == NULL) {
+      CloseHandle(map->file);
+      return goo_map_read(map, file);
+    }
+
+    view = MapViewOfFile(map->mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (view == NULL) {
+      CloseHandle(map->mapping);
+      CloseHandle(map->file);
+      return goo_map_read(map, file);
+    }
+
+    map->data = (const unsigned char *)view;
+    map->len = (size_t)size.QuadPart;
+    map->mapped = 1;
+
+    return 1;
+  }
+#elif defined(GOO_SCAN_MMAP)
+  {
+    struct stat st;
+    void *addr;
+    int fd;
+
+    fd = open(file, O_RDONLY);
+
+    if (fd < 0)
+      return 0;
+
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+      close(fd);
+      return goo_map_read(map, file);
+    }
+
+    if (st.st_size == 0) {
+      close(fd);
+      return 1;
+    }
+
+    if ((unsigned long)st.st_size > (size_t)-1) {
+      close(fd);
+      return 0;
+    }
+
+    addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    /* The mapping outlives the descriptor. */
+    close(fd);
+
+    if (addr == MAP_FAILED)
+      return goo_map_read(map, file);
+
+#if defined(POSIX_MADV_SEQUENTIAL)
+    /* Each thread walks its own range in order. */
+    posix_madvise(addr, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+#endif
+
+    map->data = (const unsigned char *)addr;
+    map->len = (size_t)st.st_size;
+    map->mapped = 1;
+
+    return 1;
+  }
+#else
+  return goo_map_read(map, file);
+#endif
+}
+
+static void
+goo_map_close(goo_map_t *map) {
+  if (map->mapped) {
+#if defined(_WIN32)
+    UnmapViewOfFile((void *)map->data);
+    CloseHandle(map->mapping);
+    CloseHandle(map->file);
+#elif defined(GOO_SCAN_MMAP)
+    munmap((void *)map->data, map->len);
+#endif
+  } else {
+    free((void *)map->data);
+  }
+
+  map->data = NULL;
+  map->len = 0;
+  map->mapped = 0;
+}
+
+/*
+ * Scan
+ */
+
+typedef struct goo_scan_s {
+  goo_decryptor_t **keys; /* one per thread */
+  const unsigned char *data;
+  const unsigned char *label;
+  size_t label_len;
+  unsigned char *found;
+} goo_scan_t;
+
+static void
+goo_scan_work(void *arg, size_t index, size_t thread) {
+  goo_scan_t *scan = (goo_scan_t *)arg;
+  const unsigned char *ct = &scan->data[index * GOO_SCAN_SIZE];
+  unsigned char *pt;
+  size_t pt_len;
+
+  if (!goo_decryptor_decrypt(scan->keys[thread], &pt, &pt_len,
+                             ct, GOO_SCAN_SIZE,
+                             scan->label, scan->label_len)) {
+    return;
+  }
+
+  scan->found[index] = 1;
+
+  /* The plaintext is a secret. */
+  goo_cleanse(pt, pt_len);
+
+  free(pt);
+}
+
+int
+goo_scan(size_t **indices,
+         size_t *count,
+         const unsigned char *data,
+         size_t len,
+         const unsigned char *p,
+         size_t p_len,
+         const unsigned char *q,
+         size_t q_len,
+         const unsigned char *e,
+         size_t e_len,
+         const unsigned char *label,
+         size_t label_len,
+         const unsigned char *entropy,
+         size_t threads) {
+  /* Trial-decrypt every GOO_SCAN_SIZE-byte ciphertext */
+  /* in `data` on `threads` threads (zero picks the */
+  /* number of usable CPUs), each with its own key */
+  /* state. The indices of those that decrypt are */
+  /* returned in ascending order (free() them). */
+  goo_decryptor_t **keys = NULL;
+  unsigned char *found = NULL;
+  unsigned char seed[32];
+  goo_sha256_t ctx;
+  goo_scan_t scan;
+  size_t total, matches, i, j;
+  int r = 0;
+
+  if (indices == NULL
+      || count == NULL
+      || (data == NULL && len != 0)
+      || entropy == NULL) {
+    return 0;
+  }
+
+  if (len % GOO_SCAN_SIZE != 0)
+    return 0;
+
+  total = len / GOO_SCAN_SIZE;
+  threads = goo_pool_threads(threads, total);
+
+  keys = (goo_decryptor_t **)calloc(threads, sizeof(goo_decryptor_t *));
+  found = (unsigned char *)calloc(total + 1, 1);
+
+  ASSERT(keys != NULL && found != NULL);
+
+  /* Each thread blinds from its own seed. */
+  for (i = 0; i < threads; i++) {
+    unsigned char index[4];
+
+    index[0] = (i >> 24) & 0xff;
+    index[1] = (i >> 16) & 0xff;
+    index[2] = (i >> 8) & 0xff;
+    index[3] = i & 0xff;
+
+    goo_sha256_init(&ctx);
+    goo_sha256_update(&ctx, entropy, 32);
+    goo_sha256_update(&ctx, index, sizeof(index));
+    goo_sha256_final(&ctx, seed);
+
+    keys[i] = goo_decryptor_create(p, p_len, q, q_len, e, e_len, seed);
+
+    if (keys[i] == NULL)
+      goto fail;
+  }
+
+  scan.keys = keys;
+  scan.data = data;
+  scan.label = label;
+  scan.label_len = label_len;
+  scan.found = found;
+
+  goo_pool_run(threads, total, goo_scan_work, &scan);
+
+  matches = 0;
+
+  for (i = 0; i < total; i++)
+    matches += found[i];
+
+  *indices = (size_t *)malloc((matches + 1) * sizeof(size_t));
+
+  ASSERT(*indices != NULL);
+
+  for (i = 0, j = 0; i < total; i++) {
+    if (found[i])
+      (*indices)[j++] = i;
+  }
+
+  *count = matches;
+
+  r = 1;
+fail:
+  for (i = 0; i < threads; i++)
+    goo_decryptor_destroy(keys[i]);
+
+  goo_cleanse(seed, sizeof(seed));
+  goo_cleanse(&ctx, sizeof(ctx));
+
+  free(keys);
+  free(found);
+
+  return r;
+}
+
+int
+goo_scan_file(size_t **indices,
+              size_t *count,
+              size_t *total,
+              const char *file,
+              const unsigned char *p,
+              size_t p_len,
+              const unsigned char *q,
+              size_t q_len,
+              const unsigned char *e,
+              size_t e_len,
+              const unsigned char *label,
+              size_t label_len,
+              const unsigned char *entropy,
+              size_t threads) {
+  /* goo_scan() over a memory-mapped file. */
+  goo_map_t map;
+  int r;
+
+  if (file == NULL || total == NULL)
+    return 0;
+
+  if (!goo_map_open(&map, file))
+    return 0;
+
+  r = goo_scan(indices, count, map.data, map.len,
+               p, p_len, q, q_len, e, e_len,
+               label, label_len, entropy, threads);
+
+  if (r)
+    *total = map.len / GOO_SCAN_SIZE;
+
+  goo_map_close(&map);
+
+  return r;
+}
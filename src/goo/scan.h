@@ -0,0 +1,55 @@
+/*!
+ * scan.h - parallel trial decryption for C89
+ * Copyright (c) 2018-2019, Christopher Jeffrey (MIT License).
+ * https://github.com/handshake-org/goosig
+ */
+
+#ifndef _GOOSIG_SCAN_H
+#define _GOOSIG_SCAN_H
+
+#include <stdlib.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Size of one ciphertext: a veiled 4096-bit integer. */
+#define GOO_SCAN_SIZE ((4096 + 8 + 7) / 8)
+
+int
+goo_scan(size_t **indices,
+         size_t *count,
+         const unsigned char *data,
+         size_t len,
+         const unsigned char *p,
+         size_t p_len,
+         const unsigned char *q,
+         size_t q_len,
+         const unsigned char *e,
+         size_t e_len,
+         const unsigned char *label,
+         size_t label_len,
+         const unsigned char *entropy,
+         size_t threads);
+
+int
+goo_scan_file(size_t **indices,
+              size_t *count,
+              size_t *total,
+              const char *file,
+              const unsigned char *p,
+              size_t p_len,
+              const unsigned char *q,
+              size_t q_len,
+              const unsigned char *e,
+              size_t e_len,
+              const unsigned char *label,
+              size_t label_len,
+              const unsigned char *entropy,
+              size_t threads);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -6,13 +6,35 @@
  * Resources:
  *   https://en.wikipedia.org/wiki/SHA-2
  *   https://tools.ietf.org/html/rfc4634
+ *   https://software.intel.com/en-us/articles/intel-sha-extensions
+ *   https://github.com/noloader/SHA-Intrinsics
  */
 
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(GOO_HAS_PTHREAD)
+#include <pthread.h>
+#endif
+
 #include "sha256.h"
 
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define GOO_SHA256_X86
+#endif
+
+typedef void goo_sha256_transform_f(uint32_t *state,
+                                    const unsigned char *chunk,
+                                    size_t blocks);
+
+typedef void goo_sha256_multi_f(uint32_t **state,
+                                const unsigned char **chunk,
+                                size_t blocks);
+
 static const uint32_t K[64] = {
   0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
   0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
@@ -65,20 +87,6 @@ goo_sha256_init(goo_sha256_t *ctx) {
   ctx->size = 0;
 }
 
-static void
-goo_sha256_transform(goo_sha256_t *ctx, const unsigned char *chunk) {
-  uint32_t W[64];
-  uint32_t a = ctx->state[0];
-  uint32_t b = ctx->state[1];
-  uint32_t c = ctx->state[2];
-  uint32_t d = ctx->state[3];
-  uint32_t e = ctx->state[4];
-  uint32_t f = ctx->state[5];
-  uint32_t g = ctx->state[6];
-  uint32_t h = ctx->state[7];
-  uint32_t t1, t2;
-  size_t i = 0;
-
 #define Sigma0(x) \
   ((x >> 2 | x << 30) ^ (x >> 13 | x << 19) ^ (x >> 22 | x << 10))
 #define Sigma1(x) \
@@ -88,44 +96,611 @@ goo_sha256_transform(goo_sha256_t *ctx, const unsigned char *chunk) {
 #define Ch(x, y, z) (z ^ (x & (y ^ z)))
 #define Maj(x, y, z) ((x & y) | (z & (x | y)))
 
-  for (; i < 16; i++)
-    W[i] = read32(chunk + i * 4);
+#define GOO_SHA256_ROUNDS(state, WK) do {                 \
+  uint32_t a = state[0];                                  \
+  uint32_t b = state[1];                                  \
+  uint32_t c = state[2];                                  \
+  uint32_t d = state[3];                                  \
+  uint32_t e = state[4];                                  \
+  uint32_t f = state[5];                                  \
+  uint32_t g = state[6];                                  \
+  uint32_t h = state[7];                                  \
+  uint32_t t1, t2;                                        \
+  size_t r;                                               \
+                                                          \
+  for (r = 0; r < 64; r++) {                              \
+    t1 = h + Sigma1(e) + Ch(e, f, g) + WK[r];             \
+    t2 = Sigma0(a) + Maj(a, b, c);                        \
+                                                          \
+    h = g;                                                \
+    g = f;                                                \
+    f = e;                                                \
+                                                          \
+    e = d + t1;                                           \
+                                                          \
+    d = c;                                                \
+    c = b;                                                \
+    b = a;                                                \
+                                                          \
+    a = t1 + t2;                                          \
+  }                                                       \
+                                                          \
+  state[0] += a;                                          \
+  state[1] += b;                                          \
+  state[2] += c;                                          \
+  state[3] += d;                                          \
+  state[4] += e;                                          \
+  state[5] += f;                                          \
+  state[6] += g;                                          \
+  state[7] += h;                                          \
+} while (0)
+
+static void
+goo_sha256_transform_generic(uint32_t *state,
+                             const unsigned char *chunk,
+                             size_t blocks) {
+  uint32_t W[64];
+  size_t i;
+
+  while (blocks--) {
+    for (i = 0; i < 16; i++)
+      W[i] = read32(chunk + i * 4);
+
+    for (; i < 64; i++)
+      W[i] = sigma1(W[i - 2]) + W[i - 7] + sigma0(W[i - 15]) + W[i - 16];
+
+    for (i = 0; i < 64; i++)
+      W[i] += K[i];
+
+    GOO_SHA256_ROUNDS(state, W);
+
+    chunk += 64;
+  }
+}
+
+#ifdef GOO_SHA256_X86
+__attribute__((target("avx2,bmi2")))
+static void
+goo_sha256_transform_avx2(uint32_t *state,
+                          const unsigned char *chunk,
+                          size_t blocks) {
+  /* The message schedule of two blocks is computed
+   * at once, one block per 128-bit lane, four words
+   * at a time. The rounds themselves are inherently
+   * serial and stay scalar (BMI2 gives us rorx).
+   *
+   * An odd trailing block is scheduled twice and
+   * the copy is discarded.
+   */
+  static const unsigned char bswap[32] = {
+    3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+    3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+  };
+  const __m256i mask = _mm256_loadu_si256((const __m256i *)bswap);
+  uint32_t WK[2][64];
+  __m256i X[4];
+  size_t i, j;
+
+#define ror(x, n) \
+  _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n))
+#define vsigma0(x) _mm256_xor_si256(_mm256_xor_si256(ror(x, 7), \
+  ror(x, 18)), _mm256_srli_epi32(x, 3))
+#define vsigma1(x) _mm256_xor_si256(_mm256_xor_si256(ror(x, 17), \
+  ror(x, 19)), _mm256_srli_epi32(x, 10))
+
+  while (blocks > 0) {
+    const unsigned char *next = blocks > 1 ? chunk + 64 : chunk;
+
+    for (i = 0; i < 4; i++) {
+      __m128i lo = _mm_loadu_si128((const __m128i *)(chunk + i * 16));
+      __m128i hi = _mm_loadu_si128((const __m128i *)(next + i * 16));
+
+      X[i] = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+      X[i] = _mm256_shuffle_epi8(X[i], mask);
+    }
+
+    for (i = 0; i < 64; i += 4) {
+      __m256i k = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *)&K[i]));
+      __m256i wk = _mm256_add_epi32(X[0], k);
+
+      _mm_storeu_si128((__m128i *)&WK[0][i], _mm256_castsi256_si128(wk));
+      _mm_storeu_si128((__m128i *)&WK[1][i], _mm256_extracti128_si256(wk, 1));
+
+      if (i < 48) {
+        /* W[t..t+3] from W[t-16..t-1]. */
+        __m256i w15 = _mm256_alignr_epi8(X[1], X[0], 4);
+        __m256i w7 = _mm256_alignr_epi8(X[3], X[2], 4);
+        __m256i t = _mm256_add_epi32(_mm256_add_epi32(X[0], w7),
+                                     vsigma0(w15));
+
+        t = _mm256_add_epi32(t, vsigma1(_mm256_srli_si256(X[3], 8)));
+        t = _mm256_add_epi32(t, vsigma1(_mm256_slli_si256(t, 8)));
+
+        for (j = 0; j < 3; j++)
+          X[j] = X[j + 1];
+
+        X[3] = t;
+      } else {
+        for (j = 0; j < 3; j++)
+          X[j] = X[j + 1];
+      }
+    }
+
+    GOO_SHA256_ROUNDS(state, WK[0]);
+
+    if (blocks == 1)
+      break;
+
+    GOO_SHA256_ROUNDS(state, WK[1]);
+
+    chunk += 128;
+    blocks -= 2;
+  }
+
+#undef ror
+#undef vsigma0
+#undef vsigma1
+}
+
+__attribute__((target("sha,sse4.1")))
+static void
+goo_sha256_transform_shani(uint32_t *state,
+                           const unsigned char *chunk,
+                           size_t blocks) {
+  /* SHA extensions: sha256rnds2 performs two rounds
+   * on the state held as ABEF/CDGH; msg1/msg2 do the
+   * message schedule four words at a time.
+   */
+  static const unsigned char bswap[16] = {
+    3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+  };
+  const __m128i mask = _mm_loadu_si128((const __m128i *)bswap);
+  __m128i state0, state1, save0, save1, tmp, msg;
+  __m128i M[4];
+  size_t i;
+
+  tmp = _mm_loadu_si128((const __m128i *)&state[0]);
+  state1 = _mm_loadu_si128((const __m128i *)&state[4]);
+
+  tmp = _mm_shuffle_epi32(tmp, 0xb1); /* CDAB */
+  state1 = _mm_shuffle_epi32(state1, 0x1b); /* EFGH */
+  state0 = _mm_alignr_epi8(tmp, state1, 8); /* ABEF */
+  state1 = _mm_blend_epi16(state1, tmp, 0xf0); /* CDGH */
+
+  while (blocks--) {
+    save0 = state0;
+    save1 = state1;
+
+    for (i = 0; i < 4; i++) {
+      msg = _mm_loadu_si128((const __m128i *)(chunk + i * 16));
+      M[i] = _mm_shuffle_epi8(msg, mask);
+    }
+
+    for (i = 0; i < 16; i++) {
+      tmp = _mm_loadu_si128((const __m128i *)&K[i * 4]);
+      msg = _mm_add_epi32(M[i & 3], tmp);
+      state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+      msg = _mm_shuffle_epi32(msg, 0x0e);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+      if (i < 12) {
+        /* W[t+16..t+19] replaces W[t..t+3]. */
+        tmp = _mm_alignr_epi8(M[(i + 3) & 3], M[(i + 2) & 3], 4);
+        M[i & 3] = _mm_sha256msg1_epu32(M[i & 3], M[(i + 1) & 3]);
+        M[i & 3] = _mm_add_epi32(M[i & 3], tmp);
+        M[i & 3] = _mm_sha256msg2_epu32(M[i & 3], M[(i + 3) & 3]);
+      }
+    }
+
+    state0 = _mm_add_epi32(state0, save0);
+    state1 = _mm_add_epi32(state1, save1);
+
+    chunk += 64;
+  }
+
+  tmp = _mm_shuffle_epi32(state0, 0x1b); /* FEBA */
+  state1 = _mm_shuffle_epi32(state1, 0xb1); /* DCHG */
+  state0 = _mm_blend_epi16(tmp, state1, 0xf0); /* DCBA */
+  state1 = _mm_alignr_epi8(state1, tmp, 8); /* HGFE */
+
+  _mm_storeu_si128((__m128i *)&state[0], state0);
+  _mm_storeu_si128((__m128i *)&state[4], state1);
+}
+
+/*
+ * Multi-buffer
+ *
+ * Independent streams, one per 32-bit lane: eight
+ * with AVX2 and sixteen with AVX-512. Every lane
+ * compresses the same number of blocks per call.
+ */
+
+#define GOO_SHA256_MB_ROUND(a, b, c, d, e, f, g, h, i) do {          \
+  if (t > 0) {                                                            \
+    V w15 = W[(i + 1) & 15];                                              \
+    V w2 = W[(i + 14) & 15];                                              \
+                                                                          \
+    s0 = VXOR3(VROR(w15, 7), VROR(w15, 18), VSHR(w15, 3));                    \
+    s1 = VXOR3(VROR(w2, 17), VROR(w2, 19), VSHR(w2, 10));                     \
+                                                                          \
+    W[i] = VADD(VADD(W[i], s0), VADD(W[(i + 9) & 15], s1));                  \
+  }                                                                       \
+                                                                          \
+  t1 = VADD(VADD(h, VXOR3(VROR(e, 6), VROR(e, 11), VROR(e, 25))),               \
+           VADD(VCH(e, f, g), VADD(VSET1((int)K[t + i]), W[i])));             \
+  t2 = VADD(VXOR3(VROR(a, 2), VROR(a, 13), VROR(a, 22)), VMAJ(a, b, c));        \
+                                                                          \
+  d = VADD(d, t1);                                                         \
+  h = VADD(t1, t2);                                                        \
+} while (0)
+
+#define GOO_SHA256_MB_ROUNDS() do {                                       \
+  V a = S[0], b = S[1], c = S[2], d = S[3];                               \
+  V e = S[4], f = S[5], g = S[6], h = S[7];                               \
+  V t1, t2, s0, s1;                                                       \
+  size_t t;                                                               \
+                                                                          \
+  /* Sixteen rounds per iteration so that the */                          \
+  /* schedule indices are constants. */                                   \
+  for (t = 0; t < 64; t += 16) {                                          \
+    GOO_SHA256_MB_ROUND(a, b, c, d, e, f, g, h, 0);                       \
+    GOO_SHA256_MB_ROUND(h, a, b, c, d, e, f, g, 1);                       \
+    GOO_SHA256_MB_ROUND(g, h, a, b, c, d, e, f, 2);                       \
+    GOO_SHA256_MB_ROUND(f, g, h, a, b, c, d, e, 3);                       \
+    GOO_SHA256_MB_ROUND(e, f, g, h, a, b, c, d, 4);                       \
+    GOO_SHA256_MB_ROUND(d, e, f, g, h, a, b, c, 5);                       \
+    GOO_SHA256_MB_ROUND(c, d, e, f, g, h, a, b, 6);                       \
+    GOO_SHA256_MB_ROUND(b, c, d, e, f, g, h, a, 7);                       \
+    GOO_SHA256_MB_ROUND(a, b, c, d, e, f, g, h, 8);                       \
+    GOO_SHA256_MB_ROUND(h, a, b, c, d, e, f, g, 9);                       \
+    GOO_SHA256_MB_ROUND(g, h, a, b, c, d, e, f, 10);                      \
+    GOO_SHA256_MB_ROUND(f, g, h, a, b, c, d, e, 11);                      \
+    GOO_SHA256_MB_ROUND(e, f, g, h, a, b, c, d, 12);                      \
+    GOO_SHA256_MB_ROUND(d, e, f, g, h, a, b, c, 13);                      \
+    GOO_SHA256_MB_ROUND(c, d, e, f, g, h, a, b, 14);                      \
+    GOO_SHA256_MB_ROUND(b, c, d, e, f, g, h, a, 15);                      \
+  }                                                                       \
+                                                                          \
+  S[0] = VADD(S[0], a);                                                    \
+  S[1] = VADD(S[1], b);                                                    \
+  S[2] = VADD(S[2], c);                                                    \
+  S[3] = VADD(S[3], d);                                                    \
+  S[4] = VADD(S[4], e);                                                    \
+  S[5] = VADD(S[5], f);                                                    \
+  S[6] = VADD(S[6], g);                                                    \
+  S[7] = VADD(S[7], h);                                                    \
+} while (0)
+
+#define V __m256i
+#define VADD(x, y) _mm256_add_epi32(x, y)
+#define VXOR3(x, y, z) _mm256_xor_si256(_mm256_xor_si256(x, y), z)
+#define VSHR(x, n) _mm256_srli_epi32(x, n)
+#define VROR(x, n) \
+  _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+#define VCH(x, y, z) \
+  _mm256_xor_si256(z, _mm256_and_si256(x, _mm256_xor_si256(y, z)))
+#define VMAJ(x, y, z) _mm256_or_si256(_mm256_and_si256(x, y), \
+  _mm256_and_si256(z, _mm256_or_si256(x, y)))
+#define VSET1(x) _mm256_set1_epi32(x)
+
+__attribute__((target("avx2")))
+static void
+goo_sha256_transform_x8(uint32_t **state,
+                        const unsigned char **chunk,
+                        size_t blocks) {
+  static const unsigned char bswap[32] = {
+    3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+    3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+  };
+  const __m256i mask = _mm256_loadu_si256((const __m256i *)bswap);
+  uint32_t tmp[8];
+  __m256i S[8];
+  __m256i W[16];
+  __m256i r[8], u[8];
+  size_t i, j, l, off = 0;
+
+  for (i = 0; i < 8; i++) {
+    for (l = 0; l < 8; l++)
+      tmp[l] = state[l][i];
+
+    S[i] = _mm256_loadu_si256((const __m256i *)tmp);
+  }
 
-  for (; i < 64; i++)
-    W[i] = sigma1(W[i - 2]) + W[i - 7] + sigma0(W[i - 15]) + W[i - 16];
+  while (blocks--) {
+    /* Transpose two 8x8 word matrices. */
+    for (j = 0; j < 2; j++) {
+      for (l = 0; l < 8; l++) {
+        r[l] = _mm256_loadu_si256((const __m256i *)(chunk[l] + off + j * 32));
+        r[l] = _mm256_shuffle_epi8(r[l], mask);
+      }
+
+      for (l = 0; l < 8; l += 2) {
+        u[l + 0] = _mm256_unpacklo_epi32(r[l], r[l + 1]);
+        u[l + 1] = _mm256_unpackhi_epi32(r[l], r[l + 1]);
+      }
+
+      for (l = 0; l < 8; l += 4) {
+        r[l + 0] = _mm256_unpacklo_epi64(u[l + 0], u[l + 2]);
+        r[l + 1] = _mm256_unpackhi_epi64(u[l + 0], u[l + 2]);
+        r[l + 2] = _mm256_unpacklo_epi64(u[l + 1], u[l + 3]);
+        r[l + 3] = _mm256_unpackhi_epi64(u[l + 1], u[l + 3]);
+      }
+
+      for (i = 0; i < 4; i++) {
+        W[j * 8 + i] = _mm256_permute2x128_si256(r[i], r[4 + i], 0x20);
+        W[j * 8 + 4 + i] = _mm256_permute2x128_si256(r[i], r[4 + i], 0x31);
+      }
+    }
+
+    GOO_SHA256_MB_ROUNDS();
+
+    off += 64;
+  }
 
-  for (i = 0; i < 64; i++) {
-    t1 = h + Sigma1(e) + Ch(e, f, g) + K[i] + W[i];
-    t2 = Sigma0(a) + Maj(a, b, c);
+  for (i = 0; i < 8; i++) {
+    _mm256_storeu_si256((__m256i *)tmp, S[i]);
 
-    h = g;
-    g = f;
-    f = e;
+    for (l = 0; l < 8; l++)
+      state[l][i] = tmp[l];
+  }
+}
 
-    e = d + t1;
+#undef V
+#undef VADD
+#undef VXOR3
+#undef VSHR
+#undef VROR
+#undef VCH
+#undef VMAJ
+#undef VSET1
+
+#define V __m512i
+#define VADD(x, y) _mm512_add_epi32(x, y)
+#define VXOR3(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0x96)
+#define VSHR(x, n) _mm512_srli_epi32(x, n)
+#define VROR(x, n) _mm512_ror_epi32(x, n)
+#define VCH(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0xca)
+#define VMAJ(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0xe8)
+#define VSET1(x) _mm512_set1_epi32(x)
+
+__attribute__((target("avx512f,avx512bw")))
+static void
+goo_sha256_transform_x16(uint32_t **state,
+                         const unsigned char **chunk,
+                         size_t blocks) {
+  static const unsigned char bswap[16] = {
+    3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+  };
+  const __m512i mask = _mm512_broadcast_i32x4(
+    _mm_loadu_si128((const __m128i *)bswap));
+  uint32_t tmp[16];
+  __m512i S[8];
+  __m512i W[16];
+  __m512i r[16], u[16];
+  size_t i, l, off = 0;
+
+  for (i = 0; i < 8; i++) {
+    for (l = 0; l < 16; l++)
+      tmp[l] = state[l][i];
+
+    S[i] = _mm512_loadu_si512((const void *)tmp);
+  }
 
-    d = c;
-    c = b;
-    b = a;
+  while (blocks--) {
+    /* Transpose the 16x16 word matrix. */
+    for (l = 0; l < 16; l++) {
+      r[l] = _mm512_loadu_si512((const void *)(chunk[l] + off));
+      r[l] = _mm512_shuffle_epi8(r[l], mask);
+    }
+
+    for (l = 0; l < 16; l += 2) {
+      u[l + 0] = _mm512_unpacklo_epi32(r[l], r[l + 1]);
+      u[l + 1] = _mm512_unpackhi_epi32(r[l], r[l + 1]);
+    }
+
+    for (l = 0; l < 16; l += 4) {
+      r[l + 0] = _mm512_unpacklo_epi64(u[l + 0], u[l + 2]);
+      r[l + 1] = _mm512_unpackhi_epi64(u[l + 0], u[l + 2]);
+      r[l + 2] = _mm512_unpacklo_epi64(u[l + 1], u[l + 3]);
+      r[l + 3] = _mm512_unpackhi_epi64(u[l + 1], u[l + 3]);
+    }
+
+    for (i = 0; i < 4; i++) {
+      __m512i v1 = _mm512_shuffle_i32x4(r[i], r[4 + i], 0x44);
+      __m512i v2 = _mm512_shuffle_i32x4(r[8 + i], r[12 + i], 0x44);
+      __m512i v3 = _mm512_shuffle_i32x4(r[i], r[4 + i], 0xee);
+      __m512i v4 = _mm512_shuffle_i32x4(r[8 + i], r[12 + i], 0xee);
+
+      W[0 + i] = _mm512_shuffle_i32x4(v1, v2, 0x88);
+      W[4 + i] = _mm512_shuffle_i32x4(v1, v2, 0xdd);
+      W[8 + i] = _mm512_shuffle_i32x4(v3, v4, 0x88);
+      W[12 + i] = _mm512_shuffle_i32x4(v3, v4, 0xdd);
+    }
+
+    GOO_SHA256_MB_ROUNDS();
 
-    a = t1 + t2;
+    off += 64;
   }
 
+  for (i = 0; i < 8; i++) {
+    _mm512_storeu_si512((void *)tmp, S[i]);
+
+    for (l = 0; l < 16; l++)
+      state[l][i] = tmp[l];
+  }
+}
+
+#undef V
+#undef VADD
+#undef VXOR3
+#undef VSHR
+#undef VROR
+#undef VCH
+#undef VMAJ
+#undef VSET1
+#undef GOO_SHA256_MB_ROUND
+#undef GOO_SHA256_MB_ROUNDS
+#endif /* GOO_SHA256_X86 */
+
 #undef Sigma0
 #undef Sigma1
 #undef sigma0
 #undef sigma1
 #undef Ch
 #undef Maj
+#undef GOO_SHA256_ROUNDS
+
+/*
+ * Dispatch
+ */
+
+#ifdef GOO_SHA256_COUNT
+unsigned long goo_sha256_blocks = 0;
+#endif
+
+typedef struct goo_sha256_backend_s {
+  goo_sha256_transform_f *transform;
+  goo_sha256_multi_f *multi; /* or NULL */
+  size_t lanes;
+  size_t min; /* busy lanes needed to use `multi` */
+  int id;
+} goo_sha256_backend_t;
+
+static const goo_sha256_backend_t goo_sha256_generic = {
+  goo_sha256_transform_generic, NULL, 0, 0, GOO_SHA256_GENERIC
+};
+
+#ifdef GOO_SHA256_X86
+/* The multi-buffer kernels are only used when enough */
+/* lanes are busy (`min`) to beat compressing those */
+/* streams one at a time. Eight AVX2 lanes lose to */
+/* SHA-NI outright; sixteen AVX-512 lanes win once */
+/* about nine are busy. */
+static const goo_sha256_backend_t goo_sha256_shani = {
+  goo_sha256_transform_shani, NULL, 0, 0, GOO_SHA256_SHANI
+};
+
+static const goo_sha256_backend_t goo_sha256_shani_x16 = {
+  goo_sha256_transform_shani, goo_sha256_transform_x16, 16, 9,
+  GOO_SHA256_SHANI
+};
+
+static const goo_sha256_backend_t goo_sha256_avx2_x8 = {
+  goo_sha256_transform_avx2, goo_sha256_transform_x8, 8, 2,
+  GOO_SHA256_AVX2
+};
+
+static const goo_sha256_backend_t goo_sha256_avx2_x16 = {
+  goo_sha256_transform_avx2, goo_sha256_transform_x16, 16, 2,
+  GOO_SHA256_AVX2
+};
+#endif
+
+static const goo_sha256_backend_t *
+goo_sha256_pick(int backend) {
+#ifdef GOO_SHA256_X86
+  int has_shani, has_avx2, has_avx512;
+  int automatic = 0;
+
+  __builtin_cpu_init();
+
+  has_shani = __builtin_cpu_supports("sha")
+           && __builtin_cpu_supports("sse4.1");
+
+  has_avx2 = __builtin_cpu_supports("avx2")
+          && __builtin_cpu_supports("bmi2");
+
+  has_avx512 = __builtin_cpu_supports("avx512f")
+            && __builtin_cpu_supports("avx512bw");
 
-  ctx->state[0] += a;
-  ctx->state[1] += b;
-  ctx->state[2] += c;
-  ctx->state[3] += d;
-  ctx->state[4] += e;
-  ctx->state[5] += f;
-  ctx->state[6] += g;
-  ctx->state[7] += h;
+  if (backend == GOO_SHA256_AUTO) {
+    automatic = 1;
+
+    if (has_shani)
+      backend = GOO_SHA256_SHANI;
+    else if (has_avx2)
+      backend = GOO_SHA256_AVX2;
+  }
+
+  if (backend == GOO_SHA256_SHANI && has_shani)
+    return has_avx512 ? &goo_sha256_shani_x16 : &goo_sha256_shani;
+
+  if (backend == GOO_SHA256_AVX2 && has_avx2) {
+    if (has_avx512 && automatic)
+      return &goo_sha256_avx2_x16;
+
+    return &goo_sha256_avx2_x8;
+  }
+#else
+  (void)backend;
+#endif
+
+  return &goo_sha256_generic;
+}
+
+/* Chosen once per process and published as a */
+/* single pointer, so every reader sees one */
+/* consistent backend. */
+static const goo_sha256_backend_t *goo_sha256_active = NULL;
+
+static void
+goo_sha256_detect(void) {
+  goo_sha256_active = goo_sha256_pick(GOO_SHA256_AUTO);
+}
+
+#if defined(_WIN32)
+static INIT_ONCE goo_sha256_once = INIT_ONCE_STATIC_INIT;
+
+static BOOL CALLBACK
+goo_sha256_detect_once(PINIT_ONCE once, PVOID param, PVOID *ctx) {
+  (void)once;
+  (void)param;
+  (void)ctx;
+  goo_sha256_detect();
+  return TRUE;
+}
+#elif defined(GOO_HAS_PTHREAD)
+static pthread_once_t goo_sha256_once = PTHREAD_ONCE_INIT;
+#endif
+
+static const goo_sha256_backend_t *
+goo_sha256_get(void) {
+#if defined(_WIN32)
+  InitOnceExecuteOnce(&goo_sha256_once, goo_sha256_detect_once, NULL, NULL);
+#elif defined(GOO_HAS_PTHREAD)
+  pthread_once(&goo_sha256_once, goo_sha256_detect);
+#else
+  if (goo_sha256_active == NULL)
+    goo_sha256_detect();
+#endif
+
+  return goo_sha256_active;
+}
+
+int
+goo_sha256_backend(void) {
+  return goo_sha256_get()->id;
+}
+
+#ifdef GOO_SHA256_TESTING
+int
+goo_sha256_force(int backend) {
+  goo_sha256_get();
+  goo_sha256_active = goo_sha256_pick(backend);
+  return goo_sha256_active->id;
+}
+#endif
+
+static void
+goo_sha256_transform(goo_sha256_t *ctx,
+                     const unsigned char *chunk,
+                     size_t blocks) {
+#ifdef GOO_SHA256_COUNT
+  goo_sha256_blocks += blocks;
+#endif
+
+  goo_sha256_get()->transform(ctx->state, chunk, blocks);
 }
 
 void
@@ -151,19 +726,143 @@ goo_sha256_update(goo_sha256_t *ctx, const void *data, size_t len) {
     if (pos < 64)
       return;
 
-    goo_sha256_transform(ctx, ctx->block);
+    goo_sha256_transform(ctx, ctx->block, 1);
   }
 
-  while (len >= 64) {
-    goo_sha256_transform(ctx, bytes + off);
-    off += 64;
-    len -= 64;
+  if (len >= 64) {
+    size_t blocks = len >> 6;
+
+    goo_sha256_transform(ctx, bytes + off, blocks);
+
+    off += blocks << 6;
+    len -= blocks << 6;
   }
 
   if (len > 0)
     memcpy(ctx->block, bytes + off, len);
 }
 
+static size_t
+goo_sha256_enter(goo_sha256_t *ctx,
+                 const unsigned char **ptr,
+                 const unsigned char *data,
+                 size_t len) {
+  /* Absorbs everything except the whole blocks in the */
+  /* middle of `data`, and returns how many there are. */
+  size_t pos = ctx->size & 63;
+  size_t blocks;
+
+  if (pos > 0) {
+    size_t want = 64 - pos;
+
+    if (want > len)
+      want = len;
+
+    goo_sha256_update(ctx, data, want);
+
+    data += want;
+    len -= want;
+  }
+
+  blocks = len >> 6;
+
+  *ptr = data;
+
+  /* The buffer is empty now, so the tail */
+  /* can be copied in ahead of the blocks. */
+  ctx->size += blocks << 6;
+
+  goo_sha256_update(ctx, data + (blocks << 6), len & 63);
+
+  return blocks;
+}
+
+void
+goo_sha256_update_multi(goo_sha256_t *ctxs,
+                        const unsigned char *const *data,
+                        const size_t *lens,
+                        size_t count) {
+  uint32_t *states[GOO_SHA256_MAX_LANES];
+  const unsigned char *ptrs[GOO_SHA256_MAX_LANES];
+  size_t blocks[GOO_SHA256_MAX_LANES];
+  const goo_sha256_backend_t *be = goo_sha256_get();
+  uint32_t dummy[8];
+  size_t lanes = be->lanes;
+  size_t next = 0;
+  size_t i;
+
+  if (be->multi == NULL) {
+    for (i = 0; i < count; i++)
+      goo_sha256_update(&ctxs[i], data[i], lens[i]);
+    return;
+  }
+
+  for (i = 0; i < lanes; i++)
+    blocks[i] = 0;
+
+  /* Streams are fed into lanes as they free up. */
+  for (;;) {
+    size_t busy = 0;
+    size_t min = (size_t)-1;
+    const unsigned char *any = NULL;
+
+    for (i = 0; i < lanes; i++) {
+      while (blocks[i] == 0 && next < count) {
+        goo_sha256_t *ctx = &ctxs[next];
+
+        blocks[i] = goo_sha256_enter(ctx, &ptrs[i], data[next], lens[next]);
+        states[i] = ctx->state;
+
+        next += 1;
+      }
+
+      if (blocks[i] > 0) {
+        busy += 1;
+        any = ptrs[i];
+
+        if (blocks[i] < min)
+          min = blocks[i];
+      }
+    }
+
+    if (busy == 0)
+      break;
+
+    /* Too few streams left to fill the vectors. */
+    if (busy < be->min) {
+      for (i = 0; i < lanes; i++) {
+        if (blocks[i] > 0) {
+#ifdef GOO_SHA256_COUNT
+          goo_sha256_blocks += blocks[i];
+#endif
+          be->transform(states[i], ptrs[i], blocks[i]);
+        }
+      }
+      break;
+    }
+
+    for (i = 0; i < lanes; i++) {
+      if (blocks[i] == 0) {
+        states[i] = dummy;
+        ptrs[i] = any;
+      }
+    }
+
+#ifdef GOO_SHA256_COUNT
+    goo_sha256_blocks += busy * min;
+#endif
+
+    be->multi(states, ptrs, min);
+
+    for (i = 0; i < lanes; i++) {
+      if (blocks[i] > 0) {
+        ptrs[i] += min << 6;
+        blocks[i] -= min;
+      }
+    }
+  }
+}
+
 void
 goo_sha256_final(goo_sha256_t *ctx, unsigned char *out) {
   size_t pos = ctx->size & 63;
@@ -13,18 +13,51 @@
 #define GOO_SHA256_HASH_SIZE 32
 #define GOO_SHA256_BLOCK_SIZE 64
 
+#define GOO_SHA256_AUTO 0
+#define GOO_SHA256_GENERIC 1
+#define GOO_SHA256_AVX2 2
+#define GOO_SHA256_SHANI 3
+
+#define GOO_SHA256_MAX_LANES 16
+
+#ifdef GOO_SHA256_COUNT
+/* Compressions performed so far (benchmarks only). */
+extern unsigned long goo_sha256_blocks;
+#endif
+
 typedef struct goo_sha256_s {
   uint32_t state[8];
   uint8_t block[64];
   uint64_t size;
 } goo_sha256_t;
 
+/* The compression function in use, picked once */
+/* (the fastest available) on first use. */
+int
+goo_sha256_backend(void);
+
+#ifdef GOO_SHA256_TESTING
+/* Switch backends (tests and benchmarks only; not */
+/* thread-safe). Returns the backend now in use. */
+int
+goo_sha256_force(int backend);
+#endif
+
 void
 goo_sha256_init(goo_sha256_t *ctx);
 
 void
 goo_sha256_update(goo_sha256_t *ctx, const void *data, size_t len);
 
+/* Absorbs data[i] into ctxs[i] for every i < count. */
+/* Independent streams are compressed side by side */
+/* (8 or 16 at a time) when the CPU allows. */
+void
+goo_sha256_update_multi(goo_sha256_t *ctxs,
+                        const unsigned char *const *data,
+                        const size_t *lens,
+                        size_t count);
+
 void
 goo_sha256_final(goo_sha256_t *ctx, unsigned char *out);
 
@@ -3,6 +3,7 @@
 #include <stdio.h>
 
 #include "goo.c"
+#include "scan.h"
 
 #define GOO_ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
 
@@ -696,7 +697,7 @@ rng_init(goo_prng_t *rng) {
   }
 
   goo_prng_init(rng);
-  goo_prng_seed(rng, entropy, GOO_PRNG_LOCAL);
+  goo_prng_seed(rng, entropy, &GOO_PRNG_LOCAL);
 }
 
 static void
@@ -841,6 +842,17 @@ run_drbg_test(void) {
     0x5e, 0xf6, 0xf7, 0x58, 0x9e, 0xa2, 0x62, 0xc1
   };
 
+  static const goo_prng_iv_t *ivs[] = {
+    &GOO_PRNG_EXPAND,
+    &GOO_PRNG_DERIVE,
+    &GOO_PRNG_PRIMALITY,
+    &GOO_PRNG_SIGN,
+    &GOO_PRNG_PRESIGN,
+    &GOO_PRNG_ENCRYPT,
+    &GOO_PRNG_DECRYPT,
+    &GOO_PRNG_LOCAL
+  };
+
   unsigned char entropy[64];
   unsigned char out[36];
   goo_drbg_t ctx;
@@ -871,6 +883,29 @@ run_drbg_test(void) {
 
   goo_drbg_generate(&ctx, out, 32);
   ASSERT(memcmp(out, expect4, 32) == 0);
+
+  /* Precomputed seed prefixes. */
+  for (i = 0; i < GOO_ARRAY_SIZE(ivs); i++) {
+    const goo_prng_iv_t *iv = ivs[i];
+    unsigned char expect[36];
+    uint32_t mid[8];
+    goo_drbg_t ref;
+
+    goo_drbg_iv(mid, iv->data);
+
+    ASSERT(memcmp(mid, iv->mid, sizeof(mid)) == 0);
+
+    memcpy(&entropy[0], iv->data, 32);
+    memset(&entropy[32], (int)i, 32);
+
+    goo_drbg_init(&ref, entropy, 64);
+    goo_drbg_init_iv(&ctx, iv->mid, iv->data, &entropy[32], 32);
+
+    goo_drbg_generate(&ref, expect, 36);
+    goo_drbg_generate(&ctx, out, 36);
+
+    ASSERT(memcmp(out, expect, 36) == 0);
+  }
 }
 
 static void
@@ -897,7 +932,7 @@ run_prng_test(void) {
   mpz_init(x);
   mpz_init(y);
 
-  goo_prng_seed(&prng, key, GOO_PRNG_DERIVE);
+  goo_prng_seed(&prng, key, &GOO_PRNG_DERIVE);
 
   goo_prng_random_bits(&prng, x, 256);
   ASSERT(mpz_sgn(x) > 0);
@@ -930,7 +965,7 @@ run_prng_test(void) {
   ASSERT(mpz_cmp_ui(x, 1886980239) == 0);
 
   memset(key, 0x01, sizeof(key));
-  goo_prng_seed(&prng, key, GOO_PRNG_DERIVE);
+  goo_prng_seed(&prng, key, &GOO_PRNG_DERIVE);
 
   for (i = 0; i < 1000; i++)
     goo_prng_random_bits(&prng, x, ((i + 1) * 512) % 521);
@@ -941,11 +976,144 @@ run_prng_test(void) {
 
   ASSERT(mpz_cmp(x, y) == 0);
 
+  /* Outputs spanning several imports (plus a carry) */
+  /* match 256 bit chunks from the raw stream. */
+  {
+    unsigned char chunk[32];
+    goo_prng_t ref;
+    mpz_t z;
+
+    mpz_init(z);
+    goo_prng_init(&ref);
+
+    goo_prng_seed(&prng, key, &GOO_PRNG_EXPAND);
+    goo_prng_seed(&ref, key, &GOO_PRNG_EXPAND);
+
+    goo_prng_random_bits(&prng, x, 100);
+    goo_prng_random_bits(&prng, x, GOO_PRNG_CHUNKS * 256 * 2 + 100);
+
+    mpz_set_ui(y, 0);
+
+    for (i = 0; i < GOO_PRNG_CHUNKS * 2 + 1; i++) {
+      goo_prng_generate(&ref, chunk, sizeof(chunk));
+      goo_mpz_import(z, chunk, sizeof(chunk));
+      mpz_mul_2exp(y, y, 256);
+      mpz_ior(y, y, z);
+    }
+
+    /* The first 100 bits were handed out earlier, */
+    /* and the last 56 are kept for the next call. */
+    mpz_tdiv_r_2exp(y, y, GOO_PRNG_CHUNKS * 256 * 2 + 156);
+    mpz_tdiv_q_2exp(y, y, 56);
+
+    ASSERT(mpz_cmp(x, y) == 0);
+
+    mpz_clear(z);
+    goo_prng_uninit(&ref);
+  }
+
   mpz_clear(x);
   mpz_clear(y);
   goo_prng_uninit(&prng);
 }
 
+static void
+run_sha256_backend_test(goo_prng_t *rng) {
+  static const char *names[] = {"auto", "generic", "avx2", "sha-ni"};
+  static const int backends[] = {
+    GOO_SHA256_GENERIC,
+    GOO_SHA256_AVX2,
+    GOO_SHA256_SHANI
+  };
+  /* sha256("abc") */
+  static const unsigned char abc[32] = {
+    0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea,
+    0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+    0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,
+    0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+  };
+  unsigned char msg[1024];
+  unsigned char out[32];
+  unsigned char expect[32];
+  unsigned long i, j;
+
+  printf("Testing SHA256 backends...\n");
+
+  for (j = 0; j < GOO_ARRAY_SIZE(backends); j++) {
+    if (goo_sha256_force(backends[j]) != backends[j])
+      continue;
+
+    printf("  - %s\n", names[backends[j]]);
+
+    goo_sha256(out, "abc", 3);
+
+    ASSERT(memcmp(out, abc, 32) == 0);
+
+    for (i = 0; i < 256; i++) {
+      size_t msg_len = (size_t)goo_prng_random_num(rng, sizeof(msg));
+      size_t split = (size_t)goo_prng_random_num(rng, msg_len + 1);
+      goo_sha256_t ctx;
+
+      goo_prng_generate(rng, msg, msg_len);
+
+      goo_sha256_force(GOO_SHA256_GENERIC);
+      goo_sha256(expect, msg, msg_len);
+      goo_sha256_force(backends[j]);
+
+      goo_sha256(out, msg, msg_len);
+
+      ASSERT(memcmp(out, expect, 32) == 0);
+
+      goo_sha256_init(&ctx);
+      goo_sha256_update(&ctx, msg, split);
+      goo_sha256_update(&ctx, msg + split, msg_len - split);
+      goo_sha256_final(&ctx, out);
+
+      ASSERT(memcmp(out, expect, 32) == 0);
+    }
+
+    /* Multi-buffer: uneven streams, some partially absorbed. */
+    for (i = 0; i < 8; i++) {
+      goo_sha256_t ctxs[24];
+      const unsigned char *data[24];
+      size_t lens[24];
+      size_t heads[24];
+      size_t count = 1 + (size_t)goo_prng_random_num(rng, 24);
+      size_t k;
+
+      goo_prng_generate(rng, msg, sizeof(msg));
+
+      for (k = 0; k < count; k++) {
+        size_t off = (size_t)goo_prng_random_num(rng, sizeof(msg));
+
+        data[k] = msg + off;
+        lens[k] = (size_t)goo_prng_random_num(rng, sizeof(msg) - off + 1);
+        heads[k] = (size_t)goo_prng_random_num(rng, 100);
+
+        goo_sha256_init(&ctxs[k]);
+        goo_sha256_update(&ctxs[k], msg, heads[k]);
+      }
+
+      goo_sha256_update_multi(ctxs, data, lens, count);
+
+      for (k = 0; k < count; k++) {
+        goo_sha256_t ctx;
+
+        goo_sha256_final(&ctxs[k], out);
+
+        goo_sha256_init(&ctx);
+        goo_sha256_update(&ctx, msg, heads[k]);
+        goo_sha256_update(&ctx, data[k], lens[k]);
+        goo_sha256_final(&ctx, expect);
+
+        ASSERT(memcmp(out, expect, 32) == 0);
+      }
+    }
+  }
+
+  ASSERT(goo_sha256_force(GOO_SHA256_AUTO) == goo_sha256_backend());
+}
+
 #ifdef GOO_HAS_CRYPTO
 #include <openssl/sha.h>
 
@@ -1232,6 +1400,41 @@ run_util_test(goo_prng_t *rng) {
       mpz_clear(y);
     }
   }
+
+  /* test quadratic residue prescreen */
+  {
+    unsigned char qr[GOO_PRIMES_LEN];
+    mpz_t p, q, t, w;
+    size_t i, j;
+
+    printf("Testing QR prescreen...\n");
+
+    mpz_init(p);
+    mpz_init(q);
+    mpz_init(t);
+    mpz_init(w);
+
+    for (i = 0; i < 10; i++) {
+      /* Cover every residue of p mod 8 (for t = 2). */
+      do {
+        random_prime(p, rng, 256);
+      } while ((mpz_getlimbn(p, 0) & 7) != 2 * (i & 3) + 1);
+
+      random_prime(q, rng, 256);
+
+      goo_primes_qr(qr, p, q);
+
+      for (j = 0; j < GOO_PRIMES_LEN; j++) {
+        mpz_set_ui(t, goo_primes[j]);
+        ASSERT(qr[j] == goo_mpz_sqrtpq(w, t, p, q));
+      }
+    }
+
+    mpz_clear(p);
+    mpz_clear(q);
+    mpz_clear(t);
+    mpz_clear(w);
+  }
 }
 
 static void
@@ -1537,6 +1740,54 @@ run_primes_test(goo_prng_t *rng) {
     mpz_clear(p);
   }
 
+  printf("Testing trial division...\n");
+
+  {
+    static const unsigned long bits[] = { 64, 136, 1024, 2048, 4200 };
+    mpz_t n;
+    int ret;
+    size_t j;
+
+    mpz_init(n);
+
+    for (i = 0; i < 20000 + 5 * 200; i++) {
+      if (i < 20000) {
+        mpz_set_ui(n, i);
+      } else {
+        goo_prng_random_bits(rng, n, bits[i % 5]);
+
+        /* Half of these get a (possibly large) small factor. */
+        if (i & 1)
+          mpz_mul_ui(n, n, goo_test_primes[(i >> 1) % GOO_TEST_PRIMES_LEN]);
+      }
+
+      /* The old division loop. */
+      ret = -1;
+
+      if (mpz_cmp_ui(n, 1) <= 0) {
+        ret = 0;
+      } else if (mpz_even_p(n)) {
+        ret = mpz_cmp_ui(n, 2) == 0;
+      } else {
+        for (j = 0; j < GOO_TEST_PRIMES_LEN; j++) {
+          if (mpz_cmp_ui(n, goo_test_primes[j]) == 0) {
+            ret = 1;
+            break;
+          }
+
+          if (mpz_fdiv_ui(n, goo_test_primes[j]) == 0) {
+            ret = 0;
+            break;
+          }
+        }
+      }
+
+      ASSERT(goo_is_prime_div(n) == ret);
+    }
+
+    mpz_clear(n);
+  }
+
   printf("Testing composites...\n");
 
   ASSERT(GOO_ARRAY_SIZE(composites) > 0);
@@ -1645,6 +1896,72 @@ run_primes_test(goo_prng_t *rng) {
     mpz_clear(n);
   }
 
+#ifdef GOO_HAS_DLIMB
+  printf("Testing small primes...\n");
+
+  {
+    mpz_t n;
+
+    mpz_init(n);
+
+    for (i = 0; i < GOO_ARRAY_SIZE(primes) + GOO_ARRAY_SIZE(composites); i++) {
+      if (i < GOO_ARRAY_SIZE(primes))
+        ASSERT(mpz_set_str(n, primes[i], 10) == 0);
+      else
+        ASSERT(mpz_set_str(n, composites[i - GOO_ARRAY_SIZE(primes)], 10) == 0);
+
+      if (goo_mpz_bitlen(n) > GOO_SMALL_BITS)
+        continue;
+
+      ASSERT(goo_small_is_prime(n, key) == (i < GOO_ARRAY_SIZE(primes)));
+      ASSERT(goo_small_is_prime(n, zero) == (i < GOO_ARRAY_SIZE(primes)));
+    }
+
+    /* Every stage agrees with the generic code, */
+    /* including on pseudoprimes and squares. */
+    for (i = 0; i < 20000; i++) {
+      unsigned long bits = 13 + goo_prng_random_num(rng, GOO_SMALL_BITS - 12);
+      goo_small_t sm;
+
+      if (i < 2000) {
+        mpz_set_ui(n, 2601 + 2 * i);
+      } else if (i < 2100) {
+        /* The small code expects an odd modulus. */
+        do {
+          random_prime(n, rng, bits / 2);
+        } while (mpz_even_p(n));
+
+        mpz_mul(n, n, n);
+      } else {
+        goo_prng_random_bits(rng, n, bits);
+        mpz_setbit(n, 0);
+        mpz_setbit(n, bits - 1);
+      }
+
+      goo_small_init(&sm, n);
+
+      ASSERT(goo_small_is_prime_mr(&sm, n, key, 4, 1)
+          == goo_is_prime_mr(n, key, 4, 1));
+
+      ASSERT(goo_small_is_prime_lucas(&sm, n, 50)
+          == goo_is_prime_lucas(n, 50));
+
+      if (i % 16 == 0) {
+        int ret = goo_is_prime_div(n);
+
+        if (ret == -1) {
+          ret = goo_is_prime_mr(n, key, 16 + 1, 1)
+             && goo_is_prime_lucas(n, 50);
+        }
+
+        ASSERT(goo_small_is_prime(n, key) == ret);
+      }
+    }
+
+    mpz_clear(n);
+  }
+#endif
+
   /* test next_prime */
   {
     mpz_t n;
@@ -1686,12 +2003,65 @@ run_primes_test(goo_prng_t *rng) {
     mpz_clear(e);
     mpz_clear(r);
   }
+
+  /* test next_prime against a plain walk */
+  {
+    static const unsigned long bits[] = { 2, 12, 13, 14, 64, 136, 300 };
+    static const unsigned long maxes[] = { 0, 1, 2, 31, 512, 513, 1500 };
+    unsigned char seed[32];
+    unsigned long inc, max;
+    mpz_t n, r, e;
+    int ok, j;
+
+    printf("Testing next_prime (3)...\n");
+
+    mpz_init(n);
+    mpz_init(r);
+    mpz_init(e);
+
+    for (j = 0; j < 700; j++) {
+      goo_prng_generate(rng, seed, sizeof(seed));
+      goo_prng_random_bits(rng, n, bits[j % 7]);
+
+      max = maxes[(j / 7) % 7];
+
+      /* The old goo_next_prime(). */
+      inc = 0;
+
+      mpz_set(e, n);
+
+      if (mpz_even_p(e)) {
+        mpz_add_ui(e, e, 1);
+        inc += 1;
+      }
+
+      while (!goo_is_prime(e, seed)) {
+        if (max != 0 && inc > max)
+          break;
+
+        mpz_add_ui(e, e, 2);
+        inc += 2;
+      }
+
+      ok = goo_next_prime(r, n, seed, max);
+
+      ASSERT(ok == (max == 0 || inc <= max));
+
+      if (ok)
+        ASSERT(mpz_cmp(r, e) == 0);
+    }
+
+    mpz_clear(n);
+    mpz_clear(r);
+    mpz_clear(e);
+  }
 }
 
 static void
 run_ops_test(goo_prng_t *rng) {
   mpz_t n;
   goo_group_t *goo;
+  goo_scratch_t scratch;
 
   printf("Testing group ops...\n");
 
@@ -1703,6 +2073,8 @@ run_ops_test(goo_prng_t *rng) {
 
   ASSERT(goo_group_init(goo, n, 2, 3, 2048));
 
+  goo_scratch_init(&scratch, goo);
+
   {
     printf("Testing comb calculation...\n");
 
@@ -1739,9 +2111,114 @@ run_ops_test(goo_prng_t *rng) {
     ASSERT(goo->combs[1].h.size == 510);
   }
 
+  /* test montgomery */
+  {
+    static const int kernels[4] = {
+      GOO_MONT_GENERIC,
+      GOO_MONT_FIXED,
+      GOO_MONT_AVX2,
+      GOO_MONT_IFMA
+    };
+
+    static const char *kernel_names[5] = {
+      "auto",
+      "generic",
+      "fixed",
+      "avx2",
+      "ifma"
+    };
+
+    goo_mont_t *mont = goo_malloc(sizeof(goo_mont_t));
+    mp_limb_t ap[GOO_MAX_LIMBS];
+    mp_limb_t bp[GOO_MAX_LIMBS];
+    mpz_t m, a, b, r1, r2;
+    unsigned long i, j, k;
+
+    printf("Testing montgomery...\n");
+
+    mpz_init(m);
+    mpz_init(a);
+    mpz_init(b);
+    mpz_init(r1);
+    mpz_init(r2);
+
+    for (j = 0; j < 2; j++) {
+      size_t bits = j == 0 ? 2048 : 4096;
+
+      if (j == 0)
+        goo_mpz_import(m, GOO_RSA2048, sizeof(GOO_RSA2048));
+      else
+        goo_mpz_import(m, GOO_AOL2, sizeof(GOO_AOL2));
+
+      for (k = 0; k < 4; k++) {
+        ASSERT(goo_mont_init(mont, m, kernels[k]));
+
+        /* Unsupported kernels fall back. */
+        if (mont->kernel != kernels[k])
+          continue;
+
+        printf("  - %s (%lu bits)\n", kernel_names[mont->kernel],
+               (unsigned long)bits);
+
+        for (i = 0; i < 20; i++) {
+          goo_prng_random_bits(rng, a, i == 0 ? 0 : bits);
+          goo_prng_random_bits(rng, b, bits);
+
+          /* Both inputs may be >= n here. */
+          goo_mont_import(mont, ap, a);
+          goo_mont_import(mont, bp, b);
+
+          goo_mont_export(mont, r2, ap);
+          mpz_mod(r1, a, m);
+          ASSERT(mpz_cmp(r1, r2) == 0);
+
+          goo_mont_mul(mont, ap, ap, bp);
+          goo_mont_export(mont, r2, ap);
+          mpz_mul(r1, a, b);
+          mpz_mod(r1, r1, m);
+          ASSERT(mpz_cmp(r1, r2) == 0);
+
+          goo_mont_sqr(mont, bp, bp);
+          goo_mont_export(mont, r2, bp);
+          mpz_mul(r1, b, b);
+          mpz_mod(r1, r1, m);
+          ASSERT(mpz_cmp(r1, r2) == 0);
+        }
+
+        /* Edge cases: n - 1 and zero. */
+        mpz_sub_ui(a, m, 1);
+        goo_mont_import(mont, ap, a);
+        goo_mont_sqr(mont, ap, ap);
+        goo_mont_export(mont, r2, ap);
+        ASSERT(mpz_cmp_ui(r2, 1) == 0);
+
+        mpz_set_ui(a, 0);
+        goo_mont_import(mont, ap, a);
+        goo_mont_mul(mont, ap, ap, mont->one);
+        goo_mont_export(mont, r2, ap);
+        ASSERT(mpz_sgn(r2) == 0);
+      }
+    }
+
+    /* Values too large for the limbs are reduced first. */
+    goo_prng_random_bits(rng, a, 4096);
+    goo_group_to_mont(goo, ap, a);
+    goo_group_from_mont(goo, r2, ap);
+    mpz_mod(r1, a, goo->n);
+    ASSERT(mpz_cmp(r1, r2) == 0);
+
+    mpz_clear(m);
+    mpz_clear(a);
+    mpz_clear(b);
+    mpz_clear(r1);
+    mpz_clear(r2);
+
+    goo_free(mont);
+  }
+
   /* test pow */
   {
-    mpz_t b, bi, e;
+    mpz_t b, bi, e, z;
     mpz_t r1, r2;
     unsigned long i;
 
@@ -1750,6 +2227,7 @@ run_ops_test(goo_prng_t *rng) {
     mpz_init(b);
     mpz_init(bi);
     mpz_init(e);
+    mpz_init(z);
     mpz_init(r1);
     mpz_init(r2);
 
@@ -1759,7 +2237,8 @@ run_ops_test(goo_prng_t *rng) {
 
       ASSERT(goo_group_inv(goo, bi, b));
       ASSERT(goo_group_pow_slow(goo, r1, b, e));
-      ASSERT(goo_group_pow(goo, r2, b, bi, e));
+      ASSERT(goo_group_multiexp(goo, &scratch, r2, b, bi, e,
+                                NULL, NULL, NULL, z, z));
 
       ASSERT(mpz_cmp(r1, r2) == 0);
     }
@@ -1767,39 +2246,69 @@ run_ops_test(goo_prng_t *rng) {
     mpz_clear(b);
     mpz_clear(bi);
     mpz_clear(e);
+    mpz_clear(z);
     mpz_clear(r1);
     mpz_clear(r2);
   }
 
-  /* test pow2 */
+  /* test multiexp */
   {
-    mpz_t b1, b2, e1, e2;
+    static const unsigned long sizes[4][4] = {
+      {128, 128, 128, 128},
+      {128, 128, 2048, 2047},
+      {2048, 136, 1, 0},
+      {4096, 0, 4200, 4200}
+    };
+
+    mpz_t b1, b2, e1, e2, e3, e4;
     mpz_t b1i, b2i;
-    mpz_t r1, r2;
+    mpz_t r1, r2, r3;
     unsigned long i;
 
-    printf("Testing pow2...\n");
+    printf("Testing multiexp...\n");
 
     mpz_init(b1);
     mpz_init(b2);
     mpz_init(e1);
     mpz_init(e2);
+    mpz_init(e3);
+    mpz_init(e4);
 
     mpz_init(b1i);
     mpz_init(b2i);
 
     mpz_init(r1);
     mpz_init(r2);
+    mpz_init(r3);
 
     for (i = 0; i < 20; i++) {
+      const unsigned long *size = sizes[i & 3];
+
       goo_prng_random_bits(rng, b1, 2048);
       goo_prng_random_bits(rng, b2, 2048);
-      goo_prng_random_bits(rng, e1, 128);
-      goo_prng_random_bits(rng, e2, 128);
+      goo_prng_random_bits(rng, e1, size[0]);
+      goo_prng_random_bits(rng, e2, size[1]);
+      goo_prng_random_bits(rng, e3, size[2]);
+      goo_prng_random_bits(rng, e4, size[3]);
 
       ASSERT(goo_group_inv2(goo, b1i, b2i, b1, b2));
       ASSERT(goo_group_pow2_slow(goo, r1, b1, e1, b2, e2));
-      ASSERT(goo_group_pow2(goo, r2, b1, b1i, e1, b2, b2i, e2));
+      ASSERT(goo_group_powgh_slow(goo, r3, e3, e4));
+
+      goo_group_mul(goo, r1, r1, r3);
+
+      ASSERT(goo_group_multiexp(goo, &scratch, r2, b1, b1i, e1,
+                                b2, b2i, e2, e3, e4));
+
+      ASSERT(mpz_cmp(r1, r2) == 0);
+
+      /* Without the second base. */
+      ASSERT(goo_group_pow_slow(goo, r1, b1, e1));
+
+      goo_group_mul(goo, r1, r1, r3);
+
+      ASSERT(goo_group_multiexp(goo, &scratch, r2, b1, b1i, e1,
+                                NULL, NULL, NULL, e3, e4));
 
       ASSERT(mpz_cmp(r1, r2) == 0);
     }
@@ -1808,10 +2317,87 @@ run_ops_test(goo_prng_t *rng) {
     mpz_clear(b2);
     mpz_clear(e1);
     mpz_clear(e2);
+    mpz_clear(e3);
+    mpz_clear(e4);
     mpz_clear(b1i);
     mpz_clear(b2i);
     mpz_clear(r1);
     mpz_clear(r2);
+    mpz_clear(r3);
+  }
+
+  /* test recover4 */
+  {
+    mpz_t b1[GOO_LANES], b1i[GOO_LANES], b2[GOO_LANES], b2i[GOO_LANES];
+    mpz_t e1[GOO_LANES], e2[GOO_LANES], e3[GOO_LANES], e4[GOO_LANES];
+    mpz_t r1[GOO_LANES], r2[GOO_LANES];
+    mpz_ptr out[GOO_LANES];
+    mpz_srcptr b1p[GOO_LANES], b1ip[GOO_LANES], e1p[GOO_LANES];
+    mpz_srcptr b2p[GOO_LANES], b2ip[GOO_LANES], e2p[GOO_LANES];
+    mpz_srcptr e3p[GOO_LANES], e4p[GOO_LANES];
+    unsigned long i, l;
+
+    printf("Testing recover4...\n");
+
+    for (l = 0; l < GOO_LANES; l++) {
+      mpz_init(b1[l]);
+      mpz_init(b1i[l]);
+      mpz_init(b2[l]);
+      mpz_init(b2i[l]);
+      mpz_init(e1[l]);
+      mpz_init(e2[l]);
+      mpz_init(e3[l]);
+      mpz_init(e4[l]);
+      mpz_init(r1[l]);
+      mpz_init(r2[l]);
+
+      out[l] = r2[l];
+      b1p[l] = b1[l];
+      b1ip[l] = b1i[l];
+      b2p[l] = b2[l];
+      b2ip[l] = b2i[l];
+      e1p[l] = e1[l];
+      e2p[l] = e2[l];
+      e3p[l] = e3[l];
+      e4p[l] = e4[l];
+    }
+
+    for (i = 0; i < 10; i++) {
+      for (l = 0; l < GOO_LANES; l++) {
+        /* Vary the lengths so the lanes fall out of step. */
+        unsigned long bits = (i + l) & 1 ? 2048 + GOO_ELL_BITS : 2048;
+
+        goo_prng_random_bits(rng, b1[l], 2048);
+        goo_prng_random_bits(rng, b2[l], 2048);
+        goo_prng_random_bits(rng, e1[l], GOO_ELL_BITS - l);
+        goo_prng_random_bits(rng, e2[l], GOO_ELL_BITS - 7 * (i & 3));
+        goo_prng_random_bits(rng, e3[l], bits - 5 * l);
+        goo_prng_random_bits(rng, e4[l], bits);
+
+        ASSERT(goo_group_inv2(goo, b1i[l], b2i[l], b1[l], b2[l]));
+        ASSERT(goo_group_recover(goo, &scratch, r1[l], b1[l], b1i[l], e1[l],
+                                 b2[l], b2i[l], e2[l], e3[l], e4[l]));
+      }
+
+      ASSERT(goo_group_recover4(goo, &scratch, out, b1p, b1ip, e1p,
+                                b2p, b2ip, e2p, e3p, e4p));
+
+      for (l = 0; l < GOO_LANES; l++)
+        ASSERT(mpz_cmp(r1[l], r2[l]) == 0);
+    }
+
+    for (l = 0; l < GOO_LANES; l++) {
+      mpz_clear(b1[l]);
+      mpz_clear(b1i[l]);
+      mpz_clear(b2[l]);
+      mpz_clear(b2i[l]);
+      mpz_clear(e1[l]);
+      mpz_clear(e2[l]);
+      mpz_clear(e3[l]);
+      mpz_clear(e4[l]);
+      mpz_clear(r1[l]);
+      mpz_clear(r2[l]);
+    }
   }
 
   /* test powgh */
@@ -1833,7 +2419,7 @@ run_ops_test(goo_prng_t *rng) {
       goo_prng_random_bits(rng, e2, 2048 + GOO_ELL_BITS + 2 - 1);
 
       ASSERT(goo_group_powgh_slow(goo, r1, e1, e2));
-      ASSERT(goo_group_powgh(goo, r2, e1, e2));
+      ASSERT(goo_group_powgh(goo, &scratch, r2, e1, e2));
 
       ASSERT(mpz_cmp(r1, r2) == 0);
     }
@@ -1844,6 +2430,52 @@ run_ops_test(goo_prng_t *rng) {
     mpz_clear(r2);
   }
 
+  /* test powgh batch */
+  {
+    mpz_t e1[20], e2[20], r1[20];
+    mpz_ptr rp[20];
+    mpz_srcptr e1p[20], e2p[20];
+    mpz_t r2;
+    unsigned long i;
+
+    printf("Testing powgh batch...\n");
+
+    mpz_init(r2);
+
+    for (i = 0; i < 20; i++) {
+      mpz_init(e1[i]);
+      mpz_init(e2[i]);
+      mpz_init(r1[i]);
+
+      /* Mixed lengths (and zeroes) cross comb sizes. */
+      goo_prng_random_bits(rng, e1[i], (i % 3) ? 2048 + GOO_ELL_BITS + 1 : 0);
+      goo_prng_random_bits(rng, e2[i], (i % 5) ? 128 + i : 2048);
+
+      rp[i] = r1[i];
+      e1p[i] = e1[i];
+      e2p[i] = e2[i];
+    }
+
+    ASSERT(goo_group_powgh_batch(goo, rp, e1p, e2p, 20));
+
+    for (i = 0; i < 20; i++) {
+      ASSERT(goo_group_powgh(goo, &scratch, r2, e1[i], e2[i]));
+      ASSERT(mpz_cmp(r1[i], r2) == 0);
+    }
+
+    mpz_neg(e2[7], e2[7]);
+
+    ASSERT(!goo_group_powgh_batch(goo, rp, e1p, e2p, 20));
+
+    for (i = 0; i < 20; i++) {
+      mpz_clear(e1[i]);
+      mpz_clear(e2[i]);
+      mpz_clear(r1[i]);
+    }
+
+    mpz_clear(r2);
+  }
+
   /* test inv2 */
   {
     mpz_t e1, e2;
@@ -1937,6 +2569,7 @@ run_ops_test(goo_prng_t *rng) {
   }
 
   mpz_clear(n);
+  goo_scratch_uninit(&scratch);
   goo_group_uninit(goo);
   goo_free(goo);
 }
@@ -2080,6 +2713,7 @@ run_goo_test(goo_prng_t *rng) {
   mpz_t C1;
   goo_sig_t sig;
   goo_group_t *goo, *ver;
+  goo_scratch_t sign, check;
   unsigned char s_prime[32];
   unsigned char msg[32];
   unsigned long i;
@@ -2107,11 +2741,16 @@ run_goo_test(goo_prng_t *rng) {
 
   ASSERT(goo_group_init(goo, mod_n, 2, 3, 4096));
   ASSERT(goo_group_init(ver, mod_n, 2, 3, 0));
-  ASSERT(goo_group_challenge(goo, C1, s_prime, n));
-  ASSERT(goo_group_validate(goo, s_prime, C1, p, q));
-  ASSERT(goo_group_sign(goo, &sig, msg, sizeof(msg), s_prime, p, q));
-  ASSERT(goo_group_verify(goo, msg, sizeof(msg), &sig, C1));
-  ASSERT(goo_group_verify(ver, msg, sizeof(msg), &sig, C1));
+
+  goo_scratch_init(&sign, goo);
+  goo_scratch_init(&check, ver);
+
+  ASSERT(goo_group_challenge(goo, &sign, C1, s_prime, n));
+  ASSERT(goo_group_validate(goo, &sign, s_prime, C1, p, q));
+  ASSERT(goo_group_sign(goo, &sign, &sig, msg, sizeof(msg),
+                        s_prime, p, q, 1));
+  ASSERT(goo_group_verify(goo, &sign, msg, sizeof(msg), &sig, C1));
+  ASSERT(goo_group_verify(ver, &check, msg, sizeof(msg), &sig, C1));
 
   for (i = 0; i < 5; i++) {
     size_t prime_size = 1024 + goo_prng_random_num(rng, 1024);
@@ -2123,11 +2762,84 @@ run_goo_test(goo_prng_t *rng) {
     goo_prng_generate(rng, s_prime, sizeof(s_prime));
     goo_prng_generate(rng, msg, sizeof(msg));
 
-    ASSERT(goo_group_challenge(goo, C1, s_prime, n));
-    ASSERT(goo_group_validate(goo, s_prime, C1, p, q));
-    ASSERT(goo_group_sign(goo, &sig, msg, sizeof(msg), s_prime, p, q));
-    ASSERT(goo_group_verify(goo, msg, sizeof(msg), &sig, C1));
-    ASSERT(goo_group_verify(ver, msg, sizeof(msg), &sig, C1));
+    ASSERT(goo_group_challenge(goo, &sign, C1, s_prime, n));
+    ASSERT(goo_group_validate(goo, &sign, s_prime, C1, p, q));
+    ASSERT(goo_group_sign(goo, &sign, &sig, msg, sizeof(msg),
+                          s_prime, p, q, 1));
+    ASSERT(goo_group_verify(goo, &sign, msg, sizeof(msg), &sig, C1));
+    ASSERT(goo_group_verify(ver, &check, msg, sizeof(msg), &sig, C1));
+  }
+
+  printf("Testing batch hashing...\n");
+
+  {
+    /* C1, C2, C3, t, A, B, C, D, E for each entry. */
+    mpz_t vals[5][9];
+    mpz_srcptr items[5 * 9];
+    mpz_t chals[5], ells[5];
+    const unsigned char *msgs[5];
+    size_t msg_lens[5];
+    unsigned char keys[5 * 32];
+    unsigned char key[32];
+    int ok[5];
+    size_t j;
+
+    for (i = 0; i < 5; i++) {
+      for (j = 0; j < 9; j++) {
+        mpz_init(vals[i][j]);
+
+        if (j == 3)
+          mpz_set_ui(vals[i][j], 0x10001 + i);
+        else if (j == 8)
+          goo_prng_random_bits(rng, vals[i][j], GOO_EXP_BYTES * 8 - 1);
+        else
+          goo_prng_random_int(rng, vals[i][j], ver->n);
+
+        items[i * 9 + j] = vals[i][j];
+      }
+
+      if (i & 1)
+        mpz_neg(vals[i][8], vals[i][8]);
+
+      mpz_init(chals[i]);
+      mpz_init(ells[i]);
+
+      msgs[i] = msg;
+      msg_lens[i] = i * 7;
+      ok[i] = 1;
+    }
+
+    /* Skipped and unencodable entries. */
+    ok[1] = 0;
+    mpz_neg(vals[3][4], vals[3][4]);
+
+    goo_group_derive_batch(ver, &check, ok, chals, ells,
+                           keys, items, msgs, msg_lens, 5);
+
+    ASSERT(ok[0] && !ok[1] && ok[2] && !ok[3] && ok[4]);
+
+    for (i = 0; i < 5; i++) {
+      if (!ok[i])
+        continue;
+
+      ASSERT(goo_group_derive(ver, &check, p, q, key,
+                              vals[i][0], vals[i][1], vals[i][2],
+                              vals[i][3], vals[i][4], vals[i][5],
+                              vals[i][6], vals[i][7], vals[i][8],
+                              msgs[i], msg_lens[i]));
+
+      ASSERT(memcmp(&keys[i * 32], key, 32) == 0);
+      ASSERT(mpz_cmp(chals[i], p) == 0);
+      ASSERT(mpz_cmp(ells[i], q) == 0);
+    }
+
+    for (i = 0; i < 5; i++) {
+      for (j = 0; j < 9; j++)
+        mpz_clear(vals[i][j]);
+
+      mpz_clear(chals[i]);
+      mpz_clear(ells[i]);
+    }
   }
 
   mpz_clear(p);
@@ -2136,6 +2848,8 @@ run_goo_test(goo_prng_t *rng) {
   mpz_clear(mod_n);
   mpz_clear(C1);
   goo_sig_uninit(&sig);
+  goo_scratch_uninit(&sign);
+  goo_scratch_uninit(&check);
   goo_group_uninit(goo);
   goo_group_uninit(ver);
   goo_free(goo);
@@ -2154,6 +2868,7 @@ run_api_test(goo_prng_t *rng) {
   unsigned char msg[32];
   unsigned char exp[3] = {0x01, 0x00, 0x01};
   goo_group_t *goo, *ver;
+  goo_scratch_t *scratch;
 
   printf("Testing API...\n");
 
@@ -2168,9 +2883,13 @@ run_api_test(goo_prng_t *rng) {
   ASSERT(goo != NULL);
   ASSERT(ver != NULL);
 
+  scratch = goo_scratch_create(ver);
+
+  ASSERT(scratch != NULL);
+
   ASSERT(goo_generate(goo, s_prime, entropy1));
 
-  ASSERT(goo_challenge(goo, &C1, &C1_len, s_prime,
+  ASSERT(goo_challenge(goo, NULL, &C1, &C1_len, s_prime,
                        MODULUS_4096, sizeof(MODULUS_4096)));
 
   ASSERT(goo_encrypt(goo, &ct, &ct_len, C1, C1_len,
@@ -2185,21 +2904,486 @@ run_api_test(goo_prng_t *rng) {
   ASSERT(pt_len == C1_len);
   ASSERT(memcmp(pt, C1, pt_len) == 0);
 
-  ASSERT(goo_validate(goo, s_prime, C1, C1_len,
+  {
+    /* The blinding pair is squared between calls. */
+    goo_decryptor_t *key;
+    unsigned char *pt2;
+    size_t pt2_len;
+    size_t i;
+
+    ASSERT(goo_decryptor_create(PRIME_P_2048, sizeof(PRIME_P_2048),
+                                PRIME_P_2048, sizeof(PRIME_P_2048),
+                                exp, sizeof(exp), entropy3) == NULL);
+
+    key = goo_decryptor_create(PRIME_P_2048, sizeof(PRIME_P_2048),
+                               PRIME_Q_2048, sizeof(PRIME_Q_2048),
+                               exp, sizeof(exp), entropy3);
+
+    ASSERT(key != NULL);
+
+    for (i = 0; i < 4; i++) {
+      ASSERT(goo_decryptor_decrypt(key, &pt2, &pt2_len,
+                                   ct, ct_len, NULL, 0));
+
+      ASSERT(pt2_len == C1_len);
+      ASSERT(memcmp(pt2, C1, pt2_len) == 0);
+
+      goo_free(pt2);
+    }
+
+    ASSERT(!goo_decryptor_decrypt(key, &pt2, &pt2_len,
+                                  ct, ct_len, exp, sizeof(exp)));
+
+    ct[ct_len - 1] ^= 1;
+
+    ASSERT(!goo_decryptor_decrypt(key, &pt2, &pt2_len,
+                                  ct, ct_len, NULL, 0));
+
+    ct[ct_len - 1] ^= 1;
+
+    {
+      /* A faulty CRT half is caught before unblinding. */
+      mpz_t m;
+
+      mpz_init_set_ui(m, 2);
+
+      ASSERT(goo_decryptor_pow(key, m));
+
+      mpz_powm(m, m, key->e, key->n);
+
+      ASSERT(mpz_cmp_ui(m, 2) == 0);
+
+      mpz_add_ui(key->dp, key->dp, 2);
+
+      ASSERT(!goo_decryptor_pow(key, m));
+      ASSERT(mpz_sgn(m) == 0);
+
+      ASSERT(!goo_decryptor_decrypt(key, &pt2, &pt2_len,
+                                    ct, ct_len, NULL, 0));
+
+      mpz_clear(m);
+    }
+
+    goo_decryptor_destroy(key);
+  }
+
+  {
+    /* Matches are reported in order at any thread count. */
+    static const size_t threads[3] = { 0, 1, 3 };
+    static const unsigned char valid[7] = { 0, 1, 0, 0, 1, 1, 0 };
+    unsigned char data[7 * GOO_SCAN_SIZE];
+    const char *file = "goo-scan.tmp";
+    size_t *indices;
+    size_t count, total;
+    FILE *stream;
+    size_t i, j;
+
+    ASSERT(ct_len == GOO_SCAN_SIZE);
+
+    for (i = 0; i < 7; i++) {
+      unsigned char *block = &data[i * GOO_SCAN_SIZE];
+
+      if (valid[i]) {
+        unsigned char *ct2;
+        size_t ct2_len;
+
+        goo_prng_generate(rng, entropy2, sizeof(entropy2));
+
+        ASSERT(goo_encrypt(goo, &ct2, &ct2_len, C1, C1_len,
+                           MODULUS_4096, sizeof(MODULUS_4096),
+                           exp, sizeof(exp), NULL, 0, entropy2));
+
+        memcpy(block, ct2, GOO_SCAN_SIZE);
+
+        goo_free(ct2);
+      } else {
+        goo_prng_generate(rng, block, GOO_SCAN_SIZE);
+      }
+    }
+
+    for (i = 0; i < 3; i++) {
+      ASSERT(goo_scan(&indices, &count, data, sizeof(data),
+                      PRIME_P_2048, sizeof(PRIME_P_2048),
+                      PRIME_Q_2048, sizeof(PRIME_Q_2048),
+                      exp, sizeof(exp), NULL, 0, entropy3, threads[i]));
+
+      ASSERT(count == 3);
+      ASSERT(indices[0] == 1 && indices[1] == 4 && indices[2] == 5);
+
+      free(indices);
+    }
+
+    ASSERT(!goo_scan(&indices, &count, data, sizeof(data) - 1,
+                     PRIME_P_2048, sizeof(PRIME_P_2048),
+                     PRIME_Q_2048, sizeof(PRIME_Q_2048),
+                     exp, sizeof(exp), NULL, 0, entropy3, 0));
+
+    stream = fopen(file, "wb");
+
+    ASSERT(stream != NULL);
+    ASSERT(fwrite(data, 1, sizeof(data), stream) == sizeof(data));
+    ASSERT(fclose(stream) == 0);
+
+    ASSERT(goo_scan_file(&indices, &count, &total, file,
+                         PRIME_P_2048, sizeof(PRIME_P_2048),
+                         PRIME_Q_2048, sizeof(PRIME_Q_2048),
+                         exp, sizeof(exp), NULL, 0, entropy3, 2));
+
+    ASSERT(remove(file) == 0);
+
+    ASSERT(total == 7);
+    ASSERT(count == 3);
+
+    for (j = 0, i = 0; i < 7; i++) {
+      if (valid[i])
+        ASSERT(indices[j++] == i);
+    }
+
+    free(indices);
+  }
+
+  ASSERT(goo_validate(goo, NULL, s_prime, C1, C1_len,
                       PRIME_P_2048, sizeof(PRIME_P_2048),
                       PRIME_Q_2048, sizeof(PRIME_Q_2048)));
 
-  ASSERT(goo_sign(goo, &sig, &sig_len, msg, sizeof(msg), s_prime,
+  ASSERT(goo_sign(goo, NULL, &sig, &sig_len, msg, sizeof(msg), s_prime,
                   PRIME_P_2048, sizeof(PRIME_P_2048),
                   PRIME_Q_2048, sizeof(PRIME_Q_2048)));
 
-  ASSERT(goo_verify(goo, msg, sizeof(msg), sig, sig_len, C1, C1_len));
-  ASSERT(goo_verify(ver, msg, sizeof(msg), sig, sig_len, C1, C1_len));
+  ASSERT(goo_verify(goo, NULL, msg, sizeof(msg), sig, sig_len, C1, C1_len));
+  ASSERT(goo_verify(ver, scratch, msg, sizeof(msg), sig, sig_len, C1, C1_len));
+
+  {
+    /* Enough messages that some need several tries at `ell`. */
+    static const size_t threads[3] = { 0, 2, 5 };
+    goo_scratch_t *scratch2 = goo_scratch_create(goo);
+    goo_signer_t *signer;
+    unsigned char *sig1, *sig2;
+    size_t sig1_len, sig2_len;
+    unsigned char msg2[32];
+    unsigned char bad[sizeof(PRIME_P_2048)];
+    size_t i, j;
+
+    memcpy(msg2, msg, sizeof(msg));
+    memcpy(bad, PRIME_P_2048, sizeof(PRIME_P_2048));
+
+    bad[sizeof(bad) - 1] ^= 1;
+
+    ASSERT(goo_signer_create(goo, NULL, s_prime,
+                             bad, sizeof(bad),
+                             PRIME_Q_2048, sizeof(PRIME_Q_2048)) == NULL);
+
+    signer = goo_signer_create(goo, scratch2, s_prime,
+                               PRIME_P_2048, sizeof(PRIME_P_2048),
+                               PRIME_Q_2048, sizeof(PRIME_Q_2048));
+
+    ASSERT(signer != NULL);
+
+    for (i = 0; i < 6; i++) {
+      msg2[0] ^= (unsigned char)(i + 1);
+
+      ASSERT(goo_sign(goo, NULL, &sig1, &sig1_len,
+                      msg2, sizeof(msg2), s_prime,
+                      PRIME_P_2048, sizeof(PRIME_P_2048),
+                      PRIME_Q_2048, sizeof(PRIME_Q_2048)));
+
+      for (j = 0; j < 3; j++) {
+        ASSERT(goo_sign_parallel(goo, NULL, &sig2, &sig2_len,
+                                 msg2, sizeof(msg2), s_prime,
+                                 PRIME_P_2048, sizeof(PRIME_P_2048),
+                                 PRIME_Q_2048, sizeof(PRIME_Q_2048),
+                                 threads[j]));
+
+        ASSERT(sig2_len == sig1_len);
+        ASSERT(memcmp(sig2, sig1, sig1_len) == 0);
+
+        goo_free(sig2);
+
+        ASSERT(goo_signer_sign(signer, j == 0 ? NULL : scratch2,
+                               &sig2, &sig2_len,
+                               msg2, sizeof(msg2), threads[j]));
+
+        ASSERT(sig2_len == sig1_len);
+        ASSERT(memcmp(sig2, sig1, sig1_len) == 0);
+
+        goo_free(sig2);
+      }
+
+      goo_free(sig1);
+    }
+
+    {
+      /* Presigned signatures verify and differ from the */
+      /* deterministic ones. Reusing the entropy on one */
+      /* signer still yields fresh nonces every time. */
+      goo_presig_t *presigs[3];
+      goo_presig_t *presig;
+
+      ASSERT(goo_signer_presign_many(signer, presigs, 3, entropy3, 0));
+
+      presig = goo_signer_presign(signer, scratch2, entropy3, 2);
+
+      ASSERT(presig != NULL);
+
+      ASSERT(goo_signer_sign_presig(signer, NULL, presig, &sig1, &sig1_len,
+                                    msg, sizeof(msg), 1));
+
+      ASSERT(goo_verify(goo, NULL, msg, sizeof(msg),
+                        sig1, sig1_len, C1, C1_len));
+
+      for (i = 0; i < 3; i++) {
+        ASSERT(goo_signer_sign_presig(signer, scratch2, presigs[i],
+                                      &sig2, &sig2_len,
+                                      msg, sizeof(msg), threads[i]));
+
+        ASSERT(goo_verify(goo, NULL, msg, sizeof(msg),
+                          sig2, sig2_len, C1, C1_len));
+
+        ASSERT(sig2_len != sig_len || memcmp(sig2, sig, sig_len) != 0);
+        ASSERT(sig2_len != sig1_len || memcmp(sig2, sig1, sig1_len) != 0);
+
+        goo_free(sig2);
+      }
+
+      goo_free(sig1);
+
+      presig = goo_signer_presign(signer, NULL, entropy3, 1);
+
+      ASSERT(presig != NULL);
+
+      ASSERT(goo_signer_sign_presig(signer, NULL, presig, &sig2, &sig2_len,
+                                    msg, sizeof(msg), 1));
+
+      ASSERT(goo_signer_presign_many(signer, presigs, 1, entropy3, 1));
+
+      ASSERT(goo_signer_sign_presig(signer, NULL, presigs[0],
+                                    &sig1, &sig1_len,
+                                    msg, sizeof(msg), 1));
+
+      ASSERT(sig2_len != sig1_len || memcmp(sig2, sig1, sig1_len) != 0);
+
+      goo_free(sig1);
+      goo_free(sig2);
+    }
+
+    goo_signer_destroy(signer);
+    goo_scratch_destroy(scratch2);
+  }
+
+  {
+    const unsigned char *msgs[4];
+    const unsigned char *sigs[4];
+    const unsigned char *C1s[4];
+    size_t msg_lens[4], sig_lens[4], C1_lens[4];
+    unsigned char *bad = goo_malloc(sig_len);
+    int results[4];
+    size_t i;
+
+    memcpy(bad, sig, sig_len);
+    bad[sig_len - 1] ^= 1;
+
+    for (i = 0; i < 4; i++) {
+      msgs[i] = msg;
+      msg_lens[i] = sizeof(msg);
+      sigs[i] = sig;
+      sig_lens[i] = sig_len;
+      C1s[i] = C1;
+      C1_lens[i] = C1_len;
+    }
+
+    sigs[1] = bad;
+    msg_lens[3] = sizeof(msg) - 1;
+
+    ASSERT(!goo_verify_batch(ver, scratch, 4, msgs, msg_lens, sigs,
+                             sig_lens, C1s, C1_lens, results));
+
+    ASSERT(results[0] == 1);
+    ASSERT(results[1] == 0);
+    ASSERT(results[2] == 1);
+    ASSERT(results[3] == 0);
+
+    ASSERT(goo_verify_batch(ver, NULL, 1, msgs, msg_lens, sigs,
+                            sig_lens, C1s, C1_lens, results));
+
+    ASSERT(results[0] == 1);
+
+    goo_free(bad);
+  }
+
+  {
+    /* A larger batch with failures at the start, middle */
+    /* and end. A zero C2 cannot be inverted, forcing the */
+    /* batched inversion to bisect down to each culprit. */
+    static const size_t zeroed[4] = { 0, 5, 16, 32 };
+    static const size_t flipped[3] = { 1, 17, 31 };
+    const unsigned char *msgs[33];
+    const unsigned char *sigs[33];
+    const unsigned char *C1s[33];
+    size_t msg_lens[33], sig_lens[33], C1_lens[33];
+    unsigned char *bad = goo_malloc(sig_len);
+    unsigned char *zero = goo_malloc(sig_len);
+    int results[33];
+    size_t i;
+
+    memcpy(bad, sig, sig_len);
+    bad[sig_len - 1] ^= 1;
+
+    memcpy(zero, sig, sig_len);
+    memset(zero, 0, 256);
+
+    for (i = 0; i < 33; i++) {
+      msgs[i] = msg;
+      msg_lens[i] = sizeof(msg);
+      sigs[i] = sig;
+      sig_lens[i] = sig_len;
+      C1s[i] = C1;
+      C1_lens[i] = C1_len;
+    }
+
+    for (i = 0; i < 4; i++)
+      sigs[zeroed[i]] = zero;
+
+    for (i = 0; i < 3; i++)
+      sigs[flipped[i]] = bad;
+
+    msg_lens[24] = sizeof(msg) - 1;
+
+    ASSERT(!goo_verify_batch(ver, scratch, 33, msgs, msg_lens, sigs,
+                             sig_lens, C1s, C1_lens, results));
+
+    for (i = 0; i < 33; i++) {
+      int expect = goo_verify(ver, scratch, msgs[i], msg_lens[i],
+                              sigs[i], sig_lens[i], C1s[i], C1_lens[i]);
+
+      ASSERT(results[i] == expect);
+      ASSERT(expect == (sigs[i] == sig && msg_lens[i] == sizeof(msg)));
+    }
+
+    goo_free(bad);
+    goo_free(zero);
+  }
+
+  {
+    goo_verify_job_t jobs[5];
+    size_t i;
+
+    for (i = 0; i < 5; i++) {
+      jobs[i].msg = msg;
+      jobs[i].msg_len = sizeof(msg);
+      jobs[i].sig = sig;
+      jobs[i].sig_len = sig_len;
+      jobs[i].C1 = C1;
+      jobs[i].C1_len = C1_len;
+      jobs[i].result = -1;
+    }
+
+    jobs[2].msg_len = sizeof(msg) - 1;
+
+    ASSERT(!goo_verify_many(ver, jobs, 5, 3));
+
+    for (i = 0; i < 5; i++)
+      ASSERT(jobs[i].result == (i != 2));
+
+    jobs[2].msg_len = sizeof(msg);
+
+    ASSERT(goo_verify_many(ver, jobs, 5, 0));
+
+    for (i = 0; i < 5; i++)
+      ASSERT(jobs[i].result == 1);
+  }
+
+  {
+    /* Records match the per-key API byte for byte. */
+    static const unsigned char even[2] = {0x01, 0x00};
+    unsigned char entropy[4][64];
+    unsigned char *out, *rec;
+    unsigned char sp[32];
+    goo_airdrop_job_t jobs[4];
+    unsigned char *C1x, *ctx;
+    size_t C1x_len, ctx_len;
+    size_t size = goo_airdrop_size(goo);
+    size_t i;
+
+    ASSERT(size == 32 + 256 + 513);
+
+    out = goo_malloc(4 * size);
+
+    for (i = 0; i < 4; i++) {
+      goo_prng_generate(rng, entropy[i], 64);
+
+      jobs[i].n = (i & 1) ? MODULUS_2048 : MODULUS_4096;
+      jobs[i].n_len = (i & 1) ? sizeof(MODULUS_2048) : sizeof(MODULUS_4096);
+      jobs[i].e = exp;
+      jobs[i].e_len = sizeof(exp);
+      jobs[i].entropy = entropy[i];
+      jobs[i].out = &out[i * size];
+      jobs[i].result = -1;
+    }
+
+    jobs[2].n = even;
+    jobs[2].n_len = sizeof(even);
+
+    ASSERT(!goo_airdrop_many(goo, jobs, 4, NULL, 0, 3));
+
+    for (i = 0; i < 4; i++) {
+      rec = &out[i * size];
+
+      if (i == 2) {
+        ASSERT(jobs[i].result == 0);
+        ASSERT(rec[0] == 0 && memcmp(rec, rec + 1, size - 1) == 0);
+        continue;
+      }
+
+      ASSERT(jobs[i].result == 1);
+
+      ASSERT(goo_generate(goo, sp, entropy[i]));
+      ASSERT(goo_challenge(goo, NULL, &C1x, &C1x_len, sp,
+                           jobs[i].n, jobs[i].n_len));
+      ASSERT(goo_encrypt(goo, &ctx, &ctx_len, sp, sizeof(sp),
+                         jobs[i].n, jobs[i].n_len, exp, sizeof(exp),
+                         NULL, 0, entropy[i] + 32));
+
+      ASSERT(memcmp(rec, sp, 32) == 0);
+      ASSERT(C1x_len == 256 && memcmp(rec + 32, C1x, 256) == 0);
+      ASSERT(ctx_len == 513 && memcmp(rec + 32 + 256, ctx, 513) == 0);
+
+      goo_free(C1x);
+      goo_free(ctx);
+    }
+
+    {
+      /* Keys too large for the combs only fail themselves, */
+      /* even when they share a block with smaller ones. */
+      goo_ctx_t *small = goo_create(GOO_RSA2048, sizeof(GOO_RSA2048),
+                                    2, 3, 1024);
+      unsigned char *out2 = goo_malloc(4 * size);
+
+      ASSERT(small != NULL);
+
+      for (i = 0; i < 4; i++)
+        jobs[i].out = &out2[i * size];
+
+      ASSERT(!goo_airdrop_many(small, jobs, 4, NULL, 0, 1));
+
+      for (i = 0; i < 4; i++) {
+        ASSERT(jobs[i].result == (i == 1 || i == 3));
+
+        if (jobs[i].result)
+          ASSERT(memcmp(&out2[i * size], &out[i * size], size) == 0);
+      }
+
+      goo_free(out2);
+      goo_destroy(small);
+    }
+
+    goo_free(out);
+  }
 
   goo_free(C1);
   goo_free(ct);
   goo_free(pt);
   goo_free(sig);
+  goo_scratch_destroy(scratch);
   goo_destroy(goo);
   goo_destroy(ver);
 }
@@ -2209,7 +3393,6 @@ main(void) {
   goo_prng_t rng;
 
   (void)PRIME_Q_1024;
-  (void)MODULUS_2048;
 
   rng_init(&rng);
 
@@ -2217,6 +3400,7 @@ main(void) {
   run_hmac_test();
   run_drbg_test();
   run_prng_test();
+  run_sha256_backend_test(&rng);
 #ifdef GOO_HAS_CRYPTO
   run_sha256_test(&rng);
 #endif
@@ -7,19 +7,25 @@
 #ifndef _GOO_UTIL_H
 #define _GOO_UTIL_H
 
-#include <stdio.h>
 #include <stdlib.h>
 
+#if defined(__GNUC__)
+#define GOO_NORETURN __attribute__((noreturn))
+#elif defined(_MSC_VER)
+#define GOO_NORETURN __declspec(noreturn)
+#else
+#define GOO_NORETURN
+#endif
+
 #define ASSERT(expr) do {                         \
   if (!(expr))                                    \
     __goo_assert_fail(__FILE__, __LINE__, #expr); \
 } while (0)
 
-static void
-__goo_assert_fail(const char *file, int line, const char *expr) {
-  fprintf(stderr, "%s:%d: Assertion `%s' failed.\n", file, line, expr);
-  fflush(stderr);
-  abort();
-}
+GOO_NORETURN void
+__goo_assert_fail(const char *file, int line, const char *expr);
+
+void
+goo_cleanse(void *ptr, size_t len);
 
 #endif
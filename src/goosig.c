@@ -11,6 +11,7 @@
 #include <stdio.h>
 #include <node_api.h>
 #include "goo/goo.h"
+#include "goo/util.h"
 
 #define CHECK(expr) do {                           \
   if (!(expr))                                     \
@@ -46,14 +47,21 @@ goosig_assert_fail(const char *file, int line, const char *expr) {
  * GooSig
  */
 
+typedef struct goosig_s {
+  goo_ctx_t *ctx;
+  goo_scratch_t *scratch;
+} goosig_t;
+
 static void
 goosig_destroy(napi_env env, void *data, void *hint) {
-  goo_ctx_t *goo = (goo_ctx_t *)data;
+  goosig_t *goo = (goosig_t *)data;
 
   (void)env;
   (void)hint;
 
-  goo_destroy(goo);
+  goo_scratch_destroy(goo->scratch);
+  goo_destroy(goo->ctx);
+  free(goo);
 }
 
 static napi_value
@@ -63,7 +71,8 @@ goosig_create(napi_env env, napi_callback_info info) {
   const uint8_t *n;
   size_t n_len;
   uint32_t g, h, bits;
-  goo_ctx_t *goo;
+  goo_ctx_t *ctx;
+  goosig_t *goo;
   napi_value handle;
 
   CHECK(napi_get_cb_info(env, info, &argc, argv, NULL, NULL) == napi_ok);
@@ -73,9 +82,18 @@ goosig_create(napi_env env, napi_callback_info info) {
   CHECK(napi_get_value_uint32(env, argv[2], &h) == napi_ok);
   CHECK(napi_get_value_uint32(env, argv[3], &bits) == napi_ok);
 
-  goo = goo_create(n, n_len, g, h, bits);
+  ctx = goo_create(n, n_len, g, h, bits);
+
+  JS_ASSERT(ctx != NULL, JS_ERR_CONTEXT);
+
+  goo = malloc(sizeof(goosig_t));
 
-  JS_ASSERT(goo != NULL, JS_ERR_CONTEXT);
+  CHECK(goo != NULL);
+
+  goo->ctx = ctx;
+  goo->scratch = goo_scratch_create(ctx);
+
+  CHECK(goo->scratch != NULL);
 
   CHECK(napi_create_external(env,
                              goo,
@@ -116,7 +134,7 @@ goosig_challenge(napi_env env, napi_callback_info info) {
   size_t out_len;
   const uint8_t *s_prime, *n;
   size_t s_prime_len, n_len;
-  goo_ctx_t *goo;
+  goosig_t *goo;
   napi_value result;
 
   CHECK(napi_get_cb_info(env, info, &argc, argv, NULL, NULL) == napi_ok);
@@ -127,8 +145,8 @@ goosig_challenge(napi_env env, napi_callback_info info) {
   CHECK(napi_get_buffer_info(env, argv[2], (void **)&n, &n_len) == napi_ok);
 
   JS_ASSERT(s_prime_len == 32, JS_ERR_SPRIME_SIZE);
-  JS_ASSERT(goo_challenge(goo, &out, &out_len, s_prime, n, n_len),
-            JS_ERR_CHALLENGE);
+  JS_ASSERT(goo_challenge(goo->ctx, goo->scratch, &out, &out_len,
+                          s_prime, n, n_len), JS_ERR_CHALLENGE);
 
   CHECK(napi_create_buffer_copy(env, out_len, out, NULL, &result) == napi_ok);
 
@@ -143,7 +161,7 @@ goosig_validate(napi_env env, napi_callback_info info) {
   size_t argc = 5;
   const uint8_t *s_prime, *C1, *p, *q;
   size_t s_prime_len, C1_len, p_len, q_len;
-  goo_ctx_t *goo;
+  goosig_t *goo;
   napi_value result;
   int ok;
 
@@ -158,7 +176,8 @@ goosig_validate(napi_env env, napi_callback_info info) {
 
   JS_ASSERT(s_prime_len == 32, JS_ERR_SPRIME_SIZE);
 
-  ok = goo_validate(goo, s_prime, C1, C1_len, p, p_len, q, q_len);
+  ok = goo_validate(goo->ctx, goo->scratch, s_prime,
+                    C1, C1_len, p, p_len, q, q_len);
 
   CHECK(napi_get_boolean(env, ok, &result) == napi_ok);
 
@@ -173,7 +192,7 @@ goosig_sign(napi_env env, napi_callback_info info) {
   size_t out_len;
   const uint8_t *msg, *s_prime, *p, *q;
   size_t msg_len, s_prime_len, p_len, q_len;
-  goo_ctx_t *goo;
+  goosig_t *goo;
   napi_value result;
   int ok;
 
@@ -188,7 +207,8 @@ goosig_sign(napi_env env, napi_callback_info info) {
 
   JS_ASSERT(s_prime_len == 32, JS_ERR_SPRIME_SIZE);
 
-  ok = goo_sign(goo, &out, &out_len, msg, msg_len, s_prime, p, p_len, q, q_len);
+  ok = goo_sign(goo->ctx, goo->scratch, &out, &out_len,
+                msg, msg_len, s_prime, p, p_len, q, q_len);
 
   JS_ASSERT(ok, JS_ERR_SIGN);
 
@@ -205,7 +225,7 @@ goosig_verify(napi_env env, napi_callback_info info) {
   size_t argc = 4;
   const uint8_t *msg, *sig, *C1;
   size_t msg_len, sig_len, C1_len;
-  goo_ctx_t *goo;
+  goosig_t *goo;
   napi_value result;
   int ok;
 
@@ -217,13 +237,246 @@ goosig_verify(napi_env env, napi_callback_info info) {
   CHECK(napi_get_buffer_info(env, argv[2], (void **)&sig, &sig_len) == napi_ok);
   CHECK(napi_get_buffer_info(env, argv[3], (void **)&C1, &C1_len) == napi_ok);
 
-  ok = goo_verify(goo, msg, msg_len, sig, sig_len, C1, C1_len);
+  ok = goo_verify(goo->ctx, goo->scratch, msg, msg_len,
+                  sig, sig_len, C1, C1_len);
 
   CHECK(napi_get_boolean(env, ok, &result) == napi_ok);
 
   return result;
 }
 
+/*
+ * Async
+ */
+
+enum goosig_op {
+  GOOSIG_CHALLENGE,
+  GOOSIG_VALIDATE,
+  GOOSIG_SIGN,
+  GOOSIG_VERIFY
+};
+
+typedef struct goosig_job_s {
+  enum goosig_op op;
+  goo_ctx_t *ctx;
+  napi_ref ref;
+  napi_deferred deferred;
+  napi_async_work work;
+  uint8_t *args[4];
+  size_t lens[4];
+  uint8_t *out;
+  size_t out_len;
+  int ok;
+} goosig_job_t;
+
+static void
+goosig_job_execute(napi_env env, void *data) {
+  goosig_job_t *job = (goosig_job_t *)data;
+  uint8_t **a = job->args;
+  size_t *l = job->lens;
+
+  (void)env;
+
+  /* Runs on the libuv threadpool. The context is shared */
+  /* read-only; each call gets a temporary scratch. */
+  switch (job->op) {
+    case GOOSIG_CHALLENGE:
+      job->ok = goo_challenge(job->ctx, NULL, &job->out, &job->out_len,
+                              a[0], a[1], l[1]);
+      break;
+    case GOOSIG_VALIDATE:
+      job->ok = goo_validate(job->ctx, NULL, a[0], a[1], l[1],
+                             a[2], l[2], a[3], l[3]);
+      break;
+    case GOOSIG_SIGN:
+      job->ok = goo_sign(job->ctx, NULL, &job->out, &job->out_len,
+                         a[0], l[0], a[1], a[2], l[2], a[3], l[3]);
+      break;
+    case GOOSIG_VERIFY:
+      job->ok = goo_verify(job->ctx, NULL, a[0], l[0],
+                           a[1], l[1], a[2], l[2]);
+      break;
+  }
+}
+
+static void
+goosig_job_complete(napi_env env, napi_status status, void *data) {
+  goosig_job_t *job = (goosig_job_t *)data;
+  napi_value result;
+  size_t i;
+
+  if (status != napi_ok)
+    job->ok = 0;
+
+  switch (job->op) {
+    case GOOSIG_CHALLENGE:
+    case GOOSIG_SIGN: {
+      if (job->ok) {
+        CHECK(napi_create_buffer_copy(env,
+                                      job->out_len,
+                                      job->out,
+                                      NULL,
+                                      &result) == napi_ok);
+
+        CHECK(napi_resolve_deferred(env, job->deferred, result) == napi_ok);
+      } else {
+        const char *msg = job->op == GOOSIG_SIGN ? JS_ERR_SIGN
+                                                 : JS_ERR_CHALLENGE;
+        napi_value str;
+
+        CHECK(napi_create_string_utf8(env, msg, NAPI_AUTO_LENGTH,
+                                      &str) == napi_ok);
+        CHECK(napi_create_error(env, NULL, str, &result) == napi_ok);
+        CHECK(napi_reject_deferred(env, job->deferred, result) == napi_ok);
+      }
+      break;
+    }
+
+    case GOOSIG_VALIDATE:
+    case GOOSIG_VERIFY: {
+      CHECK(napi_get_boolean(env, job->ok, &result) == napi_ok);
+      CHECK(napi_resolve_deferred(env, job->deferred, result) == napi_ok);
+      break;
+    }
+  }
+
+  CHECK(napi_delete_async_work(env, job->work) == napi_ok);
+  CHECK(napi_delete_reference(env, job->ref) == napi_ok);
+
+  for (i = 0; i < 4; i++) {
+    if (job->args[i] != NULL) {
+      goo_cleanse(job->args[i], job->lens[i]);
+      free(job->args[i]);
+    }
+  }
+
+  free(job->out);
+  free(job);
+}
+
+static napi_value
+goosig_job_queue(napi_env env,
+                 enum goosig_op op,
+                 napi_value handle,
+                 const napi_value *argv,
+                 size_t argc) {
+  static const char *names[] = {
+    "goosig_challenge",
+    "goosig_validate",
+    "goosig_sign",
+    "goosig_verify"
+  };
+
+  goosig_job_t *job;
+  goosig_t *goo;
+  napi_value name, promise;
+  size_t i;
+
+  CHECK(argc <= 4);
+  CHECK(napi_get_value_external(env, handle, (void **)&goo) == napi_ok);
+
+  job = calloc(1, sizeof(goosig_job_t));
+
+  CHECK(job != NULL);
+
+  job->op = op;
+  job->ctx = goo->ctx;
+
+  /* Copy the inputs; the caller may */
+  /* mutate them before we are done. */
+  for (i = 0; i < argc; i++) {
+    const uint8_t *data;
+    size_t len;
+
+    CHECK(napi_get_buffer_info(env, argv[i], (void **)&data,
+                               &len) == napi_ok);
+
+    job->args[i] = malloc(len + 1);
+    job->lens[i] = len;
+
+    CHECK(job->args[i] != NULL);
+
+    if (len > 0)
+      memcpy(job->args[i], data, len);
+  }
+
+  /* Keep the context alive until we complete. */
+  CHECK(napi_create_reference(env, handle, 1, &job->ref) == napi_ok);
+
+  CHECK(napi_create_string_latin1(env, names[op], NAPI_AUTO_LENGTH,
+                                  &name) == napi_ok);
+
+  CHECK(napi_create_promise(env, &job->deferred, &promise) == napi_ok);
+
+  CHECK(napi_create_async_work(env,
+                               NULL,
+                               name,
+                               goosig_job_execute,
+                               goosig_job_complete,
+                               job,
+                               &job->work) == napi_ok);
+
+  CHECK(napi_queue_async_work(env, job->work) == napi_ok);
+
+  return promise;
+}
+
+static napi_value
+goosig_challenge_async(napi_env env, napi_callback_info info) {
+  napi_value argv[3];
+  size_t argc = 3;
+  size_t s_prime_len;
+
+  CHECK(napi_get_cb_info(env, info, &argc, argv, NULL, NULL) == napi_ok);
+  CHECK(argc == 3);
+  CHECK(napi_get_buffer_info(env, argv[1], NULL, &s_prime_len) == napi_ok);
+
+  JS_ASSERT(s_prime_len == 32, JS_ERR_SPRIME_SIZE);
+
+  return goosig_job_queue(env, GOOSIG_CHALLENGE, argv[0], argv + 1, 2);
+}
+
+static napi_value
+goosig_validate_async(napi_env env, napi_callback_info info) {
+  napi_value argv[5];
+  size_t argc = 5;
+  size_t s_prime_len;
+
+  CHECK(napi_get_cb_info(env, info, &argc, argv, NULL, NULL) == napi_ok);
+  CHECK(argc == 5);
+  CHECK(napi_get_buffer_info(env, argv[1], NULL, &s_prime_len) == napi_ok);
+
+  JS_ASSERT(s_prime_len == 32, JS_ERR_SPRIME_SIZE);
+
+  return goosig_job_queue(env, GOOSIG_VALIDATE, argv[0], argv + 1, 4);
+}
+
+static napi_value
+goosig_sign_async(napi_env env, napi_callback_info info) {
+  napi_value argv[5];
+  size_t argc = 5;
+  size_t s_prime_len;
+
+  CHECK(napi_get_cb_info(env, info, &argc, argv, NULL, NULL) == napi_ok);
+  CHECK(argc == 5);
+  CHECK(napi_get_buffer_info(env, argv[2], NULL, &s_prime_len) == napi_ok);
+
+  JS_ASSERT(s_prime_len == 32, JS_ERR_SPRIME_SIZE);
+
+  return goosig_job_queue(env, GOOSIG_SIGN, argv[0], argv + 1, 4);
+}
+
+static napi_value
+goosig_verify_async(napi_env env, napi_callback_info info) {
+  napi_value argv[4];
+  size_t argc = 4;
+
+  CHECK(napi_get_cb_info(env, info, &argc, argv, NULL, NULL) == napi_ok);
+  CHECK(argc == 4);
+
+  return goosig_job_queue(env, GOOSIG_VERIFY, argv[0], argv + 1, 3);
+}
+
 /*
  * Module
  */
@@ -248,7 +501,11 @@ NAPI_MODULE_INIT() {
     F(goosig_challenge),
     F(goosig_validate),
     F(goosig_sign),
-    F(goosig_verify)
+    F(goosig_verify),
+    F(goosig_challenge_async),
+    F(goosig_validate_async),
+    F(goosig_sign_async),
+    F(goosig_verify_async)
 #undef F
   };
 
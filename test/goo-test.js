@@ -168,4 +168,42 @@ describe('Goo', function() {
       });
     }
   });
+
+  describe('Async', () => {
+    const goo = new Goo(Goo.RSA2048, 2, 3, 4096);
+    const ver = new Goo(Goo.RSA2048, 2, 3);
+    const [item] = sign;
+    const key = Buffer.from(item[0], 'hex');
+    const pub = rsa.publicKeyCreate(key);
+    const msg = Buffer.from(item[1], 'hex');
+    const s_prime = Buffer.from(item[2], 'hex');
+    const C1 = Buffer.from(item[3], 'hex');
+    const sig = Buffer.from(item[5], 'hex');
+
+    it('should challenge, validate, sign & verify asynchronously', async () => {
+      const [c, v, s] = await Promise.all([
+        goo.challengeAsync(s_prime, pub),
+        goo.validateAsync(s_prime, C1, key),
+        goo.signAsync(msg, s_prime, key)
+      ]);
+
+      assert.bufferEqual(c, C1);
+      assert.strictEqual(v, true);
+      assert.bufferEqual(s, sig);
+
+      assert.strictEqual(await ver.verifyAsync(msg, sig, C1), true);
+      assert.strictEqual(await goo.verifyAsync(msg, sig, C1), true);
+    });
+
+    it('should not accept invalid proof asynchronously', async () => {
+      const results = await Promise.all([
+        ver.verifyAsync(msg.slice(0, -1), sig, C1),
+        ver.verifyAsync(msg, sig.slice(0, -1), C1),
+        ver.verifyAsync(msg, sig, C1.slice(0, -1)),
+        ver.verifyAsync(msg, sig, C1)
+      ]);
+
+      assert.deepStrictEqual(results, [false, false, false, true]);
+    });
+  });
 });